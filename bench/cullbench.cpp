@@ -0,0 +1,108 @@
+#include "Core.h"
+#include "Math/Frustum.h"
+#include "SDL2/SDL.h"
+using namespace std;
+
+//	Frustum culling micro-benchmark
+//	Culls a field of random boxes and spheres against one view with the
+//	reference loop and with every batch width the CPU has, checks that
+//	the masks agree and prints the time per entry.
+//
+//	usage: cullbench [count]
+
+static const int RUNS = 50;
+
+static double now()
+{
+	return SDL_GetPerformanceCounter()/(double)SDL_GetPerformanceFrequency();
+}
+
+// Best of RUNS, in nanoseconds per entry.
+template <typename F>
+static double time_per(int count, F f)
+{
+	double best = 1e9;
+	for(int i=0;i!=RUNS;i++)
+	{
+		double start = now();
+		f();
+		best = min(best,now() - start);
+	}
+	return best * 1e9 / count;
+}
+
+static float random_range(float lo, float hi)
+{
+	return lo + (hi - lo) * (rand() / (float)RAND_MAX);
+}
+
+static int count_visible(const vector<uint32_t>& mask, int count)
+{
+	int visible = 0;
+	for(int i=0;i!=count;i++)
+		visible += Frustumf::IsVisible(mask.data(),i);
+	return visible;
+}
+
+int main(int argc, char* argv[])
+{
+	int count = argc > 1 ? atoi(argv[1]) : 16384;
+
+	Vector3Streamf centers(count), extents(count);
+	vector<float> radii(count);
+	for(int i=0;i!=count;i++)
+	{
+		centers.Set(i,Vector3f(random_range(-4000,4000),
+			random_range(-200,600),random_range(-4000,4000)));
+		extents.Set(i,Vector3f(random_range(1,80),random_range(1,80),
+			random_range(1,80)));
+		radii[i] = extents.Get(i).Length();
+	}
+
+	Matrix4f view = Matrix4f::CreateLookAt(Vector3f(0,1500,3000),
+		Vector3f(0,0,0),Vector3f(0,1,0));
+	Matrix4f projection = Matrix4f::CreatePerspective(45,16/9.0f,10,10000);
+	Frustumf frustum(projection * view);
+
+	int words = Frustumf::GetMaskWords(count);
+	vector<uint32_t> boxRef(words), sphereRef(words), mask(words);
+
+	printf("%d entries\n",count);
+	printf("%-10s%12s%12s%10s\n","","boxes ns","spheres ns","visible");
+
+	double boxes = time_per(count,[&]() {
+		frustum.CullBoxesReference(centers,extents,boxRef.data());
+	});
+	double spheres = time_per(count,[&]() {
+		frustum.CullSpheresReference(centers,radii.data(),sphereRef.data());
+	});
+	printf("%-10s%12.2f%12.2f%10d\n","reference",boxes,spheres,
+		count_visible(boxRef,count));
+
+	int best = Frustumf::GetLanes();
+	static const int lanes[] = {1, 4, 8};
+	for(size_t l=0;l!=sizeof(lanes)/sizeof(lanes[0]);l++)
+	{
+		char name[16];
+		sprintf(name,"%d wide",lanes[l]);
+		if(!Frustumf::SetLanes(lanes[l]))
+		{
+			printf("%-10s%12s%12s\n",name,"-","-");
+			continue;
+		}
+
+		boxes = time_per(count,[&]() {
+			frustum.CullBoxes(centers,extents,mask.data());
+		});
+		bool same = mask == boxRef;
+		spheres = time_per(count,[&]() {
+			frustum.CullSpheres(centers,radii.data(),mask.data());
+		});
+		same = same && mask == sphereRef;
+		printf("%-10s%12.2f%12.2f%10s\n",name,boxes,spheres,
+			same ? "ok" : "MISMATCH");
+	}
+	Frustumf::SetLanes(best);
+
+	return 0;
+}
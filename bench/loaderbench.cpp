@@ -0,0 +1,239 @@
+#include "Core.h"
+#include "LOLMap.h"
+#include "TextureCompressor.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_image.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+using namespace std;
+
+//	Map loader benchmark
+//	Times read_map and the texture loads RiotMap does for every map under
+//	the given folders, without a window or GL context, and prints JSON.
+//	Per phase: bytes read, the time of the first run and the best over all
+//	runs, MB/s of the best, the operator new calls and bytes of the first
+//	run and the peak RSS it reached.  The mip cache stays off, so every run
+//	decodes png textures and builds their chains again; later runs still
+//	find the files in the OS cache, the first run is the cold one.  Memory
+//	the C libraries malloc themselves (png decoding) isn't counted as
+//	allocations but shows in the RSS.
+//
+//	A folder is a map when it holds Scene/room.nvr, otherwise every
+//	subfolder that does is benchmarked.
+//
+//	usage: loaderbench [-r runs] <map folder>...
+
+static double now()
+{
+	return SDL_GetPerformanceCounter()/(double)SDL_GetPerformanceFrequency();
+}
+
+// Lets peak_rss start over from the current RSS, Linux only.
+static void reset_peak_rss()
+{
+	FILE* file = fopen("/proc/self/clear_refs","w");
+	if(!file)
+		return;
+	fputs("5",file);
+	fclose(file);
+}
+
+static double peak_rss_mb()
+{
+	FILE* file = fopen("/proc/self/status","r");
+	if(file)
+	{
+		char line[256];
+		long kb = -1;
+		while(fgets(line,sizeof(line),file))
+			if(sscanf(line,"VmHWM: %ld kB",&kb) == 1)
+				break;
+		fclose(file);
+		if(kb >= 0)
+			return kb / 1024.0;
+	}
+
+	rusage usage;
+	getrusage(RUSAGE_SELF,&usage);
+#if defined(__APPLE__)
+	return usage.ru_maxrss / (1024.0*1024.0);
+#else
+	return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+static uint64_t file_size(const string& path)
+{
+	struct stat st;
+	return stat(path.c_str(),&st) ? 0 : st.st_size;
+}
+
+static bool is_map(const string& folder)
+{
+	return file_size(folder + "Scene/room.nvr") != 0;
+}
+
+struct Phase
+{
+	uint64_t bytes;
+	double first_seconds;
+	double seconds;
+	uint64_t allocations;
+	uint64_t allocated;
+	double peak_rss;
+};
+
+// Runs f once, measured.  Counters and RSS are only kept from the first
+// run, the time from the first and the best of all.
+template <typename F>
+static void measure(Phase& phase, bool first, F f)
+{
+	reset_peak_rss();
+	MemoryCounters before = MemoryTracker::GetTotal();
+	double start = now();
+	f();
+	double seconds = now() - start;
+	if(first)
+	{
+		MemoryCounters after = MemoryTracker::GetTotal();
+		phase.first_seconds = seconds;
+		phase.seconds = seconds;
+		phase.allocations = after.allocations - before.allocations;
+		phase.allocated = after.bytes - before.bytes;
+		phase.peak_rss = peak_rss_mb();
+	}
+	phase.seconds = min(phase.seconds,seconds);
+}
+
+static void print_phase(const char* name, const Phase& phase, bool last)
+{
+	printf("        \"%s\": {\"bytes\": %" PRIu64 ", "
+		"\"first_seconds\": %.6f, \"seconds\": %.6f, "
+		"\"mb_per_s\": %.2f, \"allocations\": %" PRIu64 ", "
+		"\"allocated_bytes\": %" PRIu64 ", \"peak_rss_mb\": %.1f}%s\n",
+		name,phase.bytes,phase.first_seconds,phase.seconds,
+		phase.seconds > 0 ? phase.bytes / (1024*1024.0) / phase.seconds : 0,
+		phase.allocations,phase.allocated,phase.peak_rss,last ? "" : ",");
+}
+
+static void benchmark(const string& folder, int runs, bool last)
+{
+	string nvr = folder + "Scene/room.nvr";
+	Phase parse = {file_size(nvr),0,0,0,0,0};
+	Phase textures = {0,0,0,0,0,0};
+
+	// read_map reports what it reads, keep that out of the JSON and the
+	// timings.
+	ostringstream sink;
+	streambuf* out = cout.rdbuf(sink.rdbuf());
+
+	// The texture names, and where RiotMap would find each.
+	vector<string> files;
+	int missing = 0;
+	LOLMap* map = read_map(nvr.c_str());
+	set<string> names;
+	for(uint32_t i=0;i!=map->num_material;i++)
+		for(int j=0;j!=8;j++)
+			if(map->materials[i].textures[j].filename[0])
+				names.insert(map->materials[i].textures[j].filename);
+	free_map(map);
+	for(set<string>::iterator it=names.begin();it!=names.end();++it)
+	{
+		string name = folder + "Scene/Textures/" + *it;
+		if(!file_size(name))
+			name = name.substr(0,name.size()-3) + "png";
+		if(file_size(name))
+		{
+			files.push_back(name);
+			textures.bytes += file_size(name);
+		} else {
+			missing++;
+		}
+	}
+
+	for(int r=0;r!=runs;r++)
+	{
+		measure(parse,r == 0,[&]()
+		{
+			free_map(read_map(nvr.c_str()));
+		});
+		measure(textures,r == 0,[&]()
+		{
+			for(size_t i=0;i!=files.size();i++)
+			{
+				DDSImage image;
+				if(!load_image(files[i].c_str(),image) && r == 0)
+					cerr << "Failed " << files[i] << endl;
+			}
+		});
+	}
+	cout.rdbuf(out);
+
+	printf("    {\n      \"map\": \"%s\",\n      \"textures\": %zu,\n"
+		"      \"missing_textures\": %d,\n      \"phases\": {\n",
+		folder.c_str(),files.size(),missing);
+	print_phase("parse",parse,false);
+	print_phase("textures",textures,true);
+	printf("      }\n    }%s\n",last ? "" : ",");
+}
+
+int main(int argc, char* argv[])
+{
+	JobSystem::Instance();
+	IMG_Init(IMG_INIT_PNG);
+	set_mip_cache(string());
+
+	int runs = 3;
+	vector<string> maps;
+	for(int i=1;i<argc;i++)
+	{
+		string arg = argv[i];
+		if(arg == "-r" && i+1 < argc)
+		{
+			runs = max(1,atoi(argv[++i]));
+			continue;
+		}
+		if(arg[arg.size()-1] != '/')
+			arg += '/';
+		if(is_map(arg))
+		{
+			maps.push_back(arg);
+			continue;
+		}
+
+		DIR* dir = opendir(arg.c_str());
+		if(!dir)
+		{
+			cerr << "No map in " << arg << endl;
+			continue;
+		}
+		vector<string> found;
+		dirent* entry;
+		while((entry = readdir(dir)))
+		{
+			string sub = arg + entry->d_name + "/";
+			if(entry->d_name[0] != '.' && is_map(sub))
+				found.push_back(sub);
+		}
+		closedir(dir);
+		sort(found.begin(),found.end());
+		maps.insert(maps.end(),found.begin(),found.end());
+	}
+	if(maps.empty())
+	{
+		cerr << "usage: loaderbench [-r runs] <map folder>..." << endl;
+		return 1;
+	}
+
+	printf("{\n  \"runs\": %d,\n  \"workers\": %u,\n  \"maps\": [\n",runs,
+		JobSystem::Instance().GetWorkerCount());
+	for(size_t i=0;i!=maps.size();i++)
+		benchmark(maps[i],runs,i + 1 == maps.size());
+	printf("  ]\n}\n");
+
+	IMG_Quit();
+	return 0;
+}
@@ -0,0 +1,250 @@
+#include "Core.h"
+#include "Math/Math.h"
+#include "Math/FastMath.h"
+#include "Math/Vector3.h"
+#include "Math/Matrix4.h"
+#include "SDL2/SDL.h"
+using namespace std;
+
+//	Math micro-benchmark
+//	Times the Math functions, their Fast* approximations and the common
+//	Vector3 and Matrix4 operations in float and double, and compares every
+//	result with the same operation done in long double through libm.  The
+//	error is absolute where the exact result is below 1 and relative above.
+//
+//	usage: mathbench [count]
+
+static const int RUNS = 20;
+
+static double now()
+{
+	return SDL_GetPerformanceCounter()/(double)SDL_GetPerformanceFrequency();
+}
+
+struct Result
+{
+	double ns;
+	double error;
+};
+
+// Runs Op on count random inputs in [Op::LO,Op::HI], best of RUNS.
+template <typename Op, typename Real>
+static Result measure(int count)
+{
+	vector<Real> in((size_t)count * Op::IN);
+	vector<long double> refIn(in.size());
+	for(size_t i=0;i!=in.size();i++)
+	{
+		in[i] = (Real)(Op::LO + (Op::HI - Op::LO) * (rand() / (double)RAND_MAX));
+		refIn[i] = in[i];
+	}
+
+	// Every result is stored so the compiler can't drop any of the work.
+	vector<Real> out((size_t)count * Op::OUT);
+	double best = 1e9;
+	for(int r=0;r!=RUNS;r++)
+	{
+		double start = now();
+		for(int i=0;i!=count;i++)
+			Op::run(&in[(size_t)i * Op::IN],&out[(size_t)i * Op::OUT]);
+		best = min(best,now() - start);
+	}
+
+	Result result = {best * 1e9 / count, 0};
+	long double ref[16];
+	for(int i=0;i!=count;i++)
+	{
+		Op::reference(&refIn[(size_t)i * Op::IN],ref);
+		for(int k=0;k!=Op::OUT;k++)
+		{
+			long double exact = ref[k];
+			long double diff = fabsl(out[(size_t)i * Op::OUT + k] - exact);
+			if(fabsl(exact) > 1)
+				diff /= fabsl(exact);
+			result.error = max(result.error,(double)diff);
+		}
+	}
+	return result;
+}
+
+template <typename Op>
+static void row(int count)
+{
+	Result f = measure<Op,float>(count);
+	Result d = measure<Op,double>(count);
+	printf("%-24s%-14s%10.2f%12.3g%10.2f%12.3g\n",Op::name(),Op::range(),
+		f.ns,f.error,d.ns,d.error);
+}
+
+// One argument functions.  call and exact may use x and Real, exact is
+// only ever evaluated in long double.
+#define MATH_FUNCTION(op,lo,hi,call,exact)							\
+struct op															\
+{																	\
+	enum { IN = 1, OUT = 1 };										\
+	static constexpr double LO = lo, HI = hi;						\
+	static const char* name() { return #op; }						\
+	static const char* range() { return "[" #lo "," #hi "]"; }		\
+	template <typename Real>										\
+	static void run(const Real* in, Real* out)						\
+	{																\
+		Real x = in[0];												\
+		out[0] = call;												\
+	}																\
+	static void reference(const long double* in, long double* out)	\
+	{																\
+		long double x = in[0];										\
+		out[0] = exact;												\
+	}																\
+};
+
+static constexpr double PI = Math<double>::PI;
+static constexpr double HALF_PI = Math<double>::HALF_PI;
+static constexpr double QUARTER_PI = 0.25*Math<double>::PI;
+
+MATH_FUNCTION(Sin,-PI,PI,Math<Real>::Sin(x),sinl(x))
+MATH_FUNCTION(FastSin0,0,HALF_PI,Math<Real>::FastSin0(x),sinl(x))
+MATH_FUNCTION(FastSin1,0,HALF_PI,Math<Real>::FastSin1(x),sinl(x))
+MATH_FUNCTION(Cos,-PI,PI,Math<Real>::Cos(x),cosl(x))
+MATH_FUNCTION(FastCos0,0,HALF_PI,Math<Real>::FastCos0(x),cosl(x))
+MATH_FUNCTION(FastCos1,0,HALF_PI,Math<Real>::FastCos1(x),cosl(x))
+MATH_FUNCTION(Tan,0,QUARTER_PI,Math<Real>::Tan(x),tanl(x))
+MATH_FUNCTION(FastTan0,0,QUARTER_PI,Math<Real>::FastTan0(x),tanl(x))
+MATH_FUNCTION(FastTan1,0,QUARTER_PI,Math<Real>::FastTan1(x),tanl(x))
+MATH_FUNCTION(ASin,0,1,Math<Real>::ASin(x),asinl(x))
+MATH_FUNCTION(FastInvSin0,0,1,Math<Real>::FastInvSin0(x),asinl(x))
+MATH_FUNCTION(FastInvSin1,0,1,Math<Real>::FastInvSin1(x),asinl(x))
+MATH_FUNCTION(ACos,0,1,Math<Real>::ACos(x),acosl(x))
+MATH_FUNCTION(FastInvCos0,0,1,Math<Real>::FastInvCos0(x),acosl(x))
+MATH_FUNCTION(FastInvCos1,0,1,Math<Real>::FastInvCos1(x),acosl(x))
+MATH_FUNCTION(ATan,-1,1,Math<Real>::ATan(x),atanl(x))
+MATH_FUNCTION(FastInvTan0,-1,1,Math<Real>::FastInvTan0(x),atanl(x))
+MATH_FUNCTION(FastInvTan1,-1,1,Math<Real>::FastInvTan1(x),atanl(x))
+MATH_FUNCTION(NegExp,0,16,Math<Real>::Exp(-x),expl(-x))
+MATH_FUNCTION(FastNegExp0,0,16,Math<Real>::FastNegExp0(x),expl(-x))
+MATH_FUNCTION(FastNegExp1,0,16,Math<Real>::FastNegExp1(x),expl(-x))
+MATH_FUNCTION(FastNegExp2,0,16,Math<Real>::FastNegExp2(x),expl(-x))
+MATH_FUNCTION(FastNegExp3,0,16,Math<Real>::FastNegExp3(x),expl(-x))
+MATH_FUNCTION(InvSqrt,0.001,1000,Math<Real>::InvSqrt(x),1/sqrtl(x))
+MATH_FUNCTION(FastInvSqrt,0.001,1000,Math<Real>::FastInvSqrt(x),1/sqrtl(x))
+MATH_FUNCTION(Sqrt,0,1000,Math<Real>::Sqrt(x),sqrtl(x))
+MATH_FUNCTION(Exp,-16,16,Math<Real>::Exp(x),expl(x))
+MATH_FUNCTION(Log,0.001,1000,Math<Real>::Log(x),logl(x))
+MATH_FUNCTION(Pow,0,16,Math<Real>::Pow(x,(Real)2.5),powl(x,2.5L))
+MATH_FUNCTION(ATan2,-1,1,Math<Real>::ATan2(x,(Real)0.5),atan2l(x,0.5L))
+
+// Vector3 and Matrix4 operations on random components.  The reference is
+// the same code instantiated for long double.
+#define VECTOR_OPERATION(op,numIn,numOut,body)							\
+struct op															\
+{																	\
+	enum { IN = numIn, OUT = numOut };								\
+	static constexpr double LO = -10, HI = 10;						\
+	static const char* name() { return #op; }						\
+	static const char* range() { return "[-10,10]"; }				\
+	template <typename Real>										\
+	static void run(const Real* in, Real* out)						\
+	{																\
+		body														\
+	}																\
+	static void reference(const long double* in, long double* out)	\
+	{																\
+		run<long double>(in,out);									\
+	}																\
+};
+
+template <typename Real>
+static Vector3<Real> vec(const Real* in)
+{
+	return Vector3<Real>(in[0],in[1],in[2]);
+}
+
+template <typename Real>
+static void store(const Vector3<Real>& v, Real* out)
+{
+	out[0] = v.x;
+	out[1] = v.y;
+	out[2] = v.z;
+}
+
+template <typename Real>
+static Matrix4<Real> mat(const Real* in)
+{
+	Matrix4<Real> m;
+	memcpy(m._m,in,sizeof(m._m));
+	return m;
+}
+
+template <typename Real>
+static void store(const Matrix4<Real>& m, Real* out)
+{
+	memcpy(out,m._m,sizeof(m._m));
+}
+
+VECTOR_OPERATION(Vector3_Length,3,1,
+	out[0] = vec(in).Length();)
+VECTOR_OPERATION(Vector3_Normalize,3,3,
+	Vector3<Real> v = vec(in); v.Normalize(); store(v,out);)
+VECTOR_OPERATION(Vector3_Dot,6,1,
+	out[0] = vec(in).Dot(vec(in + 3));)
+VECTOR_OPERATION(Vector3_Cross,6,3,
+	store(vec(in).Cross(vec(in + 3)),out);)
+VECTOR_OPERATION(Matrix4_Product,32,16,
+	store(mat(in) * mat(in + 16),out);)
+VECTOR_OPERATION(Matrix4_Inverse,16,16,
+	store(mat(in).Inverse(),out);)
+VECTOR_OPERATION(Matrix4_Determinant,16,1,
+	out[0] = mat(in).Determinant();)
+VECTOR_OPERATION(Matrix4_TransformPoint,19,3,
+	store(mat(in).TransformPoint(vec(in + 16)),out);)
+
+int main(int argc, char* argv[])
+{
+	int count = argc > 1 ? atoi(argv[1]) : 65536;
+
+	printf("%d inputs, error against long double libm\n",count);
+	printf("%-24s%-14s%10s%12s%10s%12s\n","","range","float ns","float err",
+		"double ns","double err");
+
+	row<Sin>(count);
+	row<FastSin0>(count);
+	row<FastSin1>(count);
+	row<Cos>(count);
+	row<FastCos0>(count);
+	row<FastCos1>(count);
+	row<Tan>(count);
+	row<FastTan0>(count);
+	row<FastTan1>(count);
+	row<ASin>(count);
+	row<FastInvSin0>(count);
+	row<FastInvSin1>(count);
+	row<ACos>(count);
+	row<FastInvCos0>(count);
+	row<FastInvCos1>(count);
+	row<ATan>(count);
+	row<FastInvTan0>(count);
+	row<FastInvTan1>(count);
+	row<NegExp>(count);
+	row<FastNegExp0>(count);
+	row<FastNegExp1>(count);
+	row<FastNegExp2>(count);
+	row<FastNegExp3>(count);
+	row<InvSqrt>(count);
+	row<FastInvSqrt>(count);
+	row<Sqrt>(count);
+	row<Exp>(count);
+	row<Log>(count);
+	row<Pow>(count);
+	row<ATan2>(count);
+	printf("\n");
+	row<Vector3_Length>(count);
+	row<Vector3_Normalize>(count);
+	row<Vector3_Dot>(count);
+	row<Vector3_Cross>(count);
+	row<Matrix4_Product>(count);
+	row<Matrix4_Inverse>(count);
+	row<Matrix4_Determinant>(count);
+	row<Matrix4_TransformPoint>(count);
+
+	return 0;
+}
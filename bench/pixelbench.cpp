@@ -0,0 +1,168 @@
+#include "Core.h"
+#include "PixelFormat.h"
+#include "GL/glew.h"
+#include "SDL2/SDL.h"
+using namespace std;
+
+//	Pixel conversion micro-benchmark
+//	Times every converter and the mip box filter with each kernel set the
+//	CPU runs, then, if a GL context can be had, uploads the same BGR image
+//	once through the driver's own GL_BGR path and once converted to RGBA
+//	first.
+//
+//	usage: pixelbench [size]
+
+static const int RUNS = 20;
+
+static double now()
+{
+	return SDL_GetPerformanceCounter()/(double)SDL_GetPerformanceFrequency();
+}
+
+// Best of RUNS, in MB of source pixels per second.
+template <typename F>
+static double rate(size_t bytes, F f)
+{
+	double best = 1e9;
+	for(int i=0;i!=RUNS;i++)
+	{
+		double start = now();
+		f();
+		best = min(best,now() - start);
+	}
+	return bytes / best / (1 << 20);
+}
+
+static void bench_converters(uint32_t size)
+{
+	static const PixelLayout layouts[] = {PIXEL_RGB,PIXEL_BGR,PIXEL_BGRA};
+	static const char* names[] = {"rgb->rgba","bgr->rgba","bgra->rgba"};
+	static const PixelSIMD sets[] = {
+		PIXEL_SIMD_SCALAR,PIXEL_SIMD_SSSE3,PIXEL_SIMD_AVX2,PIXEL_SIMD_NEON
+	};
+
+	PixelSIMD best = pixel_simd();
+	vector<uint8_t> src((size_t)size*size*4);
+	vector<uint8_t> dst((size_t)size*size*4);
+	for(size_t i=0;i!=src.size();i++)
+		src[i] = rand();
+
+	printf("%-12s","MB/s");
+	for(size_t s=0;s!=sizeof(sets)/sizeof(sets[0]);s++)
+		printf("%10s",pixel_simd_name(sets[s]));
+	printf("\n");
+
+	for(size_t l=0;l!=sizeof(layouts)/sizeof(layouts[0]);l++)
+	{
+		size_t bpp = layouts[l] == PIXEL_BGRA ? 4 : 3;
+		printf("%-12s",names[l]);
+		for(size_t s=0;s!=sizeof(sets)/sizeof(sets[0]);s++)
+		{
+			if(!set_pixel_simd(sets[s]))
+			{
+				printf("%10s","-");
+				continue;
+			}
+			double mbs = rate(src.size()/4*bpp,[&]() {
+				convert_image(layouts[l],src.data(),size*bpp,size,size,dst.data());
+			});
+			printf("%10.0f",mbs);
+		}
+		printf("\n");
+	}
+
+	printf("%-12s","flip");
+	for(size_t s=0;s!=sizeof(sets)/sizeof(sets[0]);s++)
+	{
+		if(!set_pixel_simd(sets[s]))
+		{
+			printf("%10s","-");
+			continue;
+		}
+		printf("%10.0f",rate(dst.size(),[&]() {
+			flip_rows(dst.data(),size*4,size);
+		}));
+	}
+	printf("\n");
+
+	printf("%-12s","box filter");
+	for(size_t s=0;s!=sizeof(sets)/sizeof(sets[0]);s++)
+	{
+		if(!set_pixel_simd(sets[s]))
+		{
+			printf("%10s","-");
+			continue;
+		}
+		printf("%10.0f",rate(src.size(),[&]() {
+			for(uint32_t y=0;y!=size/2;y++)
+			{
+				box_filter_row(&src[(size_t)2*y*size*4],&src[(size_t)(2*y+1)*size*4],
+					&dst[(size_t)y*size*2],size/2);
+			}
+		}));
+	}
+	printf("\n");
+
+	set_pixel_simd(best);
+}
+
+static void bench_upload(uint32_t size)
+{
+	SDL_Window* window = SDL_CreateWindow("pixelbench",0,0,64,64,
+		SDL_WINDOW_OPENGL|SDL_WINDOW_HIDDEN);
+	SDL_GLContext context = window ? SDL_GL_CreateContext(window) : 0;
+	if(!context)
+	{
+		printf("\nno GL context, skipping upload\n");
+		if(window)
+			SDL_DestroyWindow(window);
+		return;
+	}
+	glewInit();
+
+	// Odd width so the 3 byte rows aren't 4 byte aligned.
+	uint32_t width = size - 1;
+	vector<uint8_t> bgr((size_t)width*size*3);
+	vector<uint8_t> rgba((size_t)width*size*4);
+	for(size_t i=0;i!=bgr.size();i++)
+		bgr[i] = rand();
+
+	GLuint texture;
+	glGenTextures(1,&texture);
+	glBindTexture(GL_TEXTURE_2D,texture);
+
+	double driver = rate(bgr.size(),[&]() {
+		glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+		glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8,width,size,0,
+			GL_BGR,GL_UNSIGNED_BYTE,bgr.data());
+		glPixelStorei(GL_UNPACK_ALIGNMENT,4);
+		glFinish();
+	});
+	double converted = rate(bgr.size(),[&]() {
+		convert_image(PIXEL_BGR,bgr.data(),width*3,width,size,rgba.data());
+		glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8,width,size,0,
+			GL_RGBA,GL_UNSIGNED_BYTE,rgba.data());
+		glFinish();
+	});
+
+	printf("\n%ux%u BGR upload MB/s\n",width,size);
+	printf("%-12s%10.0f\n","driver",driver);
+	printf("%-12s%10.0f  (%s)\n","converted",converted,
+		pixel_simd_name(pixel_simd()));
+
+	glDeleteTextures(1,&texture);
+	SDL_GL_DeleteContext(context);
+	SDL_DestroyWindow(window);
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t size = argc > 1 ? atoi(argv[1]) : 2048;
+	SDL_Init(SDL_INIT_VIDEO);
+
+	bench_converters(size);
+	bench_upload(size);
+
+	SDL_Quit();
+	return 0;
+}
@@ -1,5 +1,8 @@
 #version 120
 
+// The same depth in every map program, for the prepass.
+invariant gl_Position;
+
 attribute vec2 Z_UV0;
 attribute vec3 Z_POSITION;
 
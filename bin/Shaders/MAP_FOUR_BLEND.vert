@@ -1,5 +1,8 @@
 #version 120
 
+// The same depth in every map program, for the prepass.
+invariant gl_Position;
+
 attribute vec3 Z_POSITION;
 attribute vec2 Z_UV0;
 attribute vec2 Z_UV1;
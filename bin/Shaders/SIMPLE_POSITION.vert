@@ -1,5 +1,8 @@
 #version 120
 
+// The same depth in every map program, for the prepass.
+invariant gl_Position;
+
 attribute vec3 Z_POSITION;
 
 uniform mat4 Z_MODEL_VIEW_PROJECTION;
@@ -4,40 +4,57 @@ varying vec2 UV;
 
 uniform sampler2D Z_TEX0;
 uniform sampler2D Z_TEX1;
-uniform int MODE;
+
+// Built once per split mode with MODE defined, and SHARPEN for the sharp
+// upscale, see main.cpp.
+#ifndef MODE
+#define MODE 0
+#endif
+
+#ifdef SHARPEN
+// One texel of the map frames, and how much to sharpen them.
+uniform vec2 Z_TEXEL;
+uniform float Z_SHARPNESS;
+#endif
+
+// The map frames may be drawn smaller than the window, texture filtering
+// does the bilinear upscale.  SHARPEN takes away some of its blur with an
+// unsharp mask over the four neighbours.
+vec4 upscale(sampler2D tex, vec2 uv)
+{
+	vec4 color = texture2D(tex,uv);
+#ifdef SHARPEN
+	vec4 around =
+		texture2D(tex,uv+vec2(Z_TEXEL.x,0.0)) + texture2D(tex,uv-vec2(Z_TEXEL.x,0.0)) +
+		texture2D(tex,uv+vec2(0.0,Z_TEXEL.y)) + texture2D(tex,uv-vec2(0.0,Z_TEXEL.y));
+	color = clamp(color + (color*4.0 - around)*Z_SHARPNESS, 0.0, 1.0);
+#endif
+	return color;
+}
 
 void main()
 {
-	if(MODE == 0) 
-	{
-		gl_FragColor = texture2D(Z_TEX0,UV);
+#if MODE == 0
+	gl_FragColor = upscale(Z_TEX0,UV);
+#elif MODE == 1
+	gl_FragColor = upscale(Z_TEX1,UV);
+#elif MODE == 2
+	if(UV.x <= 0.5) {
+		gl_FragColor = upscale(Z_TEX0,UV);	
+	} else {
+		gl_FragColor = upscale(Z_TEX1,UV);
 	}
-	else if(MODE == 1) 
-	{
-		gl_FragColor = texture2D(Z_TEX1,UV);
-	} 
-	else if(MODE == 2) 
-	{
-		if(UV.x <= 0.5) {
-			gl_FragColor = texture2D(Z_TEX0,UV);	
-		} else {
-			gl_FragColor = texture2D(Z_TEX1,UV);
-		}
-	} 
-	else if(MODE == 3)
-	{
-		if(UV.x <= 0.5) {
-			gl_FragColor = texture2D(Z_TEX1,UV);	
-		} else {
-			gl_FragColor = texture2D(Z_TEX0,UV);
-		}
+#elif MODE == 3
+	if(UV.x <= 0.5) {
+		gl_FragColor = upscale(Z_TEX1,UV);	
+	} else {
+		gl_FragColor = upscale(Z_TEX0,UV);
 	}
-	else if(MODE == 4)
-	{
-		if(UV.x <= 0.5) {
-			gl_FragColor = texture2D(Z_TEX0,vec2(UV.x+0.25,UV.y));	
-		} else {
-			gl_FragColor = texture2D(Z_TEX1,vec2(UV.x-0.25,UV.y));
-		}
+#elif MODE == 4
+	if(UV.x <= 0.5) {
+		gl_FragColor = upscale(Z_TEX0,vec2(UV.x+0.25,UV.y));	
+	} else {
+		gl_FragColor = upscale(Z_TEX1,vec2(UV.x-0.25,UV.y));
 	}
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef Z_CPU_H_
+#define Z_CPU_H_
+
+#include "Core.h"
+
+//	Runtime CPU feature checks
+//	For kernels built past the compiler's baseline and picked once the
+//	program runs.  Everything is false off x86.
+
+enum CPUFeature
+{
+	CPU_SSSE3,
+	CPU_AVX,
+	CPU_AVX2
+};
+
+// Safe to call from static initializers.
+bool cpu_supports(CPUFeature feature);
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef Z_CHUNKSTREAMER_H_
+#define Z_CHUNKSTREAMER_H_
+
+#include "Core.h"
+#include "GL/glew.h"
+#include "LOLMap.h"
+#include "UploadScheduler.h"
+#include "Math/Vector3.h"
+#include "Math/Vector3Stream.h"
+
+// Keeps the vertex and index buffers of a map on the GPU only around the
+// camera.  Models are grouped into cells of a grid over the ground plane:
+// every model of a _chunk_ material goes to the cell its whole chunk is
+// centered in, so authored chunks aren't torn apart, and any other model
+// to the cell of its own center.  Without a cell size given the grid
+// follows the typical chunk, or an eighth of the map without any.
+//
+// Cells within radius of the eye are made resident nearest first.  The
+// others stay until the buffers are over budget, then the farthest go.
+//
+// Only GPU memory is managed.  Buffers are the map's own vertex and index
+// lists, which are shared between cells: a list lives while any resident
+// cell uses it and counts whole against the budget.  The parsed map stays
+// in memory to upload from again.
+class ChunkStreamer
+{
+public:
+  // centers and extents are the model boxes.  Uploads go through uploads
+  // when set, straight to GL otherwise.
+  ChunkStreamer(const LOLMap* map, const Vector3Streamf& centers,
+    const Vector3Streamf& extents, UploadScheduler* uploads, float radius,
+    size_t budget = 128 << 20, float cellSize = 0);
+  virtual ~ChunkStreamer();
+
+  // Once per frame on the GL thread, eye in map space.
+  void Update(const Vector3f& eye);
+
+  // The model's cell is resident and its buffers uploaded.
+  bool IsReady(uint32_t model) const;
+
+  // The model's cell is resident, if maybe not uploaded yet.
+  bool IsResident(uint32_t model) const
+  {
+    return cells_[modelCells_[model]].resident;
+  }
+
+  GLuint GetVertexBuffer(uint32_t list) const
+  {
+    return vertexBuffers_[list].name;
+  }
+
+  GLuint GetIndexBuffer(uint32_t list) const
+  {
+    return indexBuffers_[list].name;
+  }
+
+  size_t GetCellCount() const
+  {
+    return cells_.size();
+  }
+
+  size_t GetResidentCells() const;
+
+  size_t GetResidentBytes() const
+  {
+    return resident_;
+  }
+
+  size_t GetBudget() const
+  {
+    return budget_;
+  }
+
+  // No upload in flight, the streamer can go.
+  bool Idle() const
+  {
+    return !pending_;
+  }
+
+private:
+  struct Buffer
+  {
+    GLuint name;
+    uint32_t refs;      // resident cells using it
+    int pending;        // uploads not done yet, 0 or 1
+  };
+
+  struct Cell
+  {
+    Vector3f min;
+    Vector3f max;
+    vector<uint32_t> vertexLists;
+    vector<uint32_t> indexLists;
+    bool resident;
+    float distance;     // from the eye at the last Update
+  };
+
+  // Bytes Acquire would add to resident_.
+  size_t Missing(const Cell& cell) const;
+  bool Pending(const Cell& cell) const;
+  void Acquire(Cell& cell);
+  void Release(Cell& cell);
+  void AddRef(vector<Buffer>& buffers, uint32_t list, GLenum target,
+    const void* data, size_t size);
+  void RemoveRef(vector<Buffer>& buffers, uint32_t list, size_t size);
+
+  const LOLMap* map_;
+  UploadScheduler* uploads_;
+  float radius_;
+  size_t budget_;
+  size_t resident_;
+  int pending_;
+
+  vector<Cell> cells_;
+  vector<uint32_t> modelCells_;
+  vector<Buffer> vertexBuffers_;
+  vector<Buffer> indexBuffers_;
+  // Cell indices by distance, nearest first.
+  vector<uint32_t> order_;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef Z_DDS_H_
+#define Z_DDS_H_
+
+#include "Core.h"
+
+using namespace std;
+
+//	DirectDraw Surface reader
+//	Only the layouts found in the map folders are understood: DXT1, DXT3,
+//	DXT5 and plain 32 bit color.  Every stored mip level is kept.
+
+enum DDSFormat
+{
+	DDS_UNKNOWN = 0,
+	DDS_DXT1,
+	DDS_DXT3,
+	DDS_DXT5,
+	DDS_RGBA8 // uncompressed, swizzled to RGBA on load
+};
+
+struct DDSPixelFormat
+{
+	uint32_t size;
+	uint32_t flags;
+	uint32_t fourcc;
+	uint32_t rgb_bit_count;
+	uint32_t r_mask;
+	uint32_t g_mask;
+	uint32_t b_mask;
+	uint32_t a_mask;
+};
+
+struct DDSHeader
+{
+	uint32_t size;
+	uint32_t flags;
+	uint32_t height;
+	uint32_t width;
+	uint32_t pitch_or_linear_size;
+	uint32_t depth;
+	uint32_t mip_map_count;
+	uint32_t reserved1[11];
+	DDSPixelFormat pixel_format;
+	uint32_t caps;
+	uint32_t caps2;
+	uint32_t caps3;
+	uint32_t caps4;
+	uint32_t reserved2;
+};
+
+struct DDSLevel
+{
+	uint32_t width;
+	uint32_t height;
+	uint32_t offset; // into DDSImage::data
+	uint32_t size;
+};
+
+struct DDSImage
+{
+	DDSFormat format;
+	uint32_t width;
+	uint32_t height;
+	vector<DDSLevel> levels;
+	vector<uint8_t> data;
+
+	bool compressed() const
+	{
+		return format == DDS_DXT1 || format == DDS_DXT3 || format == DDS_DXT5;
+	}
+
+	// Bytes per 4x4 block, or per pixel for uncompressed images.
+	uint32_t block_size() const
+	{
+		switch(format)
+		{
+		case DDS_DXT1: return 8;
+		case DDS_DXT3: return 16;
+		case DDS_DXT5: return 16;
+		case DDS_RGBA8: return 4;
+		default: return 0;
+		}
+	}
+};
+
+// Size in bytes of one level of the given format.
+uint32_t dds_level_size(DDSFormat format, uint32_t width, uint32_t height);
+
+bool read_dds(const char* filename, DDSImage& image);
+
+// Format, size and levels of a DDS file, without reading any data.
+bool read_dds_header(const char* filename, DDSImage& image);
+
+// Only levels first.. of a DDS file, rebased as slice_dds does.  The finer
+// levels are seeked over, not read.
+bool read_dds_levels(const char* filename, size_t first, DDSImage& image);
+bool write_dds(const char* filename, const DDSImage& image);
+
+// Copy levels first.. of image into out, rebased so first becomes level 0.
+void slice_dds(const DDSImage& image, size_t first, DDSImage& out);
+
+// Expand one level to tightly packed RGBA8.  rgba must hold
+// width*height*4 bytes of that level.
+void decode_dds_level(const DDSImage& image, size_t level, uint8_t* rgba);
+
+// Whether any pixel of any level has alpha at or below threshold, the
+// ones an alpha test at threshold drops.
+bool dds_has_cutout(const DDSImage& image, uint8_t threshold = 127);
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef Z_FRAMEARENA_H_
+#define Z_FRAMEARENA_H_
+
+#include "Core.h"
+
+// Bump allocator for data that lives for a frame: visible lists, sort
+// keys, vertices of overlay text.  There are two buffers and BeginFrame
+// switches between them, so whatever the previous frame allocated stays
+// valid through the current one and is only reused the frame after.
+//
+// Nothing is freed one at a time.  What doesn't fit goes to the heap
+// until the buffer comes round again, which then grows to the most that
+// was asked of it, so after a few frames of the same work nothing calls
+// malloc.  Main thread only.
+class FrameArena
+{
+public:
+  static const size_t DEFAULT_SIZE = 1 << 20;
+  // What Allocate aligns to unless asked for more.
+  static const size_t ALIGNMENT = 16;
+
+  FrameArena(size_t size = DEFAULT_SIZE);
+  virtual ~FrameArena();
+
+  // The one the main loop resets.
+  static FrameArena& Instance();
+
+  // Once per frame, before anything allocates from it.
+  void BeginFrame();
+
+  // alignment is a power of two no larger than ALIGNMENT.
+  void* Allocate(size_t size, size_t alignment = ALIGNMENT);
+
+  template <typename T>
+  T* Allocate(size_t count)
+  {
+    return (T*)Allocate(count * sizeof(T),alignof(T));
+  }
+
+  // Bytes handed out this frame, including what went to the heap.
+  size_t GetUsed() const
+  {
+    return buffers_[current_].requested;
+  }
+
+  size_t GetCapacity() const
+  {
+    return buffers_[current_].size;
+  }
+
+private:
+  struct Buffer
+  {
+    char* data;
+    size_t size;
+    size_t used;
+    size_t requested;
+    std::vector<void*> spills;
+  };
+
+  FrameArena(const FrameArena&);
+  FrameArena& operator=(const FrameArena&);
+
+  Buffer buffers_[2];
+  int current_;
+};
+
+// Standard allocator over FrameArena::Instance(), for containers that
+// don't outlive the frame after the one that filled them.  Growing one
+// leaves the old storage behind, so reserve what is known up front.
+template <typename T>
+class FrameAllocator
+{
+public:
+  typedef T value_type;
+
+  FrameAllocator() {}
+
+  template <typename U>
+  FrameAllocator(const FrameAllocator<U>&) {}
+
+  T* allocate(size_t count)
+  {
+    return FrameArena::Instance().Allocate<T>(count);
+  }
+
+  void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+inline bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&)
+{
+  return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&)
+{
+  return false;
+}
+
+template <typename T>
+using FrameVector = std::vector<T,FrameAllocator<T> >;
+
+#endif
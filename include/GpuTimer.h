@@ -0,0 +1,45 @@
+#ifndef Z_GPUTIMER_H_
+#define Z_GPUTIMER_H_
+
+#include "Core.h"
+#include "GL/glew.h"
+
+// Times GL work between Begin and End with GL_TIME_ELAPSED queries.  A
+// result is only read once the GPU has it, a few frames later, so timing
+// never waits on the GPU.  Without ARB_timer_query nothing is timed and
+// IsSupported says so.  Not nested with other GL_TIME_ELAPSED queries.
+class GpuTimer
+{
+public:
+  // Queries in flight at most.  A Begin with all of them still pending
+  // skips that frame.
+  static const int QUERIES = 4;
+
+  GpuTimer();
+  virtual ~GpuTimer();
+
+  bool IsSupported() const
+  {
+    return queries_[0] != 0;
+  }
+
+  void Begin();
+  void End();
+
+  // The newest time that has come back since the last call, false when
+  // none did.
+  bool GetResult(double& milliseconds);
+
+private:
+  GpuTimer(const GpuTimer&);
+  GpuTimer& operator=(const GpuTimer&);
+
+  GLuint queries_[QUERIES];
+  bool pending_[QUERIES];
+  // Next query Begin uses, and the oldest one pending.
+  int next_;
+  int oldest_;
+  bool active_;
+};
+
+#endif
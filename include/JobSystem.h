@@ -0,0 +1,136 @@
+#ifndef Z_JOBSYSTEM_H_
+#define Z_JOBSYSTEM_H_
+
+#include "Core.h"
+#include "MemoryTracker.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+using namespace std;
+
+class JobSystem;
+
+// Number of jobs still to finish, and what to start once none are left.
+// A counter has to outlive its jobs: Wait on it before it goes away.
+class JobCounter
+{
+public:
+  JobCounter()
+    :pending_(0)
+  {
+  }
+
+  bool Done() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_ == 0;
+  }
+
+private:
+  friend class JobSystem;
+
+  struct Continuation
+  {
+    std::function<void()> job;
+    JobCounter* counter;
+    bool main;
+    MemoryTag tag;
+  };
+
+  mutable std::mutex mutex_;
+  int pending_;
+  vector<Continuation> continuations_;
+};
+
+// A fixed pool of worker threads with one deque each.  A worker takes its
+// own newest job first and steals the oldest one from the others when it
+// runs dry, so jobs spawned by a job mostly stay on the same core.  Jobs
+// queued from outside the pool go to a shared deque workers steal from.
+//
+// Jobs that need the GL context go to the main thread queue instead, which
+// only runs in PumpMain and in Wait on the main thread.
+class JobSystem
+{
+public:
+  // workers 0 takes one less than the hardware threads, but at least one.
+  // The thread that creates the system is the main thread.
+  JobSystem(uint32_t workers = 0);
+  virtual ~JobSystem();
+
+  // The process wide system, created on first use.  Call it once from the
+  // main thread before anything else does.
+  static JobSystem& Instance();
+
+  // Queues job, counting it in counter until it has run.
+  void Run(std::function<void()> job, JobCounter* counter = 0);
+
+  // Queues job once dependency is done, at once if it already is.
+  void RunAfter(JobCounter& dependency, std::function<void()> job,
+    JobCounter* counter = 0);
+
+  // Queues job for the main thread.
+  void RunOnMain(std::function<void()> job, JobCounter* counter = 0);
+  void RunOnMainAfter(JobCounter& dependency, std::function<void()> job,
+    JobCounter* counter = 0);
+
+  // Runs other jobs until counter is done.  Safe from inside a job.
+  void Wait(JobCounter& counter);
+
+  // body(begin,end) over [0,count) in pieces of at least grain, returning
+  // when all have run.  Ranges of a grain or less stay on this thread.
+  void ParallelFor(size_t count, size_t grain,
+    const std::function<void(size_t,size_t)>& body);
+
+  // Runs the main thread jobs queued so far.  Once per frame.
+  void PumpMain();
+
+  uint32_t GetWorkerCount() const
+  {
+    return (uint32_t)workers_.size();
+  }
+
+  bool IsMainThread() const
+  {
+    return std::this_thread::get_id() == main_;
+  }
+
+private:
+  // Jobs allocate under the memory tag of the thread that queued them.
+  struct Task
+  {
+    std::function<void()> job;
+    JobCounter* counter;
+    MemoryTag tag;
+  };
+
+  struct Queue
+  {
+    std::mutex mutex;
+    deque<Task> tasks;
+  };
+
+  static void Count(JobCounter* counter);
+  void Enqueue(Task& task, bool main);
+  bool Pop(Task& task);
+  bool PopMain(Task& task);
+  void Execute(Task& task);
+  void Worker(uint32_t index);
+
+  std::thread::id main_;
+  vector<std::thread> workers_;
+  // One per worker, the last for jobs queued from other threads.
+  vector<std::unique_ptr<Queue> > queues_;
+  Queue mainQueue_;
+  // What PumpMain runs, kept to not allocate a deque every frame.
+  deque<Task> pumped_;
+
+  // Jobs in the worker queues, workers sleep while there are none.
+  std::atomic<size_t> queued_;
+  std::mutex sleepMutex_;
+  std::condition_variable wake_;
+  bool quit_;
+};
+
+#endif
@@ -17,6 +17,17 @@ struct LOLMapMaterial
 		uint32_t unknown2[4][4]; // seems like matrix
 	} textures[8];
 
+	// Floats per vertex of the models drawn with this material.
+	int stride() const
+	{
+		switch(flag1)
+		{
+		case 0: return flag2 == 0 ? 9 : 10;
+		case 3: return 11;
+		default: return 9;
+		}
+	}
+
 	void dump(ostream& out)
 	{
 		out << name << endl;
@@ -90,5 +101,6 @@ struct LOLMap
 };
 
 LOLMap* read_map(const char* filename);
+void free_map(LOLMap* map);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,171 @@
+#ifndef Z_FASTMATH_H_
+#define Z_FASTMATH_H_
+
+#include "Core.h"
+#include "Math/Math.h"
+
+// How closely a call site needs the functions below.  MATH_FAST0 is the
+// cheapest Fast*0 approximation, each level after it the next more accurate
+// Fast* variant where one exists, and MATH_EXACT the library function.
+// bench/mathbench prints the cost and the error of every level.
+enum MathPrecision
+{
+	MATH_FAST0,
+	MATH_FAST1,
+	MATH_FAST2,
+	MATH_FAST3,
+	MATH_EXACT
+};
+
+// The Math functions that have Fast* approximations, at a precision chosen
+// at compile time.  The arguments must stay inside the ranges the Fast*
+// versions take, whatever the precision, so the choice can be changed
+// without touching the caller.  A call site names its precision through a
+// macro a build can override:
+//
+//	#ifndef Z_SLERP_PRECISION
+//	#define Z_SLERP_PRECISION MATH_EXACT
+//	#endif
+//
+//	FastMath<Real,Z_SLERP_PRECISION>::Sin(angle);
+
+template <typename Real, int Precision>
+class FastMath
+{
+public:
+	// The input must be in [0,pi/2].
+	static Real Sin (Real angle);
+	static Real Cos (Real angle);
+
+	// The input must be in [0,pi/4].
+	static Real Tan (Real angle);
+
+	// The input must be in [0,1].
+	static Real ASin (Real value);
+	static Real ACos (Real value);
+
+	// The input must be in [-1,1].
+	static Real ATan (Real value);
+
+	// exp(-value), the input must be in [0,infinity).
+	static Real NegExp (Real value);
+
+	// The input must be positive.
+	static Real InvSqrt (Real value);
+};
+
+// implementations
+
+template <typename Real, int Precision>
+inline Real FastMath<Real,Precision>::Sin (Real angle)
+{
+	if (Precision == MATH_FAST0)
+	{
+		return Math<Real>::FastSin0(angle);
+	}
+	if (Precision < MATH_EXACT)
+	{
+		return Math<Real>::FastSin1(angle);
+	}
+	return Math<Real>::Sin(angle);
+}
+
+template <typename Real, int Precision>
+inline Real FastMath<Real,Precision>::Cos (Real angle)
+{
+	if (Precision == MATH_FAST0)
+	{
+		return Math<Real>::FastCos0(angle);
+	}
+	if (Precision < MATH_EXACT)
+	{
+		return Math<Real>::FastCos1(angle);
+	}
+	return Math<Real>::Cos(angle);
+}
+
+template <typename Real, int Precision>
+inline Real FastMath<Real,Precision>::Tan (Real angle)
+{
+	if (Precision == MATH_FAST0)
+	{
+		return Math<Real>::FastTan0(angle);
+	}
+	if (Precision < MATH_EXACT)
+	{
+		return Math<Real>::FastTan1(angle);
+	}
+	return Math<Real>::Tan(angle);
+}
+
+template <typename Real, int Precision>
+inline Real FastMath<Real,Precision>::ASin (Real value)
+{
+	if (Precision == MATH_FAST0)
+	{
+		return Math<Real>::FastInvSin0(value);
+	}
+	if (Precision < MATH_EXACT)
+	{
+		return Math<Real>::FastInvSin1(value);
+	}
+	return Math<Real>::ASin(value);
+}
+
+template <typename Real, int Precision>
+inline Real FastMath<Real,Precision>::ACos (Real value)
+{
+	if (Precision == MATH_FAST0)
+	{
+		return Math<Real>::FastInvCos0(value);
+	}
+	if (Precision < MATH_EXACT)
+	{
+		return Math<Real>::FastInvCos1(value);
+	}
+	return Math<Real>::ACos(value);
+}
+
+template <typename Real, int Precision>
+inline Real FastMath<Real,Precision>::ATan (Real value)
+{
+	if (Precision == MATH_FAST0)
+	{
+		return Math<Real>::FastInvTan0(value);
+	}
+	if (Precision < MATH_EXACT)
+	{
+		return Math<Real>::FastInvTan1(value);
+	}
+	return Math<Real>::ATan(value);
+}
+
+template <typename Real, int Precision>
+inline Real FastMath<Real,Precision>::NegExp (Real value)
+{
+	switch (Precision)
+	{
+	case MATH_FAST0:
+		return Math<Real>::FastNegExp0(value);
+	case MATH_FAST1:
+		return Math<Real>::FastNegExp1(value);
+	case MATH_FAST2:
+		return Math<Real>::FastNegExp2(value);
+	case MATH_FAST3:
+		return Math<Real>::FastNegExp3(value);
+	default:
+		return Math<Real>::Exp(-value);
+	}
+}
+
+template <typename Real, int Precision>
+inline Real FastMath<Real,Precision>::InvSqrt (Real value)
+{
+	if (Precision < MATH_EXACT)
+	{
+		return Math<Real>::FastInvSqrt(value);
+	}
+	return Math<Real>::InvSqrt(value);
+}
+
+#endif
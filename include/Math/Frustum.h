@@ -0,0 +1,232 @@
+#ifndef Z_FRUSTUM_H_
+#define Z_FRUSTUM_H_
+
+#include "Core.h"
+#include "Math/Math.h"
+#include "Math/Vector3.h"
+#include "Math/Matrix4.h"
+#include "Math/Vector3Stream.h"
+
+// The six clip planes of a view-projection matrix, for culling boxes and
+// spheres.  Plane normals point into the frustum and are unit length, a
+// point p is inside plane k when Dot(normal,p) + d >= 0.
+//
+// The batched Cull functions write a visibility bitmask, bit i%32 of word
+// i/32 set when entry i is at least partly inside.  For float they run
+// four or eight entries at a time, the Reference versions are the plain
+// per-entry loop they must agree with.
+
+template <typename Real>
+class Frustum
+{
+public:
+
+	enum
+	{
+		PLANE_LEFT,
+		PLANE_RIGHT,
+		PLANE_BOTTOM,
+		PLANE_TOP,
+		PLANE_NEAR,
+		PLANE_FAR,
+		NUM_PLANES
+	};
+
+	// a, b, c, d of every plane.
+	Real planes[NUM_PLANES][4];
+
+	Frustum ();
+	Frustum (const Matrix4<Real>& mat);
+
+	// Planes of clip = mat*(x,y,z,1), with mat a projection or the product
+	// of projection and view.  The planes are in the space mat maps from.
+	void Extract (const Matrix4<Real>& mat);
+
+	// False when the box or sphere is entirely outside one of the planes.
+	// That test is conservative, a few boxes near the corners pass even
+	// though they are outside.
+	bool TestBox (const Vector3<Real>& center, const Vector3<Real>& extent)
+		const;
+	bool TestSphere (const Vector3<Real>& center, Real radius) const;
+
+	// Boxes given as centers and half extents.  visible holds
+	// GetMaskWords(centers.GetQuantity()) words.
+	void CullBoxes (const Vector3Stream<Real>& centers,
+		const Vector3Stream<Real>& extents, uint32_t* visible) const;
+	void CullSpheres (const Vector3Stream<Real>& centers, const Real* radii,
+		uint32_t* visible) const;
+
+	void CullBoxesReference (const Vector3Stream<Real>& centers,
+		const Vector3Stream<Real>& extents, uint32_t* visible) const;
+	void CullSpheresReference (const Vector3Stream<Real>& centers,
+		const Real* radii, uint32_t* visible) const;
+
+	inline static int GetMaskWords (int numEntries);
+	inline static bool IsVisible (const uint32_t* visible, int i);
+
+	// Entries the batched tests do per iteration, 1 when they only have
+	// the reference loop.  SetLanes forces a width for benchmarking and
+	// returns false, keeping the current one, if the CPU can't do it.
+	static int GetLanes ();
+	static bool SetLanes (int lanes);
+};
+
+// implementations
+
+template <typename Real>
+Frustum<Real>::Frustum ()
+{
+	// Uninitialized, like the other math types.
+}
+
+template <typename Real>
+Frustum<Real>::Frustum (const Matrix4<Real>& mat)
+{
+	Extract(mat);
+}
+
+template <typename Real>
+void Frustum<Real>::Extract (const Matrix4<Real>& mat)
+{
+	// Gribb and Hartmann, -w <= x,y,z <= w for each row of mat.
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			planes[2*i][j] = mat.m[3][j] + mat.m[i][j];
+			planes[2*i + 1][j] = mat.m[3][j] - mat.m[i][j];
+		}
+	}
+
+	for (int k = 0; k < NUM_PLANES; ++k)
+	{
+		Real* p = planes[k];
+		Real length = Math<Real>::Sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]);
+		if (length > Math<Real>::EPSILON)
+		{
+			Real invLength = ((Real)1)/length;
+			p[0] *= invLength;
+			p[1] *= invLength;
+			p[2] *= invLength;
+			p[3] *= invLength;
+		}
+	}
+}
+
+template <typename Real>
+bool Frustum<Real>::TestBox (const Vector3<Real>& center,
+	const Vector3<Real>& extent) const
+{
+	for (int k = 0; k < NUM_PLANES; ++k)
+	{
+		const Real* p = planes[k];
+		Real distance = p[0]*center.x + p[1]*center.y + p[2]*center.z + p[3];
+		Real radius = Math<Real>::FAbs(p[0])*extent.x +
+			Math<Real>::FAbs(p[1])*extent.y + Math<Real>::FAbs(p[2])*extent.z;
+		if (distance + radius < (Real)0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename Real>
+bool Frustum<Real>::TestSphere (const Vector3<Real>& center, Real radius)
+	const
+{
+	for (int k = 0; k < NUM_PLANES; ++k)
+	{
+		const Real* p = planes[k];
+		Real distance = p[0]*center.x + p[1]*center.y + p[2]*center.z + p[3];
+		if (distance + radius < (Real)0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename Real>
+void Frustum<Real>::CullBoxes (const Vector3Stream<Real>& centers,
+	const Vector3Stream<Real>& extents, uint32_t* visible) const
+{
+	CullBoxesReference(centers,extents,visible);
+}
+
+template <typename Real>
+void Frustum<Real>::CullSpheres (const Vector3Stream<Real>& centers,
+	const Real* radii, uint32_t* visible) const
+{
+	CullSpheresReference(centers,radii,visible);
+}
+
+template <typename Real>
+void Frustum<Real>::CullBoxesReference (const Vector3Stream<Real>& centers,
+	const Vector3Stream<Real>& extents, uint32_t* visible) const
+{
+	assertion(extents.GetQuantity() == centers.GetQuantity(),
+		"Stream size mismatch\n");
+
+	int n = centers.GetQuantity();
+	memset(visible,0,GetMaskWords(n)*sizeof(uint32_t));
+	for (int i = 0; i < n; ++i)
+	{
+		if (TestBox(centers.Get(i),extents.Get(i)))
+		{
+			visible[i >> 5] |= 1u << (i & 31);
+		}
+	}
+}
+
+template <typename Real>
+void Frustum<Real>::CullSpheresReference (const Vector3Stream<Real>& centers,
+	const Real* radii, uint32_t* visible) const
+{
+	int n = centers.GetQuantity();
+	memset(visible,0,GetMaskWords(n)*sizeof(uint32_t));
+	for (int i = 0; i < n; ++i)
+	{
+		if (TestSphere(centers.Get(i),radii[i]))
+		{
+			visible[i >> 5] |= 1u << (i & 31);
+		}
+	}
+}
+
+template <typename Real>
+inline int Frustum<Real>::GetMaskWords (int numEntries)
+{
+	return (numEntries + 31) >> 5;
+}
+
+template <typename Real>
+inline bool Frustum<Real>::IsVisible (const uint32_t* visible, int i)
+{
+	return (visible[i >> 5] >> (i & 31)) & 1;
+}
+
+template <typename Real>
+int Frustum<Real>::GetLanes ()
+{
+	return 1;
+}
+
+template <typename Real>
+bool Frustum<Real>::SetLanes (int lanes)
+{
+	return lanes == 1;
+}
+
+// Batched float kernels, in Frustum.cpp.
+template <> void Frustum<float>::CullBoxes (const Vector3Stream<float>& centers,
+	const Vector3Stream<float>& extents, uint32_t* visible) const;
+template <> void Frustum<float>::CullSpheres (
+	const Vector3Stream<float>& centers, const float* radii,
+	uint32_t* visible) const;
+template <> int Frustum<float>::GetLanes ();
+template <> bool Frustum<float>::SetLanes (int lanes);
+
+typedef Frustum<float> Frustumf;
+
+#endif
@@ -2,6 +2,7 @@
 #define Z_MATH_H_
 
 #include "Core.h"
+#include "Assert.h"
 
 template <typename Real>
 class Math
@@ -12,6 +13,7 @@ public:
 	// when the input is slightly larger than 1 or slightly smaller than -1.
 	// Other functions have the potential for using a fast and approximate
 	// algorithm rather than calling the standard math library functions.
+	// They call the std overloads, so Math<float> stays in float.
 	static Real ACos (Real value);
 	static Real ASin (Real value);
 	static Real ATan (Real value);
@@ -28,7 +30,7 @@ public:
 	static Real Log10 (Real value);
 	static Real Pow (Real base, Real exponent);
 	static Real Sin (Real value);
-	static Real Sqr (Real value);
+	static constexpr Real Sqr (Real value);
 	static Real Sqrt (Real value);
 	static Real Tan (Real value);
 
@@ -38,8 +40,8 @@ public:
 	static Real Sign (Real value);
 
 	// Convert between degrees and radians
-	static Real Radians (Real degrees);
-	static Real Degrees (Real radians);
+	static constexpr Real Radians (Real degrees);
+	static constexpr Real Degrees (Real radians);
 
 	// Generate a random number in [0,1].  The random number generator may
 	// be seeded by a first call to UnitRandom with a positive seed.
@@ -95,27 +97,47 @@ public:
 	// Fast approximations to InvSqrt
 	static Real FastInvSqrt (Real value);
 
-	// Common constants.
-	static const Real EPSILON;
-	static const Real MAX_VALUE;
-	static const Real MIN_VALUE;
-	static const Real PI;
-	static const Real TWO_PI;
-	static const Real HALF_PI;
-	static const Real INV_PI;
-	static const Real INV_TWO_PI;
-	static const Real DEG_TO_RAD;
-	static const Real RAD_TO_DEG;
-	static const Real LN_2;
-	static const Real LN_10;
-	static const Real INV_LN_2;
-	static const Real INV_LN_10;
-	static const Real SQRT_2;
-	static const Real INV_SQRT_2;
-	static const Real SQRT_3;
-	static const Real INV_SQRT_3;
+	// Common constants, usable in constant expressions.
+	static constexpr Real EPSILON = std::numeric_limits<Real>::epsilon();
+	static constexpr Real MAX_VALUE = std::numeric_limits<Real>::max();
+	static constexpr Real MIN_VALUE = std::numeric_limits<Real>::min();
+	static constexpr Real PI = (Real)3.14159265358979323846L;
+	static constexpr Real TWO_PI = (Real)2*PI;
+	static constexpr Real HALF_PI = (Real)0.5*PI;
+	static constexpr Real INV_PI = (Real)1/PI;
+	static constexpr Real INV_TWO_PI = (Real)1/TWO_PI;
+	static constexpr Real DEG_TO_RAD = PI/(Real)180;
+	static constexpr Real RAD_TO_DEG = (Real)180/PI;
+	static constexpr Real LN_2 = (Real)0.69314718055994530942L;
+	static constexpr Real LN_10 = (Real)2.30258509299404568402L;
+	static constexpr Real INV_LN_2 = (Real)1/LN_2;
+	static constexpr Real INV_LN_10 = (Real)1/LN_10;
+	static constexpr Real SQRT_2 = (Real)1.41421356237309504880L;
+	static constexpr Real INV_SQRT_2 = (Real)1/SQRT_2;
+	static constexpr Real SQRT_3 = (Real)1.73205080756887729353L;
+	static constexpr Real INV_SQRT_3 = (Real)1/SQRT_3;
 };
 
+// Definitions for the constants bound to references, the values are above.
+template <typename Real> constexpr Real Math<Real>::EPSILON;
+template <typename Real> constexpr Real Math<Real>::MAX_VALUE;
+template <typename Real> constexpr Real Math<Real>::MIN_VALUE;
+template <typename Real> constexpr Real Math<Real>::PI;
+template <typename Real> constexpr Real Math<Real>::TWO_PI;
+template <typename Real> constexpr Real Math<Real>::HALF_PI;
+template <typename Real> constexpr Real Math<Real>::INV_PI;
+template <typename Real> constexpr Real Math<Real>::INV_TWO_PI;
+template <typename Real> constexpr Real Math<Real>::DEG_TO_RAD;
+template <typename Real> constexpr Real Math<Real>::RAD_TO_DEG;
+template <typename Real> constexpr Real Math<Real>::LN_2;
+template <typename Real> constexpr Real Math<Real>::LN_10;
+template <typename Real> constexpr Real Math<Real>::INV_LN_2;
+template <typename Real> constexpr Real Math<Real>::INV_LN_10;
+template <typename Real> constexpr Real Math<Real>::SQRT_2;
+template <typename Real> constexpr Real Math<Real>::INV_SQRT_2;
+template <typename Real> constexpr Real Math<Real>::SQRT_3;
+template <typename Real> constexpr Real Math<Real>::INV_SQRT_3;
+
 template <typename Real>
 Real Math<Real>::ACos (Real value)
 {
@@ -123,7 +145,7 @@ Real Math<Real>::ACos (Real value)
 	{
 		if (value < (Real)1)
 		{
-			return acos(value);
+			return std::acos(value);
 		}
 		else
 		{
@@ -143,7 +165,7 @@ Real Math<Real>::ASin (Real value)
 	{
 		if (value < (Real)1)
 		{
-			return asin(value);
+			return std::asin(value);
 		}
 		else
 		{
@@ -159,7 +181,7 @@ Real Math<Real>::ASin (Real value)
 template <typename Real>
 Real Math<Real>::ATan (Real value)
 {
-	return atan(value);
+	return std::atan(value);
 }
 
 template <typename Real>
@@ -167,7 +189,7 @@ Real Math<Real>::ATan2 (Real y, Real x)
 {
 	if (x != (Real)0 || y != (Real)0)
 	{
-		return atan2(y, x);
+		return std::atan2(y, x);
 	}
 	else
 	{
@@ -180,31 +202,31 @@ Real Math<Real>::ATan2 (Real y, Real x)
 template <typename Real>
 Real Math<Real>::Ceil (Real value)
 {
-	return ceil(value);
+	return std::ceil(value);
 }
 
 template <typename Real>
 Real Math<Real>::Cos (Real value)
 {
-	return cos(value);
+	return std::cos(value);
 }
 
 template <typename Real>
 Real Math<Real>::Exp (Real value)
 {
-	return exp(value);
+	return std::exp(value);
 }
 
 template <typename Real>
 Real Math<Real>::FAbs (Real value)
 {
-	return fabs(value);
+	return std::fabs(value);
 }
 
 template <typename Real>
 Real Math<Real>::Floor (Real value)
 {
-	return floor(value);
+	return std::floor(value);
 }
 
 template <typename Real>
@@ -212,7 +234,7 @@ Real Math<Real>::FMod (Real x, Real y)
 {
 	if (y != (Real)0)
 	{
-		return fmod(x, y);
+		return std::fmod(x, y);
 	}
 	else
 	{
@@ -226,7 +248,7 @@ Real Math<Real>::InvSqrt (Real value)
 {
 	if (value != (Real)0)
 	{
-		return ((Real)1)/sqrt(value);
+		return ((Real)1)/std::sqrt(value);
 	}
 	else
 	{
@@ -240,7 +262,7 @@ Real Math<Real>::Log (Real value)
 {
 	if (value > (Real)0)
 	{
-		return log(value);
+		return std::log(value);
 	}
 	else
 	{
@@ -254,7 +276,7 @@ Real Math<Real>::Log2 (Real value)
 {
 	if (value > (Real)0)
 	{
-		return Math<Real>::INV_LN_2 * log(value);
+		return Math<Real>::INV_LN_2 * std::log(value);
 	}
 	else
 	{
@@ -268,7 +290,7 @@ Real Math<Real>::Log10 (Real value)
 {
 	if (value > (Real)0)
 	{
-		return Math<Real>::INV_LN_10 * log(value);
+		return Math<Real>::INV_LN_10 * std::log(value);
 	}
 	else
 	{
@@ -282,7 +304,7 @@ Real Math<Real>::Pow (Real base, Real exponent)
 {
 	if (base >= (Real)0)
 	{
-		return pow(base, exponent);
+		return std::pow(base, exponent);
 	}
 	else
 	{
@@ -294,11 +316,11 @@ Real Math<Real>::Pow (Real base, Real exponent)
 template <typename Real>
 Real Math<Real>::Sin (Real value)
 {
-	return sin(value);
+	return std::sin(value);
 }
 
 template <typename Real>
-Real Math<Real>::Sqr (Real value)
+constexpr Real Math<Real>::Sqr (Real value)
 {
 	return value*value;
 }
@@ -308,7 +330,7 @@ Real Math<Real>::Sqrt (Real value)
 {
 	if (value >= (Real)0)
 	{
-		return sqrt(value);
+		return std::sqrt(value);
 	}
 	else
 	{
@@ -320,7 +342,7 @@ Real Math<Real>::Sqrt (Real value)
 template <typename Real>
 Real Math<Real>::Tan (Real value)
 {
-	return tan(value);
+	return std::tan(value);
 }
 
 template <typename Real>
@@ -356,13 +378,13 @@ Real Math<Real>::Sign (Real value)
 }
 
 template <typename Real>
-Real Math<Real>::Radians (Real degrees)
+constexpr Real Math<Real>::Radians (Real degrees)
 {
 	return degrees * (PI * (Real)0.00555555555);
 }
 
 template <typename Real>
-Real Math<Real>::Degrees (Real radians)
+constexpr Real Math<Real>::Degrees (Real radians)
 {
 	return radians * ((Real)180 * INV_PI);
 }
@@ -712,19 +734,20 @@ Real Math<Real>::FastNegExp3 (Real value)
 template <typename Real>
 Real Math<Real>::FastInvSqrt (Real value)
 {
+	// Always in float, the magic constant is for its bit layout.
 	int32_t i;
 	float x2, y;
 	const float threehalfs = 1.5f;
 
-	x2 = value * 0.5f;
-	y = value;
-	i = * ( int32_t * ) &y;						// massive hack
+	x2 = (float)value * 0.5f;
+	y = (float)value;
+	memcpy(&i,&y,sizeof(i));					// reinterpret, not convert
 	i = 0x5f3759df - ( i >> 1 );				// magic constant 0x5f3759df
-	y = * ( int32_t * ) &i;
+	memcpy(&y,&i,sizeof(y));
 	y = y * ( threehalfs - ( x2 * y * y ) );	// 1st Newton iteration
 	y = y * ( threehalfs - ( x2 * y * y ) );	// 2nd Newton iteration
 
-	return y;
+	return (Real)y;
 }
 
 #endif
@@ -1,224 +1,515 @@
-#ifndef _MATRIX3_H_
-#define _MATRIX3_H_
+#ifndef Z_MATRIX3_H_
+#define Z_MATRIX3_H_
 
 #include "Core.h"
+#include "Math/Math.h"
+#include "Math/Vector3.h"
+#include "Math/Matrix4.h"
 
-#include "Vector3.h"
+// Rotations and other linear maps of 3-space.  Row major like Matrix4,
+// and vectors are columns, so M*vec.  Rotations by a positive angle are
+// counterclockwise looking from the positive end of the axis.
 
-class _OgreExport Matrix3
+template <typename Real>
+class Matrix3
 {
 public:
-    /** Default constructor.
-        @note
-            It does <b>NOT</b> initialize the matrix for efficiency.
-    */
-    inline Matrix3 () {}
-    inline explicit Matrix3 (const Real arr[3][3])
-    {
-        memcpy(m,arr,9*sizeof(Real));
-    }
-    inline Matrix3 (const Matrix3& rkMatrix)
-    {
-        memcpy(m,rkMatrix.m,9*sizeof(Real));
-    }
-    Matrix3 (Real fEntry00, Real fEntry01, Real fEntry02,
-                Real fEntry10, Real fEntry11, Real fEntry12,
-                Real fEntry20, Real fEntry21, Real fEntry22)
-    {
-        m[0][0] = fEntry00;
-        m[0][1] = fEntry01;
-        m[0][2] = fEntry02;
-        m[1][0] = fEntry10;
-        m[1][1] = fEntry11;
-        m[1][2] = fEntry12;
-        m[2][0] = fEntry20;
-        m[2][1] = fEntry21;
-        m[2][2] = fEntry22;
-    }
-
-    /** Exchange the contents of this matrix with another. 
-    */
-    inline void swap(Matrix3& other)
-    {
-        std::swap(m[0][0], other.m[0][0]);
-        std::swap(m[0][1], other.m[0][1]);
-        std::swap(m[0][2], other.m[0][2]);
-        std::swap(m[1][0], other.m[1][0]);
-        std::swap(m[1][1], other.m[1][1]);
-        std::swap(m[1][2], other.m[1][2]);
-        std::swap(m[2][0], other.m[2][0]);
-        std::swap(m[2][1], other.m[2][1]);
-        std::swap(m[2][2], other.m[2][2]);
-    }
-
-    // member access, allows use of construct mat[r][c]
-    inline Real* operator[] (size_t iRow) const
-    {
-        return const_cast<Real*>(m[iRow]);
-    }
-    /*inline operator Real* ()
-    {
-        return (Real*)m[0];
-    }*/
-    Vector3 GetColumn (size_t iCol) const;
-    void SetColumn(size_t iCol, const Vector3& vec);
-    void FromAxes(const Vector3& xAxis, const Vector3& yAxis, const Vector3& zAxis);
-
-    // assignment and comparison
-    inline Matrix3& operator= (const Matrix3& rkMatrix)
-    {
-        memcpy(m,rkMatrix.m,9*sizeof(Real));
-        return *this;
-    }
-
-    /** Tests 2 matrices for equality.
-     */
-    bool operator== (const Matrix3& rkMatrix) const;
-
-    /** Tests 2 matrices for inequality.
-     */
-    inline bool operator!= (const Matrix3& rkMatrix) const
-    {
-        return !operator==(rkMatrix);
-    }
-
-    // arithmetic operations
-    /** Matrix addition.
-     */
-    Matrix3 operator+ (const Matrix3& rkMatrix) const;
-
-    /** Matrix subtraction.
-     */
-    Matrix3 operator- (const Matrix3& rkMatrix) const;
-
-    /** Matrix concatenation using '*'.
-     */
-    Matrix3 operator* (const Matrix3& rkMatrix) const;
-    Matrix3 operator- () const;
-
-    /// Matrix * vector [3x3 * 3x1 = 3x1]
-    Vector3 operator* (const Vector3& rkVector) const;
-
-    /// Vector * matrix [1x3 * 3x3 = 1x3]
-    _OgreExport friend Vector3 operator* (const Vector3& rkVector,
-        const Matrix3& rkMatrix);
-
-    /// Matrix * scalar
-    Matrix3 operator* (Real fScalar) const;
-
-    /// Scalar * matrix
-    _OgreExport friend Matrix3 operator* (Real fScalar, const Matrix3& rkMatrix);
-
-    // utilities
-    Matrix3 Transpose () const;
-    bool Inverse (Matrix3& rkInverse, Real fTolerance = 1e-06) const;
-    Matrix3 Inverse (Real fTolerance = 1e-06) const;
-    Real Determinant () const;
-
-    // singular value decomposition
-    void SingularValueDecomposition (Matrix3& rkL, Vector3& rkS,
-        Matrix3& rkR) const;
-    void SingularValueComposition (const Matrix3& rkL,
-        const Vector3& rkS, const Matrix3& rkR);
-
-    /// Gram-Schmidt orthonormalization (applied to columns of rotation matrix)
-    void Orthonormalize ();
-
-    /// Orthogonal Q, diagonal D, upper triangular U stored as (u01,u02,u12)
-    void QDUDecomposition (Matrix3& rkQ, Vector3& rkD,
-        Vector3& rkU) const;
-
-    Real SpectralNorm () const;
-
-    // matrix must be orthonormal
-    void ToAngleAxis (Vector3& rkAxis, Radian& rfAngle) const;
-    inline void ToAngleAxis (Vector3& rkAxis, Degree& rfAngle) const {
-        Radian r;
-        ToAngleAxis ( rkAxis, r );
-        rfAngle = r;
-    }
-    void FromAngleAxis (const Vector3& rkAxis, const Radian& fRadians);
-
-    // The matrix must be orthonormal.  The decomposition is yaw*pitch*roll
-    // where yaw is rotation about the Up vector, pitch is rotation about the
-    // Right axis, and roll is rotation about the Direction axis.
-    bool ToEulerAnglesXYZ (Radian& rfYAngle, Radian& rfPAngle,
-        Radian& rfRAngle) const;
-    bool ToEulerAnglesXZY (Radian& rfYAngle, Radian& rfPAngle,
-        Radian& rfRAngle) const;
-    bool ToEulerAnglesYXZ (Radian& rfYAngle, Radian& rfPAngle,
-        Radian& rfRAngle) const;
-    bool ToEulerAnglesYZX (Radian& rfYAngle, Radian& rfPAngle,
-        Radian& rfRAngle) const;
-    bool ToEulerAnglesZXY (Radian& rfYAngle, Radian& rfPAngle,
-        Radian& rfRAngle) const;
-    bool ToEulerAnglesZYX (Radian& rfYAngle, Radian& rfPAngle,
-        Radian& rfRAngle) const;
-    void FromEulerAnglesXYZ (const Radian& fYAngle, const Radian& fPAngle, const Radian& fRAngle);
-    void FromEulerAnglesXZY (const Radian& fYAngle, const Radian& fPAngle, const Radian& fRAngle);
-    void FromEulerAnglesYXZ (const Radian& fYAngle, const Radian& fPAngle, const Radian& fRAngle);
-    void FromEulerAnglesYZX (const Radian& fYAngle, const Radian& fPAngle, const Radian& fRAngle);
-    void FromEulerAnglesZXY (const Radian& fYAngle, const Radian& fPAngle, const Radian& fRAngle);
-    void FromEulerAnglesZYX (const Radian& fYAngle, const Radian& fPAngle, const Radian& fRAngle);
-    /// Eigensolver, matrix must be symmetric
-    void EigenSolveSymmetric (Real afEigenvalue[3],
-        Vector3 akEigenvector[3]) const;
-
-    static void TensorProduct (const Vector3& rkU, const Vector3& rkV,
-        Matrix3& rkProduct);
-
-    /** Determines if this matrix involves a scaling. */
-    inline bool hasScale() const
-    {
-        // check magnitude of column vectors (==local axes)
-        Real t = m[0][0] * m[0][0] + m[1][0] * m[1][0] + m[2][0] * m[2][0];
-        if (!Math::RealEqual(t, 1.0, (Real)1e-04))
-            return true;
-        t = m[0][1] * m[0][1] + m[1][1] * m[1][1] + m[2][1] * m[2][1];
-        if (!Math::RealEqual(t, 1.0, (Real)1e-04))
-            return true;
-        t = m[0][2] * m[0][2] + m[1][2] * m[1][2] + m[2][2] * m[2][2];
-        if (!Math::RealEqual(t, 1.0, (Real)1e-04))
-            return true;
-
-        return false;
-    }
-
-    /** Function for writing to a stream.
-    */
-    inline _OgreExport friend std::ostream& operator <<
-        ( std::ostream& o, const Matrix3& mat )
-    {
-        o << "Matrix3(" << mat[0][0] << ", " << mat[0][1] << ", " << mat[0][2] << ", " 
-                        << mat[1][0] << ", " << mat[1][1] << ", " << mat[1][2] << ", " 
-                        << mat[2][0] << ", " << mat[2][1] << ", " << mat[2][2] << ")";
-        return o;
-    }
-
-    static const Real EPSILON;
-    static const Matrix3 ZERO;
-    static const Matrix3 IDENTITY;
-
-protected:
-    // support for eigensolver
-    void Tridiagonal (Real afDiag[3], Real afSubDiag[3]);
-    bool QLAlgorithm (Real afDiag[3], Real afSubDiag[3]);
-
-    // support for singular value decomposition
-    static const Real msSvdEpsilon;
-    static const unsigned int msSvdMaxIterations;
-    static void Bidiagonalize (Matrix3& kA, Matrix3& kL,
-        Matrix3& kR);
-    static void GolubKahanStep (Matrix3& kA, Matrix3& kL,
-        Matrix3& kR);
-
-    // support for spectral norm
-    static Real MaxCubicRoot (Real afCoeff[3]);
-
-    Real m[3][3];
-
-    // for faster access
-    friend class Matrix4;
+	union
+	{
+		struct
+		{
+			Real m00, m01, m02;
+			Real m10, m11, m12;
+			Real m20, m21, m22;
+		};
+		Real m[3][3];
+		Real _m[9];
+	};
+
+	// Default, uninitialized.
+	Matrix3 ();
+
+	// Input mrc is in row r, column c.
+	constexpr Matrix3 (
+		Real m00, Real m01, Real m02,
+		Real m10, Real m11, Real m12,
+		Real m20, Real m21, Real m22);
+
+	// The vectors are the columns of the matrix when columns is true, the
+	// rows otherwise.
+	Matrix3 (const Vector3<Real>& u, const Vector3<Real>& v,
+		const Vector3<Real>& w, bool columns);
+
+	// Rotation of angle radians about a unit-length axis.
+	Matrix3 (const Vector3<Real>& axis, Real angle);
+
+	// The upper left 3x3 block of mat.
+	explicit Matrix3 (const Matrix4<Real>& mat);
+
+	// Arithmetic operations.
+	constexpr Matrix3 operator+ (const Matrix3& mat) const;
+	constexpr Matrix3 operator- (const Matrix3& mat) const;
+	constexpr Matrix3 operator* (Real scalar) const;
+	constexpr Matrix3 operator- () const;
+
+	inline Real* operator[] (size_t index);
+	inline const Real* operator[] (size_t index) const;
+
+	// M^T
+	constexpr Matrix3 Transpose () const;
+
+	// M*mat
+	Matrix3 operator* (const Matrix3& mat) const;
+
+	// M*vec
+	Vector3<Real> operator* (const Vector3<Real>& vec) const;
+
+	// M^T*mat and M*mat^T
+	Matrix3 TransposeTimes (const Matrix3& mat) const;
+	Matrix3 TimesTranspose (const Matrix3& mat) const;
+
+	// Other operations.
+	Matrix3 Inverse (const Real epsilon = Math<Real>::EPSILON) const;
+	Matrix3 Adjoint () const;
+	Real Determinant () const;
+
+	// Conversions for rotation matrices.  ToAxisAngle returns the angle in
+	// [0,pi] and the axis it turns about.
+	void MakeRotation (const Vector3<Real>& axis, Real angle);
+	void ToAxisAngle (Vector3<Real>& axis, Real& angle) const;
+
+	// Gram-Schmidt on the columns, for rotations that drifted.
+	void Orthonormalize ();
+
+	// Affine Matrix4 with this as the linear part.
+	Matrix4<Real> ToMatrix4 (
+		const Vector3<Real>& translation = Vector3<Real>::ZERO) const;
+
+	// Special matrices.
+	static const Matrix3 ZERO;
+	static const Matrix3 IDENTITY;
 };
 
-#endif
\ No newline at end of file
+// c * M
+template <typename Real>
+constexpr Matrix3<Real> operator* (Real scalar, const Matrix3<Real>& mat);
+
+// vec^T * M
+template <typename Real>
+Vector3<Real> operator* (const Vector3<Real>& vec, const Matrix3<Real>& mat);
+
+template <typename Real>
+std::ostream& operator<< (std::ostream& outStream, const Matrix3<Real>& mat);
+
+// implementations
+
+template <typename Real>
+Matrix3<Real>::Matrix3 ()
+{
+}
+
+template <typename Real>
+constexpr Matrix3<Real>::Matrix3 (Real m00, Real m01, Real m02,
+	Real m10, Real m11, Real m12, Real m20, Real m21, Real m22)
+	: _m{
+		m00, m01, m02,
+		m10, m11, m12,
+		m20, m21, m22}
+{
+}
+
+template <typename Real> constexpr Matrix3<Real> Matrix3<Real>::ZERO(
+	0, 0, 0,
+	0, 0, 0,
+	0, 0, 0
+);
+
+template <typename Real> constexpr Matrix3<Real> Matrix3<Real>::IDENTITY(
+	1, 0, 0,
+	0, 1, 0,
+	0, 0, 1
+);
+
+template <typename Real>
+Matrix3<Real>::Matrix3 (const Vector3<Real>& u, const Vector3<Real>& v,
+	const Vector3<Real>& w, bool columns)
+{
+	if (columns)
+	{
+		_m[0] = u.x;
+		_m[1] = v.x;
+		_m[2] = w.x;
+		_m[3] = u.y;
+		_m[4] = v.y;
+		_m[5] = w.y;
+		_m[6] = u.z;
+		_m[7] = v.z;
+		_m[8] = w.z;
+	}
+	else
+	{
+		_m[0] = u.x;
+		_m[1] = u.y;
+		_m[2] = u.z;
+		_m[3] = v.x;
+		_m[4] = v.y;
+		_m[5] = v.z;
+		_m[6] = w.x;
+		_m[7] = w.y;
+		_m[8] = w.z;
+	}
+}
+
+template <typename Real>
+Matrix3<Real>::Matrix3 (const Vector3<Real>& axis, Real angle)
+{
+	MakeRotation(axis,angle);
+}
+
+template <typename Real>
+Matrix3<Real>::Matrix3 (const Matrix4<Real>& mat)
+{
+	_m[0] = mat._m[ 0];
+	_m[1] = mat._m[ 1];
+	_m[2] = mat._m[ 2];
+	_m[3] = mat._m[ 4];
+	_m[4] = mat._m[ 5];
+	_m[5] = mat._m[ 6];
+	_m[6] = mat._m[ 8];
+	_m[7] = mat._m[ 9];
+	_m[8] = mat._m[10];
+}
+
+template <typename Real>
+constexpr Matrix3<Real> Matrix3<Real>::operator+ (const Matrix3& mat) const
+{
+	return Matrix3<Real>
+	(
+		_m[0] + mat._m[0],
+		_m[1] + mat._m[1],
+		_m[2] + mat._m[2],
+		_m[3] + mat._m[3],
+		_m[4] + mat._m[4],
+		_m[5] + mat._m[5],
+		_m[6] + mat._m[6],
+		_m[7] + mat._m[7],
+		_m[8] + mat._m[8]
+	);
+}
+
+template <typename Real>
+constexpr Matrix3<Real> Matrix3<Real>::operator- (const Matrix3& mat) const
+{
+	return Matrix3<Real>
+	(
+		_m[0] - mat._m[0],
+		_m[1] - mat._m[1],
+		_m[2] - mat._m[2],
+		_m[3] - mat._m[3],
+		_m[4] - mat._m[4],
+		_m[5] - mat._m[5],
+		_m[6] - mat._m[6],
+		_m[7] - mat._m[7],
+		_m[8] - mat._m[8]
+	);
+}
+
+template <typename Real>
+constexpr Matrix3<Real> Matrix3<Real>::operator* (Real scalar) const
+{
+	return Matrix3<Real>
+	(
+		scalar*_m[0],
+		scalar*_m[1],
+		scalar*_m[2],
+		scalar*_m[3],
+		scalar*_m[4],
+		scalar*_m[5],
+		scalar*_m[6],
+		scalar*_m[7],
+		scalar*_m[8]
+	);
+}
+
+template <typename Real>
+constexpr Matrix3<Real> Matrix3<Real>::operator- () const
+{
+	return Matrix3<Real>
+	(
+		-_m[0],
+		-_m[1],
+		-_m[2],
+		-_m[3],
+		-_m[4],
+		-_m[5],
+		-_m[6],
+		-_m[7],
+		-_m[8]
+	);
+}
+
+template <typename Real>
+inline Real* Matrix3<Real>::operator[] (size_t index)
+{
+	assertion(index < 3, "Matrix3 index out of range\n");
+	return m[index];
+}
+
+template <typename Real>
+inline const Real* Matrix3<Real>::operator[] (size_t index) const
+{
+	assertion(index < 3, "Matrix3 index out of range\n");
+	return m[index];
+}
+
+template <typename Real>
+constexpr Matrix3<Real> Matrix3<Real>::Transpose () const
+{
+	return Matrix3<Real>
+	(
+		_m[0], _m[3], _m[6],
+		_m[1], _m[4], _m[7],
+		_m[2], _m[5], _m[8]
+	);
+}
+
+template <typename Real>
+Matrix3<Real> Matrix3<Real>::operator* (const Matrix3& mat) const
+{
+	return Matrix3<Real>
+	(
+		_m[0]*mat._m[0] + _m[1]*mat._m[3] + _m[2]*mat._m[6],
+		_m[0]*mat._m[1] + _m[1]*mat._m[4] + _m[2]*mat._m[7],
+		_m[0]*mat._m[2] + _m[1]*mat._m[5] + _m[2]*mat._m[8],
+		_m[3]*mat._m[0] + _m[4]*mat._m[3] + _m[5]*mat._m[6],
+		_m[3]*mat._m[1] + _m[4]*mat._m[4] + _m[5]*mat._m[7],
+		_m[3]*mat._m[2] + _m[4]*mat._m[5] + _m[5]*mat._m[8],
+		_m[6]*mat._m[0] + _m[7]*mat._m[3] + _m[8]*mat._m[6],
+		_m[6]*mat._m[1] + _m[7]*mat._m[4] + _m[8]*mat._m[7],
+		_m[6]*mat._m[2] + _m[7]*mat._m[5] + _m[8]*mat._m[8]
+	);
+}
+
+template <typename Real>
+Vector3<Real> Matrix3<Real>::operator* (const Vector3<Real>& vec) const
+{
+	return Vector3<Real>
+	(
+		_m[0]*vec.x + _m[1]*vec.y + _m[2]*vec.z,
+		_m[3]*vec.x + _m[4]*vec.y + _m[5]*vec.z,
+		_m[6]*vec.x + _m[7]*vec.y + _m[8]*vec.z
+	);
+}
+
+template <typename Real>
+Matrix3<Real> Matrix3<Real>::TransposeTimes (const Matrix3& mat) const
+{
+	return Transpose()*mat;
+}
+
+template <typename Real>
+Matrix3<Real> Matrix3<Real>::TimesTranspose (const Matrix3& mat) const
+{
+	return (*this)*mat.Transpose();
+}
+
+template <typename Real>
+Matrix3<Real> Matrix3<Real>::Inverse (const Real epsilon) const
+{
+	Matrix3 adjoint = Adjoint();
+	Real det = _m[0]*adjoint._m[0] + _m[1]*adjoint._m[3] +
+		_m[2]*adjoint._m[6];
+
+	if (Math<Real>::FAbs(det) > epsilon)
+	{
+		return adjoint*(((Real)1)/det);
+	}
+
+	return ZERO;
+}
+
+template <typename Real>
+Matrix3<Real> Matrix3<Real>::Adjoint () const
+{
+	return Matrix3<Real>
+	(
+		_m[4]*_m[8] - _m[5]*_m[7],
+		_m[2]*_m[7] - _m[1]*_m[8],
+		_m[1]*_m[5] - _m[2]*_m[4],
+		_m[5]*_m[6] - _m[3]*_m[8],
+		_m[0]*_m[8] - _m[2]*_m[6],
+		_m[2]*_m[3] - _m[0]*_m[5],
+		_m[3]*_m[7] - _m[4]*_m[6],
+		_m[1]*_m[6] - _m[0]*_m[7],
+		_m[0]*_m[4] - _m[1]*_m[3]
+	);
+}
+
+template <typename Real>
+Real Matrix3<Real>::Determinant () const
+{
+	Real co00 = _m[4]*_m[8] - _m[5]*_m[7];
+	Real co10 = _m[5]*_m[6] - _m[3]*_m[8];
+	Real co20 = _m[3]*_m[7] - _m[4]*_m[6];
+	Real det = _m[0]*co00 + _m[1]*co10 + _m[2]*co20;
+	return det;
+}
+
+template <typename Real>
+void Matrix3<Real>::MakeRotation (const Vector3<Real>& axis, Real angle)
+{
+	Real cs = Math<Real>::Cos(angle);
+	Real sn = Math<Real>::Sin(angle);
+	Real oneMinusCos = ((Real)1) - cs;
+	Real x2 = axis.x*axis.x;
+	Real y2 = axis.y*axis.y;
+	Real z2 = axis.z*axis.z;
+	Real xym = axis.x*axis.y*oneMinusCos;
+	Real xzm = axis.x*axis.z*oneMinusCos;
+	Real yzm = axis.y*axis.z*oneMinusCos;
+	Real xSin = axis.x*sn;
+	Real ySin = axis.y*sn;
+	Real zSin = axis.z*sn;
+
+	_m[0] = x2*oneMinusCos + cs;
+	_m[1] = xym - zSin;
+	_m[2] = xzm + ySin;
+	_m[3] = xym + zSin;
+	_m[4] = y2*oneMinusCos + cs;
+	_m[5] = yzm - xSin;
+	_m[6] = xzm - ySin;
+	_m[7] = yzm + xSin;
+	_m[8] = z2*oneMinusCos + cs;
+}
+
+template <typename Real>
+void Matrix3<Real>::ToAxisAngle (Vector3<Real>& axis, Real& angle) const
+{
+	// angle = acos((trace-1)/2), the axis is the eigenvector for 1.  Near
+	// 0 any axis works, near pi the antisymmetric part vanishes and the
+	// axis comes from the largest diagonal entry instead.
+	Real trace = _m[0] + _m[4] + _m[8];
+	Real cs = ((Real)0.5)*(trace - (Real)1);
+	angle = Math<Real>::ACos(cs);
+
+	if (angle > (Real)0)
+	{
+		if (angle < Math<Real>::PI)
+		{
+			axis.x = _m[7] - _m[5];
+			axis.y = _m[2] - _m[6];
+			axis.z = _m[3] - _m[1];
+			axis.Normalize();
+		}
+		else
+		{
+			Real halfInverse;
+			if (_m[0] >= _m[4])
+			{
+				if (_m[0] >= _m[8])
+				{
+					axis.x = ((Real)0.5)*Math<Real>::Sqrt(((Real)1)
+						+ _m[0] - _m[4] - _m[8]);
+					halfInverse = ((Real)0.5)/axis.x;
+					axis.y = halfInverse*_m[1];
+					axis.z = halfInverse*_m[2];
+				}
+				else
+				{
+					axis.z = ((Real)0.5)*Math<Real>::Sqrt(((Real)1)
+						+ _m[8] - _m[0] - _m[4]);
+					halfInverse = ((Real)0.5)/axis.z;
+					axis.x = halfInverse*_m[2];
+					axis.y = halfInverse*_m[5];
+				}
+			}
+			else
+			{
+				if (_m[4] >= _m[8])
+				{
+					axis.y = ((Real)0.5)*Math<Real>::Sqrt(((Real)1)
+						+ _m[4] - _m[0] - _m[8]);
+					halfInverse  = ((Real)0.5)/axis.y;
+					axis.x = halfInverse*_m[1];
+					axis.z = halfInverse*_m[5];
+				}
+				else
+				{
+					axis.z = ((Real)0.5)*Math<Real>::Sqrt(((Real)1)
+						+ _m[8] - _m[0] - _m[4]);
+					halfInverse = ((Real)0.5)/axis.z;
+					axis.x = halfInverse*_m[2];
+					axis.y = halfInverse*_m[5];
+				}
+			}
+		}
+	}
+	else
+	{
+		axis = Vector3<Real>::UNIT_X;
+	}
+}
+
+template <typename Real>
+void Matrix3<Real>::Orthonormalize ()
+{
+	Vector3<Real> u(_m[0],_m[3],_m[6]);
+	Vector3<Real> v(_m[1],_m[4],_m[7]);
+	Vector3<Real> w(_m[2],_m[5],_m[8]);
+
+	u.Normalize();
+	v -= u*u.Dot(v);
+	v.Normalize();
+	w -= u*u.Dot(w) + v*v.Dot(w);
+	w.Normalize();
+
+	*this = Matrix3(u,v,w,true);
+}
+
+template <typename Real>
+Matrix4<Real> Matrix3<Real>::ToMatrix4 (const Vector3<Real>& translation)
+	const
+{
+	return Matrix4<Real>
+	(
+		_m[0], _m[1], _m[2], translation.x,
+		_m[3], _m[4], _m[5], translation.y,
+		_m[6], _m[7], _m[8], translation.z,
+		0, 0, 0, 1
+	);
+}
+
+template <typename Real>
+constexpr Matrix3<Real> operator* (Real scalar, const Matrix3<Real>& mat)
+{
+	return mat*scalar;
+}
+
+template <typename Real>
+Vector3<Real> operator* (const Vector3<Real>& vec, const Matrix3<Real>& mat)
+{
+	return Vector3<Real>
+	(
+		vec.x*mat._m[0] + vec.y*mat._m[3] + vec.z*mat._m[6],
+		vec.x*mat._m[1] + vec.y*mat._m[4] + vec.z*mat._m[7],
+		vec.x*mat._m[2] + vec.y*mat._m[5] + vec.z*mat._m[8]
+	);
+}
+
+template <typename Real>
+std::ostream& operator<< (std::ostream& outStream, const Matrix3<Real>& mat)
+{
+	for (size_t i = 0; i < 3; ++i)
+	{
+		for (size_t j = 0; j < 3; ++j)
+		{
+			outStream << mat.m[i][j] << " ";
+		}
+		outStream << "\n";
+	}
+	return outStream;
+}
+
+typedef Matrix3<float> Matrix3f;
+
+#endif
@@ -4,6 +4,7 @@
 #include "Core.h"
 #include "Math/Math.h"
 #include "Math/Vector3.h"
+#include "Math/SIMD.h"
 
 template <typename Real>
 class Matrix4
@@ -25,11 +26,8 @@ public:
 	// Default
 	Matrix4 ();
 
-	// Copy constructor.
-	Matrix4 (const Matrix4& mat);
-
 	// Input mrc is in row r, column c.
-	Matrix4 (
+	constexpr Matrix4 (
 		Real m00, Real m01, Real m02, Real m03,
 		Real m10, Real m11, Real m12, Real m13,
 		Real m20, Real m21, Real m22, Real m23,
@@ -43,15 +41,12 @@ public:
 	//						m32,m03,m13,m23,m33} [col major]
 	Matrix4 (const Real mat[16], bool rowMajor);
 
-	// Assignment.
-	Matrix4& operator= (const Matrix4& mat);
-
 	// Arithmetic operations.
-	inline Matrix4 operator+ (const Matrix4& mat) const;
-	inline Matrix4 operator- (const Matrix4& mat) const;
-	inline Matrix4 operator* (Real scalar) const;
+	constexpr Matrix4 operator+ (const Matrix4& mat) const;
+	constexpr Matrix4 operator- (const Matrix4& mat) const;
+	constexpr Matrix4 operator* (Real scalar) const;
 	inline Matrix4 operator/ (Real scalar) const;
-	inline Matrix4 operator- () const;
+	constexpr Matrix4 operator- () const;
 
 	// Arithmetic updates.
 	inline Matrix4& operator+= (const Matrix4& mat);
@@ -82,6 +77,17 @@ public:
 	Matrix4 Adjoint () const;
 	Real Determinant () const;
 
+	// M*vec for a 4-tuple vec.
+	void Transform (const Real vec[4], Real out[4]) const;
+
+	// M*(vec,1) and M*(vec,0), without the w component.
+	Vector3<Real> TransformPoint (const Vector3<Real>& vec) const;
+	Vector3<Real> TransformVector (const Vector3<Real>& vec) const;
+
+	// TransformPoint for every input, in and out may be the same array.
+	void TransformPoints (int numVectors, const Vector3<Real>* in,
+		Vector3<Real>* out) const;
+
 	static Matrix4 CreatePerspective (
 		Real const & fovy, Real const & aspect,
 		Real const & zNear, Real const & zFar);
@@ -89,9 +95,12 @@ public:
 	static Matrix4 CreateLookAt (const Vector3<Real>& eye,
 		const Vector3<Real>& center, const Vector3<Real>& up);
 
-	static Matrix4 CreateOrthographic (
-		Real const & left, Real const & right, Real const & top, Real const & bottom,
-		Real const & near, Real const & far);
+	static constexpr Matrix4 CreateOrthographic (
+		Real const & left, Real const & right, Real const & bottom, Real const & top,
+		Real const & zNear, Real const & zFar);
+
+	static constexpr Matrix4 CreateTranslation (Real x, Real y, Real z);
+	static constexpr Matrix4 CreateScale (Real x, Real y, Real z);
 
 	// Special matrices.
 	static const Matrix4 ZERO;
@@ -101,7 +110,7 @@ public:
 
 // c * M
 template <typename Real>
-inline Matrix4<Real> operator* (Real scalar, const Matrix4<Real>& mat);
+constexpr Matrix4<Real> operator* (Real scalar, const Matrix4<Real>& mat);
 
 template <typename Real>
 std::ostream& operator<< (std::ostream& outStream, const Matrix4<Real>& mat);
@@ -114,33 +123,37 @@ Matrix4<Real>::Matrix4 ()
 }
 
 template <typename Real>
-Matrix4<Real>::Matrix4 (const Matrix4& mat)
+constexpr Matrix4<Real>::Matrix4 (Real m00, Real m01, Real m02, Real m03,
+	Real m10, Real m11, Real m12, Real m13, Real m20, Real m21, Real m22,
+	Real m23, Real m30, Real m31, Real m32, Real m33)
+	: _m{
+		m00, m01, m02, m03,
+		m10, m11, m12, m13,
+		m20, m21, m22, m23,
+		m30, m31, m32, m33}
 {
-	memcpy(_m,mat._m,sizeof(_m));
 }
 
-template <typename Real>
-Matrix4<Real>::Matrix4 (Real m00, Real m01, Real m02, Real m03, Real m10,
-	Real m11, Real m12, Real m13, Real m20, Real m21, Real m22, Real m23,
-	Real m30, Real m31, Real m32, Real m33)
-{
-	_m[ 0] = m00;
-	_m[ 1] = m01;
-	_m[ 2] = m02;
-	_m[ 3] = m03;
-	_m[ 4] = m10;
-	_m[ 5] = m11;
-	_m[ 6] = m12;
-	_m[ 7] = m13;
-	_m[ 8] = m20;
-	_m[ 9] = m21;
-	_m[10] = m22;
-	_m[11] = m23;
-	_m[12] = m30;
-	_m[13] = m31;
-	_m[14] = m32;
-	_m[15] = m33;
-}
+template <typename Real> constexpr Matrix4<Real> Matrix4<Real>::ZERO(
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0
+);
+
+template <typename Real> constexpr Matrix4<Real> Matrix4<Real>::IDENTITY(
+	1, 0, 0, 0,
+	0, 1, 0, 0,
+	0, 0, 1, 0,
+	0, 0, 0, 1
+);
+
+template <typename Real> constexpr Matrix4<Real> Matrix4<Real>::ZEROAFFINE(
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 1
+);
 
 template <typename Real>
 Matrix4<Real>::Matrix4 (const Real mat[16], bool rowMajor)
@@ -170,15 +183,8 @@ Matrix4<Real>::Matrix4 (const Real mat[16], bool rowMajor)
 	}
 }
 
-template <typename Real>
-Matrix4<Real>& Matrix4<Real>::operator= (const Matrix4& mat)
-{
-	memcpy(_m,mat._m,sizeof(_m));
-	return *this;
-}
-
 template <class Real>
-inline Matrix4<Real> Matrix4<Real>::operator+ (const Matrix4& mat) const
+constexpr Matrix4<Real> Matrix4<Real>::operator+ (const Matrix4& mat) const
 {
 	return Matrix4<Real>
 	(
@@ -202,7 +208,7 @@ inline Matrix4<Real> Matrix4<Real>::operator+ (const Matrix4& mat) const
 }
 
 template <class Real>
-inline Matrix4<Real> Matrix4<Real>::operator- (const Matrix4& mat) const
+constexpr Matrix4<Real> Matrix4<Real>::operator- (const Matrix4& mat) const
 {
 	return Matrix4<Real>
 	(
@@ -226,7 +232,7 @@ inline Matrix4<Real> Matrix4<Real>::operator- (const Matrix4& mat) const
 }
 
 template <class Real>
-inline Matrix4<Real> Matrix4<Real>::operator* (Real scalar) const
+constexpr Matrix4<Real> Matrix4<Real>::operator* (Real scalar) const
 {
 	return Matrix4<Real>
 	(
@@ -300,7 +306,7 @@ inline Matrix4<Real> Matrix4<Real>::operator/ (Real scalar) const
 }
 
 template <class Real>
-inline Matrix4<Real> Matrix4<Real>::operator- () const
+constexpr Matrix4<Real> Matrix4<Real>::operator- () const
 {
 	return Matrix4<Real>
 	(
@@ -943,6 +949,48 @@ Real Matrix4<Real>::Determinant () const
 	return det;
 }
 
+template <typename Real>
+void Matrix4<Real>::Transform (const Real vec[4], Real out[4]) const
+{
+	Real x = vec[0], y = vec[1], z = vec[2], w = vec[3];
+	out[0] = _m[ 0]*x + _m[ 1]*y + _m[ 2]*z + _m[ 3]*w;
+	out[1] = _m[ 4]*x + _m[ 5]*y + _m[ 6]*z + _m[ 7]*w;
+	out[2] = _m[ 8]*x + _m[ 9]*y + _m[10]*z + _m[11]*w;
+	out[3] = _m[12]*x + _m[13]*y + _m[14]*z + _m[15]*w;
+}
+
+template <typename Real>
+Vector3<Real> Matrix4<Real>::TransformPoint (const Vector3<Real>& vec) const
+{
+	return Vector3<Real>
+	(
+		_m[ 0]*vec.x + _m[ 1]*vec.y + _m[ 2]*vec.z + _m[ 3],
+		_m[ 4]*vec.x + _m[ 5]*vec.y + _m[ 6]*vec.z + _m[ 7],
+		_m[ 8]*vec.x + _m[ 9]*vec.y + _m[10]*vec.z + _m[11]
+	);
+}
+
+template <typename Real>
+Vector3<Real> Matrix4<Real>::TransformVector (const Vector3<Real>& vec) const
+{
+	return Vector3<Real>
+	(
+		_m[ 0]*vec.x + _m[ 1]*vec.y + _m[ 2]*vec.z,
+		_m[ 4]*vec.x + _m[ 5]*vec.y + _m[ 6]*vec.z,
+		_m[ 8]*vec.x + _m[ 9]*vec.y + _m[10]*vec.z
+	);
+}
+
+template <typename Real>
+void Matrix4<Real>::TransformPoints (int numVectors, const Vector3<Real>* in,
+	Vector3<Real>* out) const
+{
+	for (int i = 0; i < numVectors; ++i)
+	{
+		out[i] = TransformPoint(in[i]);
+	}
+}
+
 template <typename Real>
 Matrix4<Real> Matrix4<Real>::CreatePerspective (
 	Real const & fovy, Real const & aspect,
@@ -964,18 +1012,42 @@ Matrix4<Real> Matrix4<Real>::CreatePerspective (
 }
 
 template <typename Real>
-Matrix4<Real> Matrix4<Real>::CreateOrthographic (
+constexpr Matrix4<Real> Matrix4<Real>::CreateOrthographic (
 	Real const & left, Real const & right, Real const & bottom, Real const & top,
 	Real const & zNear, Real const & zFar)
 {
-	Matrix4<Real> mat = IDENTITY;
-	mat[0][0] = Real(2) / (right - left);
-	mat[1][1] = Real(2) / (top - bottom);
-	mat[2][2] = - Real(2) / (zFar - zNear);
-	mat[0][3] = - (right + left) / (right - left);
-	mat[1][3] = - (top + bottom) / (top - bottom);
-	mat[2][3] = - (zFar + zNear) / (zFar - zNear);
-	return mat;
+	return Matrix4<Real>
+	(
+		Real(2) / (right - left), 0, 0, - (right + left) / (right - left),
+		0, Real(2) / (top - bottom), 0, - (top + bottom) / (top - bottom),
+		0, 0, - Real(2) / (zFar - zNear), - (zFar + zNear) / (zFar - zNear),
+		0, 0, 0, 1
+	);
+}
+
+template <typename Real>
+constexpr Matrix4<Real> Matrix4<Real>::CreateTranslation (Real x, Real y,
+	Real z)
+{
+	return Matrix4<Real>
+	(
+		1, 0, 0, x,
+		0, 1, 0, y,
+		0, 0, 1, z,
+		0, 0, 0, 1
+	);
+}
+
+template <typename Real>
+constexpr Matrix4<Real> Matrix4<Real>::CreateScale (Real x, Real y, Real z)
+{
+	return Matrix4<Real>
+	(
+		x, 0, 0, 0,
+		0, y, 0, 0,
+		0, 0, z, 0,
+		0, 0, 0, 1
+	);
 }
 
 template <typename Real>
@@ -1004,7 +1076,7 @@ Matrix4<Real> Matrix4<Real>::CreateLookAt (const Vector3<Real>& eye,
 }
 
 template <typename Real>
-inline Matrix4<Real> operator* (Real scalar, const Matrix4<Real>& mat)
+constexpr Matrix4<Real> operator* (Real scalar, const Matrix4<Real>& mat)
 {
 	return mat*scalar;
 }
@@ -1023,6 +1095,219 @@ std::ostream& operator<< (std::ostream& outStream, const Matrix4<Real>& mat)
 	return outStream;
 }
 
+#if Z_SIMD
+
+// Matrix4<float> on four float lanes, one row per register.  Products and
+// transforms add up the same terms in the same order as the generic code
+// and give identical results.  Inverse uses the 2x2 block method on SSE,
+// which rounds differently but agrees to within float epsilon; NEON keeps
+// the generic Inverse.
+
+template <>
+inline Matrix4<float> Matrix4<float>::Transpose () const
+{
+	Float4 r0 = Load4(_m), r1 = Load4(_m+4), r2 = Load4(_m+8), r3 = Load4(_m+12);
+	Transpose4(r0,r1,r2,r3);
+	Matrix4<float> result;
+	Store4(result._m,r0);
+	Store4(result._m+4,r1);
+	Store4(result._m+8,r2);
+	Store4(result._m+12,r3);
+	return result;
+}
+
+// Row i of A*B is the rows of B weighted by row i of A.
+inline Float4 Matrix4RowTimes (Float4 a, Float4 b0, Float4 b1, Float4 b2,
+	Float4 b3)
+{
+	Float4 r = Mul4(Lane4<0>(a),b0);
+	r = MulAdd4(Lane4<1>(a),b1,r);
+	r = MulAdd4(Lane4<2>(a),b2,r);
+	return MulAdd4(Lane4<3>(a),b3,r);
+}
+
+inline void Matrix4Times (const float* a, const float* b, float* out)
+{
+	Float4 b0 = Load4(b), b1 = Load4(b+4), b2 = Load4(b+8), b3 = Load4(b+12);
+	Float4 r0 = Matrix4RowTimes(Load4(a),b0,b1,b2,b3);
+	Float4 r1 = Matrix4RowTimes(Load4(a+4),b0,b1,b2,b3);
+	Float4 r2 = Matrix4RowTimes(Load4(a+8),b0,b1,b2,b3);
+	Float4 r3 = Matrix4RowTimes(Load4(a+12),b0,b1,b2,b3);
+	Store4(out,r0);
+	Store4(out+4,r1);
+	Store4(out+8,r2);
+	Store4(out+12,r3);
+}
+
+template <>
+inline Matrix4<float> Matrix4<float>::operator* (const Matrix4& mat) const
+{
+	Matrix4<float> result;
+	Matrix4Times(_m,mat._m,result._m);
+	return result;
+}
+
+template <>
+inline Matrix4<float> Matrix4<float>::TransposeTimes (const Matrix4& mat) const
+{
+	Matrix4<float> result;
+	Matrix4Times(Transpose()._m,mat._m,result._m);
+	return result;
+}
+
+template <>
+inline Matrix4<float> Matrix4<float>::TimesTranspose (const Matrix4& mat) const
+{
+	Matrix4<float> result;
+	Matrix4Times(_m,mat.Transpose()._m,result._m);
+	return result;
+}
+
+template <>
+inline Matrix4<float> Matrix4<float>::TransposeTimesTranspose (
+	const Matrix4& mat) const
+{
+	// A^T*B^T = (B*A)^T
+	return (mat*(*this)).Transpose();
+}
+
+template <>
+inline void Matrix4<float>::Transform (const float vec[4], float out[4]) const
+{
+	Float4 c0 = Load4(_m), c1 = Load4(_m+4), c2 = Load4(_m+8), c3 = Load4(_m+12);
+	Transpose4(c0,c1,c2,c3);
+	Float4 r = Mul4(c0,Splat4(vec[0]));
+	r = MulAdd4(c1,Splat4(vec[1]),r);
+	r = MulAdd4(c2,Splat4(vec[2]),r);
+	Store4(out,MulAdd4(c3,Splat4(vec[3]),r));
+}
+
+template <>
+inline void Matrix4<float>::TransformPoints (int numVectors,
+	const Vector3<float>* in, Vector3<float>* out) const
+{
+	Float4 c0 = Load4(_m), c1 = Load4(_m+4), c2 = Load4(_m+8), c3 = Load4(_m+12);
+	Transpose4(c0,c1,c2,c3);
+	float r[4];
+	for (int i = 0; i < numVectors; ++i)
+	{
+		Float4 p = Mul4(c0,Splat4(in[i].x));
+		p = MulAdd4(c1,Splat4(in[i].y),p);
+		p = MulAdd4(c2,Splat4(in[i].z),p);
+		Store4(r,Add4(p,c3));
+		out[i].x = r[0];
+		out[i].y = r[1];
+		out[i].z = r[2];
+	}
+}
+
+template <>
+inline Vector3<float> Matrix4<float>::TransformPoint (
+	const Vector3<float>& vec) const
+{
+	Vector3<float> result;
+	TransformPoints(1,&vec,&result);
+	return result;
+}
+
+template <>
+inline Vector3<float> Matrix4<float>::TransformVector (
+	const Vector3<float>& vec) const
+{
+	float in[4] = {vec.x,vec.y,vec.z,0};
+	float out[4];
+	Transform(in,out);
+	return Vector3<float>(out[0],out[1],out[2]);
+}
+
+#if Z_SIMD_SSE
+
+// Lanes x,y,z,w picked from a (first two) and b (last two).
+#define Z_SHUFFLE4(a,b,x,y,z,w) _mm_shuffle_ps(a,b,_MM_SHUFFLE(w,z,y,x))
+
+// A 2x2 matrix in one register, row major: | a0 a1 |
+//                                          | a2 a3 |
+
+// A*B
+inline __m128 Matrix2Times (__m128 a, __m128 b)
+{
+	return _mm_add_ps(_mm_mul_ps(a,Z_SHUFFLE4(b,b,0,3,0,3)),
+		_mm_mul_ps(Z_SHUFFLE4(a,a,1,0,3,2),Z_SHUFFLE4(b,b,2,1,2,1)));
+}
+
+// adj(A)*B
+inline __m128 Matrix2AdjointTimes (__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(Z_SHUFFLE4(a,a,3,3,0,0),b),
+		_mm_mul_ps(Z_SHUFFLE4(a,a,1,1,2,2),Z_SHUFFLE4(b,b,2,3,0,1)));
+}
+
+// A*adj(B)
+inline __m128 Matrix2TimesAdjoint (__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(a,Z_SHUFFLE4(b,b,3,0,3,0)),
+		_mm_mul_ps(Z_SHUFFLE4(a,a,1,0,3,2),Z_SHUFFLE4(b,b,2,1,2,1)));
+}
+
+template <>
+inline Matrix4<float> Matrix4<float>::Inverse (const float epsilon) const
+{
+	// M = | A B |  with 2x2 blocks, M^-1 = 1/det(M) * | X Y |
+	//     | C D |                                     | Z W |
+	__m128 r0 = Load4(_m), r1 = Load4(_m+4), r2 = Load4(_m+8), r3 = Load4(_m+12);
+	__m128 A = _mm_movelh_ps(r0,r1);
+	__m128 B = _mm_movehl_ps(r1,r0);
+	__m128 C = _mm_movelh_ps(r2,r3);
+	__m128 D = _mm_movehl_ps(r3,r2);
+
+	// det(A), det(B), det(C), det(D)
+	__m128 dets = _mm_sub_ps(
+		_mm_mul_ps(Z_SHUFFLE4(r0,r2,0,2,0,2),Z_SHUFFLE4(r1,r3,1,3,1,3)),
+		_mm_mul_ps(Z_SHUFFLE4(r0,r2,1,3,1,3),Z_SHUFFLE4(r1,r3,0,2,0,2)));
+	__m128 detA = Lane4<0>(dets);
+	__m128 detB = Lane4<1>(dets);
+	__m128 detC = Lane4<2>(dets);
+	__m128 detD = Lane4<3>(dets);
+
+	__m128 DC = Matrix2AdjointTimes(D,C);
+	__m128 AB = Matrix2AdjointTimes(A,B);
+	__m128 X = _mm_sub_ps(_mm_mul_ps(detD,A),Matrix2Times(B,DC));
+	__m128 W = _mm_sub_ps(_mm_mul_ps(detA,D),Matrix2Times(C,AB));
+	__m128 Y = _mm_sub_ps(_mm_mul_ps(detB,C),Matrix2TimesAdjoint(D,AB));
+	__m128 Z = _mm_sub_ps(_mm_mul_ps(detC,B),Matrix2TimesAdjoint(A,DC));
+
+	// det(M) = det(A)det(D) + det(B)det(C) - tr(adj(A)B adj(D)C)
+	__m128 tr = _mm_mul_ps(AB,Z_SHUFFLE4(DC,DC,0,2,1,3));
+	tr = _mm_add_ps(tr,Z_SHUFFLE4(tr,tr,2,3,0,1));
+	tr = _mm_add_ps(tr,Z_SHUFFLE4(tr,tr,1,0,3,2));
+	__m128 det = _mm_sub_ps(
+		_mm_add_ps(_mm_mul_ps(detA,detD),_mm_mul_ps(detB,detC)),tr);
+	if (!(Math<float>::FAbs(_mm_cvtss_f32(det)) > epsilon))
+	{
+		return ZERO;
+	}
+
+	// The blocks above are adjugates, the store shuffles undo that.
+	__m128 invDet = _mm_div_ps(_mm_setr_ps(1,-1,-1,1),det);
+	X = _mm_mul_ps(X,invDet);
+	Y = _mm_mul_ps(Y,invDet);
+	Z = _mm_mul_ps(Z,invDet);
+	W = _mm_mul_ps(W,invDet);
+
+	Matrix4<float> inverse;
+	Store4(inverse._m,Z_SHUFFLE4(X,Y,3,1,3,1));
+	Store4(inverse._m+4,Z_SHUFFLE4(X,Y,2,0,2,0));
+	Store4(inverse._m+8,Z_SHUFFLE4(Z,W,3,1,3,1));
+	Store4(inverse._m+12,Z_SHUFFLE4(Z,W,2,0,2,0));
+	return inverse;
+}
+
+#undef Z_SHUFFLE4
+
+#endif
+
+#endif
+
 typedef Matrix4<float> Matrix4f;
 
 #endif
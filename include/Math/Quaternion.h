@@ -1,336 +1,605 @@
-#ifndef _QUATERNION_H_
-#define _QUATERNION_H_
-
-#include "CommonInc.h"
-
-/*
------------------------------------------------------------------------------
-This source file is part of OGRE
-    (Object-oriented Graphics Rendering Engine)
-For the latest info, see http://www.ogre3d.org/
-
-Copyright (c) 2000-2013 Torus Knot Software Ltd
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in
-all copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
-THE SOFTWARE.
------------------------------------------------------------------------------
-*/
-// This file is based on material originally from:
-// Geometric Tools, LLC
-// Copyright (c) 1998-2010
-// Distributed under the Boost Software License, Version 1.0.
-// http://www.boost.org/LICENSE_1_0.txt
-// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-
-
-#ifndef __Quaternion_H__
-#define __Quaternion_H__
-
-#include "OgrePrerequisites.h"
-#include "OgreMath.h"
-
-namespace Ogre {
-
-	/** \addtogroup Core
-	*  @{
-	*/
-	/** \addtogroup Math
-	*  @{
-	*/
-	/** Implementation of a Quaternion, i.e. a rotation around an axis.
-		For more information about Quaternions and the theory behind it, we recommend reading:
-		http://www.ogre3d.org/tikiwiki/Quaternion+and+Rotation+Primer
-		http://www.cprogramming.com/tutorial/3d/quaternions.html
-		http://www.gamedev.net/page/resources/_/reference/programming/math-and-physics/
-		quaternions/quaternion-powers-r1095
-    */
-    class _OgreExport Quaternion
-    {
-    public:
-		/// Default constructor, initializes to identity rotation (aka 0°)
-		inline Quaternion ()
-			: w(1), x(0), y(0), z(0)
+#ifndef Z_QUATERNION_H_
+#define Z_QUATERNION_H_
+
+#include "Core.h"
+#include "Math/Math.h"
+#include "Math/FastMath.h"
+#include "Math/Vector3.h"
+#include "Math/Matrix3.h"
+#include "Math/Matrix4.h"
+#include "Math/SIMD.h"
+
+// Precision of the acos and sin in Slerp, see FastMath.h.
+#ifndef Z_SLERP_PRECISION
+#define Z_SLERP_PRECISION MATH_EXACT
+#endif
+
+// q = w + x*i + y*j + z*k.  Unit quaternions are rotations, q and -q the
+// same one, and p*q rotates by q first and then by p.
+
+template <typename Real>
+class Quaternion
+{
+public:
+	union
+	{
+		struct
 		{
-		}
-		/// Construct from an explicit list of values
-		inline Quaternion (
-			Real fW,
-			Real fX, Real fY, Real fZ)
-			: w(fW), x(fX), y(fY), z(fZ)
+			Real w, x, y, z;
+		};
+		Real _q[4];
+	};
+
+	// Default, uninitialized.
+	Quaternion ();
+
+	constexpr Quaternion (Real w, Real x, Real y, Real z);
+
+	// Rotation of angle radians about a unit-length axis.
+	Quaternion (const Vector3<Real>& axis, Real angle);
+
+	// The rotation matrix rot, which must be orthonormal.
+	explicit Quaternion (const Matrix3<Real>& rot);
+
+	// Arithmetic operations.
+	constexpr Quaternion operator+ (const Quaternion& quat) const;
+	constexpr Quaternion operator- (const Quaternion& quat) const;
+	constexpr Quaternion operator* (const Quaternion& quat) const;
+	constexpr Quaternion operator* (Real scalar) const;
+	constexpr Quaternion operator- () const;
+
+	// Rotate a vector, the same as ToRotationMatrix()*vec.
+	Vector3<Real> operator* (const Vector3<Real>& vec) const;
+
+	// Conversions.
+	void FromRotationMatrix (const Matrix3<Real>& rot);
+	void ToRotationMatrix (Matrix3<Real>& rot) const;
+	Matrix4<Real> ToMatrix4 (
+		const Vector3<Real>& translation = Vector3<Real>::ZERO) const;
+	void FromAxisAngle (const Vector3<Real>& axis, Real angle);
+	void ToAxisAngle (Vector3<Real>& axis, Real& angle) const;
+
+	// Other operations.
+	constexpr Real Dot (const Quaternion& quat) const;
+	inline Real Length () const;
+	constexpr Real SquaredLength () const;
+	inline Real Normalize (const Real epsilon = Math<Real>::EPSILON);
+	constexpr Quaternion Conjugate () const;
+	Quaternion Inverse () const;
+
+	// Interpolation between unit quaternions along the shorter arc, t in
+	// [0,1].  Slerp moves at constant angular speed.  Nlerp normalizes the
+	// straight line between them, which is cheaper and close for nearby
+	// keys but speeds up in the middle of wide arcs.
+	static Quaternion Slerp (Real t, const Quaternion& p, const Quaternion& q);
+	static Quaternion Nlerp (Real t, const Quaternion& p, const Quaternion& q);
+
+	// Batched versions for many keyframe pairs, out[i] between p[i] and q[i]
+	// at t[i].  out may be either input.  This Slerp evaluates sin(t*a)/sin(a)
+	// with a polynomial instead of acos and sin.  It is off from the exact
+	// one by up to 2e-5 when p and q are nearly 180 degrees of rotation
+	// apart and by less than 1e-8 for keys within 80 degrees.  The float versions do
+	// four pairs at a time and match the generic ones exactly.
+	static void Slerp (int numQuaternions, const Real* t,
+		const Quaternion* p, const Quaternion* q, Quaternion* out);
+	static void Nlerp (int numQuaternions, const Real* t,
+		const Quaternion* p, const Quaternion* q, Quaternion* out);
+
+	// Special quaternions.
+	static const Quaternion ZERO;
+	static const Quaternion IDENTITY;
+
+private:
+	// Coefficients of the slerp polynomial.
+	static const Real msU[8];
+	static const Real msV[8];
+
+	// sin(t*a)/sin(a) for cos(a) = cs in [0,1].
+	static Real SlerpWeight (Real t, Real cs);
+};
+
+// c * q
+template <typename Real>
+constexpr Quaternion<Real> operator* (Real scalar, const Quaternion<Real>& quat);
+
+template <typename Real>
+std::ostream& operator<< (std::ostream& outStream, const Quaternion<Real>& quat);
+
+// implementations
+
+template <typename Real>
+Quaternion<Real>::Quaternion ()
+{
+}
+
+template <typename Real>
+constexpr Quaternion<Real>::Quaternion (Real w, Real x, Real y, Real z)
+	: w(w), x(x), y(y), z(z)
+{
+}
+
+template <typename Real>
+constexpr Quaternion<Real> Quaternion<Real>::ZERO(0,0,0,0);
+template <typename Real>
+constexpr Quaternion<Real> Quaternion<Real>::IDENTITY(1,0,0,0);
+
+// u[i] = 1/(i*(2i+1)), v[i] = i/(2i+1) for i = 1..8, the last pair scaled
+// by 1.85298109240830 to make up for the terms cut off.  See Eberly, "A
+// Fast and Accurate Algorithm for Computing SLERP".
+template <typename Real>
+const Real Quaternion<Real>::msU[8] =
+{
+	(Real)(1.0/(1*3)), (Real)(1.0/(2*5)), (Real)(1.0/(3*7)),
+	(Real)(1.0/(4*9)), (Real)(1.0/(5*11)), (Real)(1.0/(6*13)),
+	(Real)(1.0/(7*15)), (Real)(1.85298109240830/(8*17))
+};
+
+template <typename Real>
+const Real Quaternion<Real>::msV[8] =
+{
+	(Real)(1.0/3), (Real)(2.0/5), (Real)(3.0/7), (Real)(4.0/9),
+	(Real)(5.0/11), (Real)(6.0/13), (Real)(7.0/15),
+	(Real)(1.85298109240830*8/17)
+};
+
+template <typename Real>
+Quaternion<Real>::Quaternion (const Vector3<Real>& axis, Real angle)
+{
+	FromAxisAngle(axis,angle);
+}
+
+template <typename Real>
+Quaternion<Real>::Quaternion (const Matrix3<Real>& rot)
+{
+	FromRotationMatrix(rot);
+}
+
+template <typename Real>
+constexpr Quaternion<Real> Quaternion<Real>::operator+ (const Quaternion& quat)
+	const
+{
+	return Quaternion(w + quat.w, x + quat.x, y + quat.y, z + quat.z);
+}
+
+template <typename Real>
+constexpr Quaternion<Real> Quaternion<Real>::operator- (const Quaternion& quat)
+	const
+{
+	return Quaternion(w - quat.w, x - quat.x, y - quat.y, z - quat.z);
+}
+
+template <typename Real>
+constexpr Quaternion<Real> Quaternion<Real>::operator* (const Quaternion& quat)
+	const
+{
+	// Not commutative.
+	return Quaternion
+	(
+		w*quat.w - x*quat.x - y*quat.y - z*quat.z,
+		w*quat.x + x*quat.w + y*quat.z - z*quat.y,
+		w*quat.y + y*quat.w + z*quat.x - x*quat.z,
+		w*quat.z + z*quat.w + x*quat.y - y*quat.x
+	);
+}
+
+template <typename Real>
+constexpr Quaternion<Real> Quaternion<Real>::operator* (Real scalar) const
+{
+	return Quaternion(scalar*w, scalar*x, scalar*y, scalar*z);
+}
+
+template <typename Real>
+constexpr Quaternion<Real> Quaternion<Real>::operator- () const
+{
+	return Quaternion(-w, -x, -y, -z);
+}
+
+template <typename Real>
+Vector3<Real> Quaternion<Real>::operator* (const Vector3<Real>& vec) const
+{
+	// v + 2w(u x v) + 2u x (u x v) with u = (x,y,z), which is q*v*q^-1
+	// without building the matrix.
+	Vector3<Real> u(x,y,z);
+	Vector3<Real> uv = u.Cross(vec);
+	Vector3<Real> uuv = u.Cross(uv);
+	return vec + (uv*w + uuv)*(Real)2;
+}
+
+template <typename Real>
+void Quaternion<Real>::FromRotationMatrix (const Matrix3<Real>& rot)
+{
+	// Ken Shoemake's method, from the largest of w, x, y, z so nothing is
+	// divided by a small number.
+	static const int next[3] = { 1, 2, 0 };
+
+	Real trace = rot.m[0][0] + rot.m[1][1] + rot.m[2][2];
+	Real root;
+
+	if (trace > (Real)0)
+	{
+		// |w| > 1/2
+		root = Math<Real>::Sqrt(trace + (Real)1);  // 2w
+		w = ((Real)0.5)*root;
+		root = ((Real)0.5)/root;  // 1/(4w)
+		x = (rot.m[2][1] - rot.m[1][2])*root;
+		y = (rot.m[0][2] - rot.m[2][0])*root;
+		z = (rot.m[1][0] - rot.m[0][1])*root;
+	}
+	else
+	{
+		// |w| <= 1/2
+		int i = 0;
+		if (rot.m[1][1] > rot.m[0][0])
 		{
+			i = 1;
 		}
-        /// Construct a quaternion from a rotation matrix
-        inline Quaternion(const Matrix3& rot)
-        {
-            this->FromRotationMatrix(rot);
-        }
-        /// Construct a quaternion from an angle/axis
-        inline Quaternion(const Radian& rfAngle, const Vector3& rkAxis)
-        {
-            this->FromAngleAxis(rfAngle, rkAxis);
-        }
-        /// Construct a quaternion from 3 orthonormal local axes
-        inline Quaternion(const Vector3& xaxis, const Vector3& yaxis, const Vector3& zaxis)
-        {
-            this->FromAxes(xaxis, yaxis, zaxis);
-        }
-        /// Construct a quaternion from 3 orthonormal local axes
-        inline Quaternion(const Vector3* akAxis)
-        {
-            this->FromAxes(akAxis);
-        }
-		/// Construct a quaternion from 4 manual w/x/y/z values
-		inline Quaternion(Real* valptr)
+		if (rot.m[2][2] > rot.m[i][i])
 		{
-			memcpy(&w, valptr, sizeof(Real)*4);
+			i = 2;
 		}
+		int j = next[i];
+		int k = next[j];
+
+		root = Math<Real>::Sqrt(rot.m[i][i] - rot.m[j][j] - rot.m[k][k] +
+			(Real)1);
+		Real* quat[3] = { &x, &y, &z };
+		*quat[i] = ((Real)0.5)*root;
+		root = ((Real)0.5)/root;
+		w = (rot.m[k][j] - rot.m[j][k])*root;
+		*quat[j] = (rot.m[j][i] + rot.m[i][j])*root;
+		*quat[k] = (rot.m[k][i] + rot.m[i][k])*root;
+	}
+}
 
-		/** Exchange the contents of this quaternion with another. 
-		*/
-		inline void swap(Quaternion& other)
-		{
-			std::swap(w, other.w);
-			std::swap(x, other.x);
-			std::swap(y, other.y);
-			std::swap(z, other.z);
-		}
+template <typename Real>
+void Quaternion<Real>::ToRotationMatrix (Matrix3<Real>& rot) const
+{
+	Real twoX  = ((Real)2)*x;
+	Real twoY  = ((Real)2)*y;
+	Real twoZ  = ((Real)2)*z;
+	Real twoWX = twoX*w;
+	Real twoWY = twoY*w;
+	Real twoWZ = twoZ*w;
+	Real twoXX = twoX*x;
+	Real twoXY = twoY*x;
+	Real twoXZ = twoZ*x;
+	Real twoYY = twoY*y;
+	Real twoYZ = twoZ*y;
+	Real twoZZ = twoZ*z;
+
+	rot.m[0][0] = (Real)1 - (twoYY + twoZZ);
+	rot.m[0][1] = twoXY - twoWZ;
+	rot.m[0][2] = twoXZ + twoWY;
+	rot.m[1][0] = twoXY + twoWZ;
+	rot.m[1][1] = (Real)1 - (twoXX + twoZZ);
+	rot.m[1][2] = twoYZ - twoWX;
+	rot.m[2][0] = twoXZ - twoWY;
+	rot.m[2][1] = twoYZ + twoWX;
+	rot.m[2][2] = (Real)1 - (twoXX + twoYY);
+}
 
-		/// Array accessor operator
-		inline Real operator [] ( const size_t i ) const
-		{
-			assert( i < 4 );
+template <typename Real>
+Matrix4<Real> Quaternion<Real>::ToMatrix4 (const Vector3<Real>& translation)
+	const
+{
+	Matrix3<Real> rot;
+	ToRotationMatrix(rot);
+	return rot.ToMatrix4(translation);
+}
 
-			return *(&w+i);
-		}
+template <typename Real>
+void Quaternion<Real>::FromAxisAngle (const Vector3<Real>& axis, Real angle)
+{
+	// q = cos(A/2) + sin(A/2)*(x*i+y*j+z*k)
+	Real halfAngle = ((Real)0.5)*angle;
+	Real sn = Math<Real>::Sin(halfAngle);
+	w = Math<Real>::Cos(halfAngle);
+	x = sn*axis.x;
+	y = sn*axis.y;
+	z = sn*axis.z;
+}
 
-		/// Array accessor operator
-		inline Real& operator [] ( const size_t i )
-		{
-			assert( i < 4 );
+template <typename Real>
+void Quaternion<Real>::ToAxisAngle (Vector3<Real>& axis, Real& angle) const
+{
+	Real sqrLength = x*x + y*y + z*z;
+
+	if (sqrLength > Math<Real>::EPSILON)
+	{
+		angle = ((Real)2)*Math<Real>::ACos(w);
+		Real invLength = Math<Real>::InvSqrt(sqrLength);
+		axis.x = x*invLength;
+		axis.y = y*invLength;
+		axis.z = z*invLength;
+	}
+	else
+	{
+		// Angle is 0 (mod 2*pi), so any axis will do.
+		angle = (Real)0;
+		axis = Vector3<Real>::UNIT_X;
+	}
+}
 
-			return *(&w+i);
-		}
+template <typename Real>
+constexpr Real Quaternion<Real>::Dot (const Quaternion& quat) const
+{
+	return w*quat.w + x*quat.x + y*quat.y + z*quat.z;
+}
 
-		/// Pointer accessor for direct copying
-		inline Real* ptr()
-		{
-			return &w;
-		}
+template <typename Real>
+inline Real Quaternion<Real>::Length () const
+{
+	return Math<Real>::Sqrt(w*w + x*x + y*y + z*z);
+}
 
-		/// Pointer accessor for direct copying
-		inline const Real* ptr() const
-		{
-			return &w;
-		}
+template <typename Real>
+constexpr Real Quaternion<Real>::SquaredLength () const
+{
+	return w*w + x*x + y*y + z*z;
+}
 
-		void FromRotationMatrix (const Matrix3& kRot);
-        void ToRotationMatrix (Matrix3& kRot) const;
-		/** Setups the quaternion using the supplied vector, and "roll" around
-			that vector by the specified radians.
-		*/
-        void FromAngleAxis (const Radian& rfAngle, const Vector3& rkAxis);
-        void ToAngleAxis (Radian& rfAngle, Vector3& rkAxis) const;
-        inline void ToAngleAxis (Degree& dAngle, Vector3& rkAxis) const {
-            Radian rAngle;
-            ToAngleAxis ( rAngle, rkAxis );
-            dAngle = rAngle;
-        }
-		/** Constructs the quaternion using 3 axes, the axes are assumed to be orthonormal
-			@see FromAxes
-		*/
-        void FromAxes (const Vector3* akAxis);
-        void FromAxes (const Vector3& xAxis, const Vector3& yAxis, const Vector3& zAxis);
-		/** Gets the 3 orthonormal axes defining the quaternion. @see FromAxes */
-        void ToAxes (Vector3* akAxis) const;
-        void ToAxes (Vector3& xAxis, Vector3& yAxis, Vector3& zAxis) const;
-
-		/** Returns the X orthonormal axis defining the quaternion. Same as doing
-			xAxis = Vector3::UNIT_X * this. Also called the local X-axis
-		*/
-        Vector3 xAxis(void) const;
-
-        /** Returns the Y orthonormal axis defining the quaternion. Same as doing
-			yAxis = Vector3::UNIT_Y * this. Also called the local Y-axis
-		*/
-        Vector3 yAxis(void) const;
-
-		/** Returns the Z orthonormal axis defining the quaternion. Same as doing
-			zAxis = Vector3::UNIT_Z * this. Also called the local Z-axis
-		*/
-        Vector3 zAxis(void) const;
-
-        inline Quaternion& operator= (const Quaternion& rkQ)
-		{
-			w = rkQ.w;
-			x = rkQ.x;
-			y = rkQ.y;
-			z = rkQ.z;
-			return *this;
-		}
-        Quaternion operator+ (const Quaternion& rkQ) const;
-        Quaternion operator- (const Quaternion& rkQ) const;
-        Quaternion operator* (const Quaternion& rkQ) const;
-        Quaternion operator* (Real fScalar) const;
-        _OgreExport friend Quaternion operator* (Real fScalar,
-            const Quaternion& rkQ);
-        Quaternion operator- () const;
-        inline bool operator== (const Quaternion& rhs) const
+template <typename Real>
+inline Real Quaternion<Real>::Normalize (const Real epsilon)
+{
+	Real length = Length();
+
+	if (length > epsilon)
+	{
+		Real invLength = ((Real)1)/length;
+		w *= invLength;
+		x *= invLength;
+		y *= invLength;
+		z *= invLength;
+	}
+	else
+	{
+		length = (Real)0;
+		w = (Real)0;
+		x = (Real)0;
+		y = (Real)0;
+		z = (Real)0;
+	}
+
+	return length;
+}
+
+template <typename Real>
+constexpr Quaternion<Real> Quaternion<Real>::Conjugate () const
+{
+	return Quaternion(w, -x, -y, -z);
+}
+
+template <typename Real>
+Quaternion<Real> Quaternion<Real>::Inverse () const
+{
+	Real norm = SquaredLength();
+	if (norm > (Real)0)
+	{
+		Real invNorm = ((Real)1)/norm;
+		return Quaternion(w*invNorm, -x*invNorm, -y*invNorm, -z*invNorm);
+	}
+
+	return ZERO;
+}
+
+template <typename Real>
+Quaternion<Real> Quaternion<Real>::Slerp (Real t, const Quaternion& p,
+	const Quaternion& q)
+{
+	Real cs = p.Dot(q);
+	Real sign = (Real)1;
+	if (cs < (Real)0)
+	{
+		cs = -cs;
+		sign = -(Real)1;
+	}
+
+	// cs is in [0,1], so angle and the arguments to Sin are in [0,pi/2].
+	typedef FastMath<Real,Z_SLERP_PRECISION> Trig;
+	Real angle = Trig::ACos(cs);
+	if (Math<Real>::FAbs(angle) >= Math<Real>::EPSILON)
+	{
+		Real invSin = ((Real)1)/Trig::Sin(angle);
+		Real coeff0 = Trig::Sin((((Real)1) - t)*angle)*invSin;
+		Real coeff1 = sign*Trig::Sin(t*angle)*invSin;
+		return p*coeff0 + q*coeff1;
+	}
+
+	// Too close for sin(angle) to divide by, the arc is a straight line.
+	return p*(((Real)1) - t) + q*(sign*t);
+}
+
+template <typename Real>
+Quaternion<Real> Quaternion<Real>::Nlerp (Real t, const Quaternion& p,
+	const Quaternion& q)
+{
+	Real coeff1 = (p.Dot(q) < (Real)0 ? -t : t);
+	Quaternion result = p*(((Real)1) - t) + q*coeff1;
+	result.Normalize();
+	return result;
+}
+
+template <typename Real>
+Real Quaternion<Real>::SlerpWeight (Real t, Real cs)
+{
+	// sin(t*a)/sin(a) = sum of b[i]*(cs-1)^i, with b[0] = t and
+	// b[i] = b[i-1]*(u[i]*t^2 - v[i]), evaluated from the inside out.
+	Real csm1 = cs - (Real)1;
+	Real sqrT = t*t;
+	Real f = (Real)1;
+	for (int i = 7; i >= 0; --i)
+	{
+		f = (Real)1 + (msU[i]*sqrT - msV[i])*csm1*f;
+	}
+	return t*f;
+}
+
+template <typename Real>
+void Quaternion<Real>::Slerp (int numQuaternions, const Real* t,
+	const Quaternion* p, const Quaternion* q, Quaternion* out)
+{
+	for (int i = 0; i < numQuaternions; ++i)
+	{
+		Real cs = p[i].Dot(q[i]);
+		Real sign = (Real)1;
+		if (cs < (Real)0)
 		{
-			return (rhs.x == x) && (rhs.y == y) &&
-				(rhs.z == z) && (rhs.w == w);
+			cs = -cs;
+			sign = -(Real)1;
 		}
-        inline bool operator!= (const Quaternion& rhs) const
+		Real coeff0 = SlerpWeight(((Real)1) - t[i],cs);
+		Real coeff1 = sign*SlerpWeight(t[i],cs);
+		out[i] = p[i]*coeff0 + q[i]*coeff1;
+	}
+}
+
+template <typename Real>
+void Quaternion<Real>::Nlerp (int numQuaternions, const Real* t,
+	const Quaternion* p, const Quaternion* q, Quaternion* out)
+{
+	for (int i = 0; i < numQuaternions; ++i)
+	{
+		out[i] = Nlerp(t[i],p[i],q[i]);
+	}
+}
+
+#if Z_SIMD
+
+// Four keyframe pairs at a time, transposed so each register holds one
+// component of four quaternions.  Same operations as the generic code.
+
+template <>
+inline void Quaternion<float>::Slerp (int numQuaternions, const float* t,
+	const Quaternion* p, const Quaternion* q, Quaternion* out)
+{
+	Float4 zero = Splat4(0.0f);
+	Float4 one = Splat4(1.0f);
+	Float4 signBit = Splat4(-0.0f);
+	Float4 u[8], v[8];
+	for (int k = 0; k < 8; ++k)
+	{
+		u[k] = Splat4(msU[k]);
+		v[k] = Splat4(msV[k]);
+	}
+
+	int i = 0;
+	for (; i + 4 <= numQuaternions; i += 4)
+	{
+		Float4 p0 = Load4(p[i]._q), p1 = Load4(p[i+1]._q),
+			p2 = Load4(p[i+2]._q), p3 = Load4(p[i+3]._q);
+		Float4 q0 = Load4(q[i]._q), q1 = Load4(q[i+1]._q),
+			q2 = Load4(q[i+2]._q), q3 = Load4(q[i+3]._q);
+		Transpose4(p0,p1,p2,p3);
+		Transpose4(q0,q1,q2,q3);
+
+		Float4 cs = MulAdd4(p3,q3,MulAdd4(p2,q2,MulAdd4(p1,q1,Mul4(p0,q0))));
+		// Flip to the shorter arc, carrying the sign over to coeff1.
+		Float4 sign = And4(Greater4(zero,cs),signBit);
+		cs = Xor4(cs,sign);
+
+		Float4 csm1 = Sub4(cs,one);
+		Float4 t1 = Load4(t + i);
+		Float4 t0 = Sub4(one,t1);
+		Float4 sqr0 = Mul4(t0,t0), sqr1 = Mul4(t1,t1);
+		Float4 f0 = one, f1 = one;
+		for (int k = 7; k >= 0; --k)
 		{
-			return !operator==(rhs);
+			f0 = Add4(one,Mul4(Mul4(Sub4(Mul4(u[k],sqr0),v[k]),csm1),f0));
+			f1 = Add4(one,Mul4(Mul4(Sub4(Mul4(u[k],sqr1),v[k]),csm1),f1));
 		}
-        // functions of a quaternion
-        /// Returns the dot product of the quaternion
-        Real Dot (const Quaternion& rkQ) const;
-        /* Returns the normal length of this quaternion.
-            @note This does <b>not</b> alter any values.
-        */
-        Real Norm () const;
-        /// Normalises this quaternion, and returns the previous length
-        Real normalise(void); 
-        Quaternion Inverse () const;  // apply to non-zero quaternion
-        Quaternion UnitInverse () const;  // apply to unit-length quaternion
-        Quaternion Exp () const;
-        Quaternion Log () const;
-
-        /// Rotation of a vector by a quaternion
-        Vector3 operator* (const Vector3& rkVector) const;
-
-   		/** Calculate the local roll element of this quaternion.
-		@param reprojectAxis By default the method returns the 'intuitive' result
-			that is, if you projected the local Y of the quaternion onto the X and
-			Y axes, the angle between them is returned. If set to false though, the
-			result is the actual yaw that will be used to implement the quaternion,
-			which is the shortest possible path to get to the same orientation and 
-             may involve less axial rotation.  The co-domain of the returned value is 
-             from -180 to 180 degrees.
-		*/
-		Radian getRoll(bool reprojectAxis = true) const;
-   		/** Calculate the local pitch element of this quaternion
-		@param reprojectAxis By default the method returns the 'intuitive' result
-			that is, if you projected the local Z of the quaternion onto the X and
-			Y axes, the angle between them is returned. If set to true though, the
-			result is the actual yaw that will be used to implement the quaternion,
-			which is the shortest possible path to get to the same orientation and 
-            may involve less axial rotation.  The co-domain of the returned value is 
-            from -180 to 180 degrees.
-		*/
-		Radian getPitch(bool reprojectAxis = true) const;
-   		/** Calculate the local yaw element of this quaternion
-		@param reprojectAxis By default the method returns the 'intuitive' result
-			that is, if you projected the local Y of the quaternion onto the X and
-			Z axes, the angle between them is returned. If set to true though, the
-			result is the actual yaw that will be used to implement the quaternion,
-			which is the shortest possible path to get to the same orientation and 
-			may involve less axial rotation. The co-domain of the returned value is 
-            from -180 to 180 degrees.
-		*/
-		Radian getYaw(bool reprojectAxis = true) const;		
-		/// Equality with tolerance (tolerance is max angle difference)
-		bool equals(const Quaternion& rhs, const Radian& tolerance) const;
-		
-	    /** Performs Spherical linear interpolation between two quaternions, and returns the result.
-			Slerp ( 0.0f, A, B ) = A
-			Slerp ( 1.0f, A, B ) = B
-			@return Interpolated quaternion
-			@remarks
-			Slerp has the proprieties of performing the interpolation at constant
-			velocity, and being torque-minimal (unless shortestPath=false).
-			However, it's NOT commutative, which means
-			Slerp ( 0.75f, A, B ) != Slerp ( 0.25f, B, A );
-			therefore be careful if your code relies in the order of the operands.
-			This is specially important in IK animation.
-		*/
-        static Quaternion Slerp (Real fT, const Quaternion& rkP,
-            const Quaternion& rkQ, bool shortestPath = false);
-
-		/** @see Slerp. It adds extra "spins" (i.e. rotates several times) specified
-			by parameter 'iExtraSpins' while interpolating before arriving to the
-			final values
-		*/
-        static Quaternion SlerpExtraSpins (Real fT,
-            const Quaternion& rkP, const Quaternion& rkQ,
-            int iExtraSpins);
-
-        // setup for spherical quadratic interpolation
-        static void Intermediate (const Quaternion& rkQ0,
-            const Quaternion& rkQ1, const Quaternion& rkQ2,
-            Quaternion& rka, Quaternion& rkB);
-
-        // spherical quadratic interpolation
-        static Quaternion Squad (Real fT, const Quaternion& rkP,
-            const Quaternion& rkA, const Quaternion& rkB,
-            const Quaternion& rkQ, bool shortestPath = false);
-
-        /** Performs Normalised linear interpolation between two quaternions, and returns the result.
-			nlerp ( 0.0f, A, B ) = A
-			nlerp ( 1.0f, A, B ) = B
-			@remarks
-			Nlerp is faster than Slerp.
-			Nlerp has the proprieties of being commutative (@see Slerp;
-			commutativity is desired in certain places, like IK animation), and
-			being torque-minimal (unless shortestPath=false). However, it's performing
-			the interpolation at non-constant velocity; sometimes this is desired,
-			sometimes it is not. Having a non-constant velocity can produce a more
-			natural rotation feeling without the need of tweaking the weights; however
-			if your scene relies on the timing of the rotation or assumes it will point
-			at a specific angle at a specific weight value, Slerp is a better choice.
-		*/
-        static Quaternion nlerp(Real fT, const Quaternion& rkP, 
-            const Quaternion& rkQ, bool shortestPath = false);
-
-        /// Cutoff for sine near zero
-        static const Real msEpsilon;
-
-        // special values
-        static const Quaternion ZERO;
-        static const Quaternion IDENTITY;
-
-		Real w, x, y, z;
-
-		/// Check whether this quaternion contains valid values
-		inline bool isNaN() const
+		Float4 coeff0 = Mul4(t0,f0);
+		Float4 coeff1 = Xor4(Mul4(t1,f1),sign);
+
+		Float4 r0 = Add4(Mul4(p0,coeff0),Mul4(q0,coeff1));
+		Float4 r1 = Add4(Mul4(p1,coeff0),Mul4(q1,coeff1));
+		Float4 r2 = Add4(Mul4(p2,coeff0),Mul4(q2,coeff1));
+		Float4 r3 = Add4(Mul4(p3,coeff0),Mul4(q3,coeff1));
+		Transpose4(r0,r1,r2,r3);
+		Store4(out[i]._q,r0);
+		Store4(out[i+1]._q,r1);
+		Store4(out[i+2]._q,r2);
+		Store4(out[i+3]._q,r3);
+	}
+	for (; i < numQuaternions; ++i)
+	{
+		float cs = p[i].Dot(q[i]);
+		float sign = 1.0f;
+		if (cs < 0.0f)
 		{
-			return Math::isNaN(x) || Math::isNaN(y) || Math::isNaN(z) || Math::isNaN(w);
+			cs = -cs;
+			sign = -1.0f;
 		}
+		float coeff0 = SlerpWeight(1.0f - t[i],cs);
+		float coeff1 = sign*SlerpWeight(t[i],cs);
+		out[i] = p[i]*coeff0 + q[i]*coeff1;
+	}
+}
 
-        /** Function for writing to a stream. Outputs "Quaternion(w, x, y, z)" with w,x,y,z
-            being the member values of the quaternion.
-        */
-        inline _OgreExport friend std::ostream& operator <<
-            ( std::ostream& o, const Quaternion& q )
-        {
-            o << "Quaternion(" << q.w << ", " << q.x << ", " << q.y << ", " << q.z << ")";
-            return o;
-        }
+template <>
+inline void Quaternion<float>::Nlerp (int numQuaternions, const float* t,
+	const Quaternion* p, const Quaternion* q, Quaternion* out)
+{
+	Float4 zero = Splat4(0.0f);
+	Float4 one = Splat4(1.0f);
+	Float4 signBit = Splat4(-0.0f);
+	Float4 epsilon = Splat4(Math<float>::EPSILON);
+
+	int i = 0;
+	for (; i + 4 <= numQuaternions; i += 4)
+	{
+		Float4 p0 = Load4(p[i]._q), p1 = Load4(p[i+1]._q),
+			p2 = Load4(p[i+2]._q), p3 = Load4(p[i+3]._q);
+		Float4 q0 = Load4(q[i]._q), q1 = Load4(q[i+1]._q),
+			q2 = Load4(q[i+2]._q), q3 = Load4(q[i+3]._q);
+		Transpose4(p0,p1,p2,p3);
+		Transpose4(q0,q1,q2,q3);
+
+		Float4 cs = MulAdd4(p3,q3,MulAdd4(p2,q2,MulAdd4(p1,q1,Mul4(p0,q0))));
+		Float4 t1 = Load4(t + i);
+		Float4 coeff0 = Sub4(one,t1);
+		Float4 coeff1 = Xor4(t1,And4(Greater4(zero,cs),signBit));
+
+		Float4 r0 = Add4(Mul4(coeff0,p0),Mul4(coeff1,q0));
+		Float4 r1 = Add4(Mul4(coeff0,p1),Mul4(coeff1,q1));
+		Float4 r2 = Add4(Mul4(coeff0,p2),Mul4(coeff1,q2));
+		Float4 r3 = Add4(Mul4(coeff0,p3),Mul4(coeff1,q3));
+
+		Float4 length = Sqrt4(MulAdd4(r3,r3,
+			MulAdd4(r2,r2,MulAdd4(r1,r1,Mul4(r0,r0)))));
+		Float4 keep = Greater4(length,epsilon);
+		Float4 invLength = Div4(one,length);
+		r0 = And4(keep,Mul4(r0,invLength));
+		r1 = And4(keep,Mul4(r1,invLength));
+		r2 = And4(keep,Mul4(r2,invLength));
+		r3 = And4(keep,Mul4(r3,invLength));
+
+		Transpose4(r0,r1,r2,r3);
+		Store4(out[i]._q,r0);
+		Store4(out[i+1]._q,r1);
+		Store4(out[i+2]._q,r2);
+		Store4(out[i+3]._q,r3);
+	}
+	for (; i < numQuaternions; ++i)
+	{
+		out[i] = Nlerp(t[i],p[i],q[i]);
+	}
+}
 
-    };
-	/** @} */
-	/** @} */
+#endif
 
+template <typename Real>
+constexpr Quaternion<Real> operator* (Real scalar, const Quaternion<Real>& quat)
+{
+	return quat*scalar;
 }
 
+template <typename Real>
+std::ostream& operator<< (std::ostream& outStream, const Quaternion<Real>& quat)
+{
+	return outStream << quat.w << ' ' << quat.x << ' ' << quat.y << ' '
+		<< quat.z;
+}
 
+typedef Quaternion<float> Quaternionf;
 
-
-#endif 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,241 @@
+#ifndef Z_SIMD_H_
+#define Z_SIMD_H_
+
+#include "Core.h"
+
+// Four float lanes behind a handful of inline functions, SSE on x86 and
+// NEON on ARM.  Z_SIMD is 0 when neither is there or Z_MATH_NO_SIMD is
+// defined, and the math classes then keep their scalar code.
+//
+// Everything here does exactly one IEEE operation per lane, the same
+// operations in the same order as the scalar code it replaces, so results
+// match the scalar build bit for bit as long as the compiler doesn't
+// contract multiplies and adds into FMAs.
+
+#if defined(Z_MATH_NO_SIMD)
+	#define Z_SIMD 0
+#elif defined(__SSE2__) || defined(__x86_64__)
+	#define Z_SIMD 1
+	#define Z_SIMD_SSE 1
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define Z_SIMD 1
+	#define Z_SIMD_NEON 1
+	#include <arm_neon.h>
+#else
+	#define Z_SIMD 0
+#endif
+
+#if Z_SIMD
+
+#if Z_SIMD_SSE
+typedef __m128 Float4;
+#else
+typedef float32x4_t Float4;
+#endif
+
+inline Float4 Load4 (const float* p)
+{
+#if Z_SIMD_SSE
+	return _mm_loadu_ps(p);
+#else
+	return vld1q_f32(p);
+#endif
+}
+
+inline void Store4 (float* p, Float4 a)
+{
+#if Z_SIMD_SSE
+	_mm_storeu_ps(p,a);
+#else
+	vst1q_f32(p,a);
+#endif
+}
+
+inline Float4 Set4 (float x, float y, float z, float w)
+{
+#if Z_SIMD_SSE
+	return _mm_setr_ps(x,y,z,w);
+#else
+	float v[4] = {x,y,z,w};
+	return vld1q_f32(v);
+#endif
+}
+
+inline Float4 Splat4 (float x)
+{
+#if Z_SIMD_SSE
+	return _mm_set1_ps(x);
+#else
+	return vdupq_n_f32(x);
+#endif
+}
+
+inline Float4 Add4 (Float4 a, Float4 b)
+{
+#if Z_SIMD_SSE
+	return _mm_add_ps(a,b);
+#else
+	return vaddq_f32(a,b);
+#endif
+}
+
+inline Float4 Sub4 (Float4 a, Float4 b)
+{
+#if Z_SIMD_SSE
+	return _mm_sub_ps(a,b);
+#else
+	return vsubq_f32(a,b);
+#endif
+}
+
+inline Float4 Mul4 (Float4 a, Float4 b)
+{
+#if Z_SIMD_SSE
+	return _mm_mul_ps(a,b);
+#else
+	return vmulq_f32(a,b);
+#endif
+}
+
+inline Float4 Min4 (Float4 a, Float4 b)
+{
+#if Z_SIMD_SSE
+	return _mm_min_ps(a,b);
+#else
+	return vminq_f32(a,b);
+#endif
+}
+
+inline Float4 Max4 (Float4 a, Float4 b)
+{
+#if Z_SIMD_SSE
+	return _mm_max_ps(a,b);
+#else
+	return vmaxq_f32(a,b);
+#endif
+}
+
+inline Float4 Div4 (Float4 a, Float4 b)
+{
+#if Z_SIMD_SSE
+	return _mm_div_ps(a,b);
+#elif defined(__aarch64__)
+	return vdivq_f32(a,b);
+#else
+	float x[4], y[4];
+	vst1q_f32(x,a);
+	vst1q_f32(y,b);
+	for (int i = 0; i < 4; ++i)
+	{
+		x[i] /= y[i];
+	}
+	return vld1q_f32(x);
+#endif
+}
+
+inline Float4 Sqrt4 (Float4 a)
+{
+#if Z_SIMD_SSE
+	return _mm_sqrt_ps(a);
+#elif defined(__aarch64__)
+	return vsqrtq_f32(a);
+#else
+	float x[4];
+	vst1q_f32(x,a);
+	for (int i = 0; i < 4; ++i)
+	{
+		x[i] = sqrtf(x[i]);
+	}
+	return vld1q_f32(x);
+#endif
+}
+
+// All bits set in the lanes where a > b, clear elsewhere.
+inline Float4 Greater4 (Float4 a, Float4 b)
+{
+#if Z_SIMD_SSE
+	return _mm_cmpgt_ps(a,b);
+#else
+	return vreinterpretq_f32_u32(vcgtq_f32(a,b));
+#endif
+}
+
+// a where mask is set, zero elsewhere.
+inline Float4 And4 (Float4 mask, Float4 a)
+{
+#if Z_SIMD_SSE
+	return _mm_and_ps(mask,a);
+#else
+	return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(mask),
+		vreinterpretq_u32_f32(a)));
+#endif
+}
+
+inline Float4 Or4 (Float4 a, Float4 b)
+{
+#if Z_SIMD_SSE
+	return _mm_or_ps(a,b);
+#else
+	return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a),
+		vreinterpretq_u32_f32(b)));
+#endif
+}
+
+// With a mask of sign bits, negates the lanes where it is set.
+inline Float4 Xor4 (Float4 a, Float4 b)
+{
+#if Z_SIMD_SSE
+	return _mm_xor_ps(a,b);
+#else
+	return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a),
+		vreinterpretq_u32_f32(b)));
+#endif
+}
+
+// The sign bit of every lane, lane i in bit i.
+inline int Mask4 (Float4 a)
+{
+#if Z_SIMD_SSE
+	return _mm_movemask_ps(a);
+#else
+	uint32_t lanes[4];
+	vst1q_u32(lanes,vshrq_n_u32(vreinterpretq_u32_f32(a),31));
+	return lanes[0] | lanes[1] << 1 | lanes[2] << 2 | lanes[3] << 3;
+#endif
+}
+
+// a*b + c as two roundings, never fused.
+inline Float4 MulAdd4 (Float4 a, Float4 b, Float4 c)
+{
+	return Add4(Mul4(a,b),c);
+}
+
+// Lane i of a in every lane.
+template <int i>
+inline Float4 Lane4 (Float4 a)
+{
+#if Z_SIMD_SSE
+	return _mm_shuffle_ps(a,a,_MM_SHUFFLE(i,i,i,i));
+#else
+	return vdupq_n_f32(vgetq_lane_f32(a,i));
+#endif
+}
+
+inline void Transpose4 (Float4& r0, Float4& r1, Float4& r2, Float4& r3)
+{
+#if Z_SIMD_SSE
+	_MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+#else
+	float32x4x2_t t01 = vtrnq_f32(r0,r1);
+	float32x4x2_t t23 = vtrnq_f32(r2,r3);
+	r0 = vcombine_f32(vget_low_f32(t01.val[0]),vget_low_f32(t23.val[0]));
+	r1 = vcombine_f32(vget_low_f32(t01.val[1]),vget_low_f32(t23.val[1]));
+	r2 = vcombine_f32(vget_high_f32(t01.val[0]),vget_high_f32(t23.val[0]));
+	r3 = vcombine_f32(vget_high_f32(t01.val[1]),vget_high_f32(t23.val[1]));
+#endif
+}
+
+#endif
+
+#endif
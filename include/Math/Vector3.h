@@ -19,16 +19,16 @@ public:
 	};
 
 	Vector3 ();
-	Vector3 (const Vector3& vec);
-	Vector3 (Real x, Real y, Real z);
+	constexpr Vector3 (const Vector3& vec);
+	constexpr Vector3 (Real x, Real y, Real z);
 
 	Vector3& operator= (const Vector3& vec);
 
-	inline Vector3 operator+ (const Vector3& vec) const;
-	inline Vector3 operator- (const Vector3& vec) const;
-	inline Vector3 operator* (Real scalar) const;
+	constexpr Vector3 operator+ (const Vector3& vec) const;
+	constexpr Vector3 operator- (const Vector3& vec) const;
+	constexpr Vector3 operator* (Real scalar) const;
 	inline Vector3 operator/ (Real scalar) const;
-	inline Vector3 operator- () const;
+	constexpr Vector3 operator- () const;
 
 	inline Vector3& operator+= (const Vector3& vec);
 	inline Vector3& operator-= (const Vector3& vec);
@@ -39,8 +39,8 @@ public:
 	inline Real operator[] (size_t index) const;
 
 	inline Real Length () const;
-	inline Real SquaredLength () const;
-	inline Real Dot (const Vector3& vec) const;
+	constexpr Real SquaredLength () const;
+	constexpr Real Dot (const Vector3& vec) const;
 	inline Real Normalize (const Real epsilon = Math<Real>::EPSILON);
 	inline Real Distance (const Vector3& vec) const;
 
@@ -53,7 +53,7 @@ public:
 	// a cross product with these functions and send the result to the API
 	// that expects left-handed, you will need to change sign on the vector
 	// (replace each component value c by -c).
-	Vector3 Cross (const Vector3& vec) const;
+	constexpr Vector3 Cross (const Vector3& vec) const;
 	Vector3 UnitCross (const Vector3& vec) const;
 	Vector3 Normalized () const;
 	Vector3 Perpendicular () const;
@@ -74,7 +74,7 @@ public:
 
 // Arithmetic operations.
 template <typename Real>
-inline Vector3<Real> operator* (Real scalar, const Vector3<Real>& vec);
+constexpr Vector3<Real> operator* (Real scalar, const Vector3<Real>& vec);
 
 // Debugging output.
 template <typename Real>
@@ -89,21 +89,26 @@ Vector3<Real>::Vector3 ()
 }
 
 template <typename Real>
-Vector3<Real>::Vector3 (const Vector3& vec)
+constexpr Vector3<Real>::Vector3 (const Vector3& vec)
+	: x(vec.x), y(vec.y), z(vec.z)
 {
-	x = vec.x;
-	y = vec.y;
-	z = vec.z;
 }
 
 template <typename Real>
-Vector3<Real>::Vector3 (Real x, Real y, Real z)
+constexpr Vector3<Real>::Vector3 (Real x, Real y, Real z)
+	: x(x), y(y), z(z)
 {
-	this->x = x;
-	this->y = y;
-	this->z = z;
 }
 
+template <typename Real> constexpr Vector3<Real> Vector3<Real>::ZERO(0,0,0);
+template <typename Real> constexpr Vector3<Real> Vector3<Real>::UNIT_X(1,0,0);
+template <typename Real> constexpr Vector3<Real> Vector3<Real>::UNIT_Y(0,1,0);
+template <typename Real> constexpr Vector3<Real> Vector3<Real>::UNIT_Z(0,0,1);
+template <typename Real> constexpr Vector3<Real> Vector3<Real>::NEGATIVE_UNIT_X(-1,0,0);
+template <typename Real> constexpr Vector3<Real> Vector3<Real>::NEGATIVE_UNIT_Y(0,-1,0);
+template <typename Real> constexpr Vector3<Real> Vector3<Real>::NEGATIVE_UNIT_Z(0,0,-1);
+template <typename Real> constexpr Vector3<Real> Vector3<Real>::ONE(1,1,1);
+
 template <typename Real>
 Vector3<Real>& Vector3<Real>::operator= (const Vector3& vec)
 {
@@ -114,7 +119,7 @@ Vector3<Real>& Vector3<Real>::operator= (const Vector3& vec)
 }
 
 template <typename Real>
-inline Vector3<Real> Vector3<Real>::operator+ (const Vector3& vec) const
+constexpr Vector3<Real> Vector3<Real>::operator+ (const Vector3& vec) const
 {
 	return Vector3
 	(
@@ -125,7 +130,7 @@ inline Vector3<Real> Vector3<Real>::operator+ (const Vector3& vec) const
 }
 
 template <typename Real>
-inline Vector3<Real> Vector3<Real>::operator- (const Vector3& vec) const
+constexpr Vector3<Real> Vector3<Real>::operator- (const Vector3& vec) const
 {
 	return Vector3
 	(
@@ -136,7 +141,7 @@ inline Vector3<Real> Vector3<Real>::operator- (const Vector3& vec) const
 }
 
 template <typename Real>
-inline Vector3<Real> Vector3<Real>::operator* (Real scalar) const
+constexpr Vector3<Real> Vector3<Real>::operator* (Real scalar) const
 {
 	return Vector3
 	(
@@ -169,7 +174,7 @@ inline Vector3<Real> Vector3<Real>::operator/ (Real scalar) const
 }
 
 template <typename Real>
-inline Vector3<Real> Vector3<Real>::operator- () const
+constexpr Vector3<Real> Vector3<Real>::operator- () const
 {
 	return Vector3
 	(
@@ -252,7 +257,7 @@ inline Real Vector3<Real>::Length () const
 }
 
 template <typename Real>
-inline Real Vector3<Real>::SquaredLength () const
+constexpr Real Vector3<Real>::SquaredLength () const
 {
 	return
 		x * x +
@@ -261,7 +266,7 @@ inline Real Vector3<Real>::SquaredLength () const
 }
 
 template <typename Real>
-inline Real Vector3<Real>::Dot (const Vector3& vec) const
+constexpr Real Vector3<Real>::Dot (const Vector3& vec) const
 {
 	return
 		this->x*vec.x +
@@ -293,7 +298,7 @@ inline Real Vector3<Real>::Normalize (const Real epsilon)
 }
 
 template <typename Real>
-Vector3<Real> Vector3<Real>::Cross (const Vector3& vec) const
+constexpr Vector3<Real> Vector3<Real>::Cross (const Vector3& vec) const
 {
 	return Vector3
 	(
@@ -376,7 +381,7 @@ void Vector3<Real>::ComputeAABB (int numVectors, const Vector3* vectors,
 }
 
 template <typename Real>
-inline Vector3<Real> operator* (Real scalar, const Vector3<Real>& vec)
+constexpr Vector3<Real> operator* (Real scalar, const Vector3<Real>& vec)
 {
 	return Vector3<Real>
 	(
@@ -0,0 +1,527 @@
+#ifndef Z_VECTOR3STREAM_H_
+#define Z_VECTOR3STREAM_H_
+
+#include "Core.h"
+#include "Math/Math.h"
+#include "Math/Vector3.h"
+#include "Math/Matrix4.h"
+#include "Math/SIMD.h"
+
+// Many vectors stored as structure of arrays, one array per component, so
+// the kernels below work on four vectors at a time.  Vectors come in from
+// interleaved vertex data with Gather, or are computed on directly from it
+// with the strided ComputeAABB.
+
+template <typename Real>
+class Vector3Stream
+{
+public:
+
+	std::vector<Real> x, y, z;
+
+	Vector3Stream ();
+	Vector3Stream (int numVectors);
+
+	void SetQuantity (int numVectors);
+	inline int GetQuantity () const;
+
+	inline Vector3<Real> Get (int i) const;
+	inline void Set (int i, const Vector3<Real>& vec);
+
+	// Replace the contents with numVectors vectors read from data, each
+	// stride Reals after the previous one.  stride must be at least 3.
+	void Gather (int numVectors, const Real* data, int stride);
+
+	// Component-wise extremes, the stream must not be empty.
+	Vector3<Real> Min () const;
+	Vector3<Real> Max () const;
+	void ComputeAABB (Vector3<Real>& vmin, Vector3<Real>& vmax) const;
+
+	// Bounds of numVectors vectors read straight from interleaved data
+	// without gathering them first.
+	static void ComputeAABB (int numVectors, const Real* data, int stride,
+		Vector3<Real>& vmin, Vector3<Real>& vmax);
+
+	// The same over only the vectors indices refer to, for data shared by
+	// several index ranges.
+	static void ComputeAABB (int numIndices, const uint16_t* indices,
+		const Real* data, int stride, Vector3<Real>& vmin,
+		Vector3<Real>& vmax);
+
+	// out[i] = mat.TransformPoint(this[i]), out may be this.
+	void TransformPoints (const Matrix4<Real>& mat, Vector3Stream& out) const;
+
+	// out[i] = this[i].Dot(vec[i]).
+	void Dot (const Vector3Stream& vec, Real* out) const;
+
+	// out[i] = this[i].Cross(vec[i]), out may be either input.
+	void Cross (const Vector3Stream& vec, Vector3Stream& out) const;
+
+	// Vector3::Normalize on every vector, lengths receives the lengths
+	// when given.
+	void Normalize (Real* lengths = 0,
+		const Real epsilon = Math<Real>::EPSILON);
+};
+
+// implementations
+
+template <typename Real>
+Vector3Stream<Real>::Vector3Stream ()
+{
+}
+
+template <typename Real>
+Vector3Stream<Real>::Vector3Stream (int numVectors)
+{
+	SetQuantity(numVectors);
+}
+
+template <typename Real>
+void Vector3Stream<Real>::SetQuantity (int numVectors)
+{
+	x.resize(numVectors);
+	y.resize(numVectors);
+	z.resize(numVectors);
+}
+
+template <typename Real>
+inline int Vector3Stream<Real>::GetQuantity () const
+{
+	return (int)x.size();
+}
+
+template <typename Real>
+inline Vector3<Real> Vector3Stream<Real>::Get (int i) const
+{
+	return Vector3<Real>(x[i],y[i],z[i]);
+}
+
+template <typename Real>
+inline void Vector3Stream<Real>::Set (int i, const Vector3<Real>& vec)
+{
+	x[i] = vec.x;
+	y[i] = vec.y;
+	z[i] = vec.z;
+}
+
+template <typename Real>
+void Vector3Stream<Real>::Gather (int numVectors, const Real* data,
+	int stride)
+{
+	assertion(stride >= 3, "Invalid stride to Gather\n");
+
+	SetQuantity(numVectors);
+	for (int i = 0; i < numVectors; ++i, data += stride)
+	{
+		x[i] = data[0];
+		y[i] = data[1];
+		z[i] = data[2];
+	}
+}
+
+template <typename Real>
+Vector3<Real> Vector3Stream<Real>::Min () const
+{
+	assertion(GetQuantity() > 0, "Min of an empty stream\n");
+
+	Vector3<Real> vmin = Get(0);
+	for (int i = 1; i < GetQuantity(); ++i)
+	{
+		vmin.x = (x[i] < vmin.x ? x[i] : vmin.x);
+		vmin.y = (y[i] < vmin.y ? y[i] : vmin.y);
+		vmin.z = (z[i] < vmin.z ? z[i] : vmin.z);
+	}
+	return vmin;
+}
+
+template <typename Real>
+Vector3<Real> Vector3Stream<Real>::Max () const
+{
+	assertion(GetQuantity() > 0, "Max of an empty stream\n");
+
+	Vector3<Real> vmax = Get(0);
+	for (int i = 1; i < GetQuantity(); ++i)
+	{
+		vmax.x = (x[i] > vmax.x ? x[i] : vmax.x);
+		vmax.y = (y[i] > vmax.y ? y[i] : vmax.y);
+		vmax.z = (z[i] > vmax.z ? z[i] : vmax.z);
+	}
+	return vmax;
+}
+
+template <typename Real>
+void Vector3Stream<Real>::ComputeAABB (Vector3<Real>& vmin,
+	Vector3<Real>& vmax) const
+{
+	vmin = Min();
+	vmax = Max();
+}
+
+template <typename Real>
+void Vector3Stream<Real>::ComputeAABB (int numVectors, const Real* data,
+	int stride, Vector3<Real>& vmin, Vector3<Real>& vmax)
+{
+	assertion(numVectors > 0 && data && stride >= 3,
+		"Invalid inputs to ComputeAABB\n");
+
+	vmin = Vector3<Real>(data[0],data[1],data[2]);
+	vmax = vmin;
+	for (int j = 1; j < numVectors; ++j)
+	{
+		const Real* vec = data + j*stride;
+		for (int i = 0; i < 3; ++i)
+		{
+			vmin[i] = (vec[i] < vmin[i] ? vec[i] : vmin[i]);
+			vmax[i] = (vec[i] > vmax[i] ? vec[i] : vmax[i]);
+		}
+	}
+}
+
+template <typename Real>
+void Vector3Stream<Real>::ComputeAABB (int numIndices, const uint16_t* indices,
+	const Real* data, int stride, Vector3<Real>& vmin, Vector3<Real>& vmax)
+{
+	assertion(numIndices > 0 && indices && data && stride >= 3,
+		"Invalid inputs to ComputeAABB\n");
+
+	const Real* first = data + indices[0]*stride;
+	vmin = Vector3<Real>(first[0],first[1],first[2]);
+	vmax = vmin;
+	for (int j = 1; j < numIndices; ++j)
+	{
+		const Real* vec = data + indices[j]*stride;
+		for (int i = 0; i < 3; ++i)
+		{
+			vmin[i] = (vec[i] < vmin[i] ? vec[i] : vmin[i]);
+			vmax[i] = (vec[i] > vmax[i] ? vec[i] : vmax[i]);
+		}
+	}
+}
+
+template <typename Real>
+void Vector3Stream<Real>::TransformPoints (const Matrix4<Real>& mat,
+	Vector3Stream& out) const
+{
+	out.SetQuantity(GetQuantity());
+	for (int i = 0; i < GetQuantity(); ++i)
+	{
+		out.Set(i,mat.TransformPoint(Get(i)));
+	}
+}
+
+template <typename Real>
+void Vector3Stream<Real>::Dot (const Vector3Stream& vec, Real* out) const
+{
+	assertion(vec.GetQuantity() == GetQuantity(), "Stream size mismatch\n");
+
+	for (int i = 0; i < GetQuantity(); ++i)
+	{
+		out[i] = x[i]*vec.x[i] + y[i]*vec.y[i] + z[i]*vec.z[i];
+	}
+}
+
+template <typename Real>
+void Vector3Stream<Real>::Cross (const Vector3Stream& vec,
+	Vector3Stream& out) const
+{
+	assertion(vec.GetQuantity() == GetQuantity(), "Stream size mismatch\n");
+
+	out.SetQuantity(GetQuantity());
+	for (int i = 0; i < GetQuantity(); ++i)
+	{
+		out.Set(i,Get(i).Cross(vec.Get(i)));
+	}
+}
+
+template <typename Real>
+void Vector3Stream<Real>::Normalize (Real* lengths, const Real epsilon)
+{
+	for (int i = 0; i < GetQuantity(); ++i)
+	{
+		Vector3<Real> vec = Get(i);
+		Real length = vec.Normalize(epsilon);
+		Set(i,vec);
+		if (lengths)
+		{
+			lengths[i] = length;
+		}
+	}
+}
+
+#if Z_SIMD
+
+// Vector3Stream<float> four vectors at a time, with the leftovers going
+// through the generic code.  Every kernel does the same operations as the
+// generic one and gives identical results.
+
+template <>
+inline void Vector3Stream<float>::Gather (int numVectors, const float* data,
+	int stride)
+{
+	assertion(stride >= 3, "Invalid stride to Gather\n");
+
+	// Four floats are loaded per vector.  The last one could end right
+	// after its z, so it is left to the scalar loop.
+	SetQuantity(numVectors);
+	int wide = (numVectors - 1) & ~3;
+	int i = 0;
+	for (; i < wide; i += 4, data += 4*stride)
+	{
+		Float4 r0 = Load4(data);
+		Float4 r1 = Load4(data + stride);
+		Float4 r2 = Load4(data + 2*stride);
+		Float4 r3 = Load4(data + 3*stride);
+		Transpose4(r0,r1,r2,r3);
+		Store4(&x[i],r0);
+		Store4(&y[i],r1);
+		Store4(&z[i],r2);
+	}
+	for (; i < numVectors; ++i, data += stride)
+	{
+		x[i] = data[0];
+		y[i] = data[1];
+		z[i] = data[2];
+	}
+}
+
+template <>
+inline Vector3<float> Vector3Stream<float>::Min () const
+{
+	assertion(GetQuantity() > 0, "Min of an empty stream\n");
+
+	int n = GetQuantity();
+	if (n < 4)
+	{
+		Vector3<float> vmin = Get(0);
+		for (int i = 1; i < n; ++i)
+		{
+			vmin.x = (x[i] < vmin.x ? x[i] : vmin.x);
+			vmin.y = (y[i] < vmin.y ? y[i] : vmin.y);
+			vmin.z = (z[i] < vmin.z ? z[i] : vmin.z);
+		}
+		return vmin;
+	}
+
+	// The last four overlap the previous block when n isn't a multiple of
+	// four, which a minimum doesn't mind.
+	Float4 mx = Load4(&x[0]), my = Load4(&y[0]), mz = Load4(&z[0]);
+	for (int i = 4; i < n; i += 4)
+	{
+		int j = (i + 4 <= n ? i : n - 4);
+		mx = Min4(mx,Load4(&x[j]));
+		my = Min4(my,Load4(&y[j]));
+		mz = Min4(mz,Load4(&z[j]));
+	}
+	float lx[4], ly[4], lz[4];
+	Store4(lx,mx);
+	Store4(ly,my);
+	Store4(lz,mz);
+	Vector3<float> vmin(lx[0],ly[0],lz[0]);
+	for (int i = 1; i < 4; ++i)
+	{
+		vmin.x = (lx[i] < vmin.x ? lx[i] : vmin.x);
+		vmin.y = (ly[i] < vmin.y ? ly[i] : vmin.y);
+		vmin.z = (lz[i] < vmin.z ? lz[i] : vmin.z);
+	}
+	return vmin;
+}
+
+template <>
+inline Vector3<float> Vector3Stream<float>::Max () const
+{
+	assertion(GetQuantity() > 0, "Max of an empty stream\n");
+
+	int n = GetQuantity();
+	if (n < 4)
+	{
+		Vector3<float> vmax = Get(0);
+		for (int i = 1; i < n; ++i)
+		{
+			vmax.x = (x[i] > vmax.x ? x[i] : vmax.x);
+			vmax.y = (y[i] > vmax.y ? y[i] : vmax.y);
+			vmax.z = (z[i] > vmax.z ? z[i] : vmax.z);
+		}
+		return vmax;
+	}
+
+	Float4 mx = Load4(&x[0]), my = Load4(&y[0]), mz = Load4(&z[0]);
+	for (int i = 4; i < n; i += 4)
+	{
+		int j = (i + 4 <= n ? i : n - 4);
+		mx = Max4(mx,Load4(&x[j]));
+		my = Max4(my,Load4(&y[j]));
+		mz = Max4(mz,Load4(&z[j]));
+	}
+	float lx[4], ly[4], lz[4];
+	Store4(lx,mx);
+	Store4(ly,my);
+	Store4(lz,mz);
+	Vector3<float> vmax(lx[0],ly[0],lz[0]);
+	for (int i = 1; i < 4; ++i)
+	{
+		vmax.x = (lx[i] > vmax.x ? lx[i] : vmax.x);
+		vmax.y = (ly[i] > vmax.y ? ly[i] : vmax.y);
+		vmax.z = (lz[i] > vmax.z ? lz[i] : vmax.z);
+	}
+	return vmax;
+}
+
+template <>
+inline void Vector3Stream<float>::ComputeAABB (int numVectors,
+	const float* data, int stride, Vector3<float>& vmin, Vector3<float>& vmax)
+{
+	assertion(numVectors > 0 && data && stride >= 3,
+		"Invalid inputs to ComputeAABB\n");
+
+	// Each vector is one unaligned load, the fourth lane is whatever
+	// follows it and is ignored, except for the last vector which may end
+	// right after its z.  Two accumulators hide the min/max latency, the
+	// loads are what limits this.
+	int wide = numVectors - 1;
+	Float4 lo0 = Set4(data[0],data[1],data[2],0), hi0 = lo0;
+	Float4 lo1 = lo0, hi1 = lo0;
+	int j = 0;
+	for (; j + 2 <= wide; j += 2)
+	{
+		Float4 v0 = Load4(data + j*stride);
+		Float4 v1 = Load4(data + (j + 1)*stride);
+		lo0 = Min4(lo0,v0);
+		hi0 = Max4(hi0,v0);
+		lo1 = Min4(lo1,v1);
+		hi1 = Max4(hi1,v1);
+	}
+	float lo[4], hi[4];
+	Store4(lo,Min4(lo0,lo1));
+	Store4(hi,Max4(hi0,hi1));
+	vmin = Vector3<float>(lo[0],lo[1],lo[2]);
+	vmax = Vector3<float>(hi[0],hi[1],hi[2]);
+	for (; j < numVectors; ++j)
+	{
+		const float* vec = data + j*stride;
+		for (int i = 0; i < 3; ++i)
+		{
+			vmin[i] = (vec[i] < vmin[i] ? vec[i] : vmin[i]);
+			vmax[i] = (vec[i] > vmax[i] ? vec[i] : vmax[i]);
+		}
+	}
+}
+
+template <>
+inline void Vector3Stream<float>::TransformPoints (const Matrix4<float>& mat,
+	Vector3Stream& out) const
+{
+	int n = GetQuantity();
+	out.SetQuantity(n);
+
+	Float4 m[12];
+	for (int k = 0; k < 12; ++k)
+	{
+		m[k] = Splat4(mat._m[k]);
+	}
+
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		Float4 vx = Load4(&x[i]), vy = Load4(&y[i]), vz = Load4(&z[i]);
+		Float4 rx = Add4(MulAdd4(m[2],vz,MulAdd4(m[1],vy,Mul4(m[0],vx))),m[3]);
+		Float4 ry = Add4(MulAdd4(m[6],vz,MulAdd4(m[5],vy,Mul4(m[4],vx))),m[7]);
+		Float4 rz = Add4(MulAdd4(m[10],vz,MulAdd4(m[9],vy,Mul4(m[8],vx))),m[11]);
+		Store4(&out.x[i],rx);
+		Store4(&out.y[i],ry);
+		Store4(&out.z[i],rz);
+	}
+	for (; i < n; ++i)
+	{
+		float vx = x[i], vy = y[i], vz = z[i];
+		out.x[i] = mat._m[0]*vx + mat._m[1]*vy + mat._m[2]*vz + mat._m[3];
+		out.y[i] = mat._m[4]*vx + mat._m[5]*vy + mat._m[6]*vz + mat._m[7];
+		out.z[i] = mat._m[8]*vx + mat._m[9]*vy + mat._m[10]*vz + mat._m[11];
+	}
+}
+
+template <>
+inline void Vector3Stream<float>::Dot (const Vector3Stream& vec,
+	float* out) const
+{
+	assertion(vec.GetQuantity() == GetQuantity(), "Stream size mismatch\n");
+
+	int n = GetQuantity();
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		Float4 r = Mul4(Load4(&x[i]),Load4(&vec.x[i]));
+		r = MulAdd4(Load4(&y[i]),Load4(&vec.y[i]),r);
+		r = MulAdd4(Load4(&z[i]),Load4(&vec.z[i]),r);
+		Store4(out + i,r);
+	}
+	for (; i < n; ++i)
+	{
+		out[i] = x[i]*vec.x[i] + y[i]*vec.y[i] + z[i]*vec.z[i];
+	}
+}
+
+template <>
+inline void Vector3Stream<float>::Cross (const Vector3Stream& vec,
+	Vector3Stream& out) const
+{
+	assertion(vec.GetQuantity() == GetQuantity(), "Stream size mismatch\n");
+
+	int n = GetQuantity();
+	out.SetQuantity(n);
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		Float4 ax = Load4(&x[i]), ay = Load4(&y[i]), az = Load4(&z[i]);
+		Float4 bx = Load4(&vec.x[i]), by = Load4(&vec.y[i]),
+			bz = Load4(&vec.z[i]);
+		Store4(&out.x[i],Sub4(Mul4(ay,bz),Mul4(az,by)));
+		Store4(&out.y[i],Sub4(Mul4(az,bx),Mul4(ax,bz)));
+		Store4(&out.z[i],Sub4(Mul4(ax,by),Mul4(ay,bx)));
+	}
+	for (; i < n; ++i)
+	{
+		out.Set(i,Get(i).Cross(vec.Get(i)));
+	}
+}
+
+template <>
+inline void Vector3Stream<float>::Normalize (float* lengths,
+	const float epsilon)
+{
+	int n = GetQuantity();
+	Float4 eps = Splat4(epsilon);
+	Float4 one = Splat4(1.0f);
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		Float4 vx = Load4(&x[i]), vy = Load4(&y[i]), vz = Load4(&z[i]);
+		Float4 length =
+			Sqrt4(MulAdd4(vz,vz,MulAdd4(vy,vy,Mul4(vx,vx))));
+		// Vectors no longer than epsilon become zero, like Vector3.
+		Float4 keep = Greater4(length,eps);
+		Float4 invLength = Div4(one,length);
+		Store4(&x[i],And4(keep,Mul4(vx,invLength)));
+		Store4(&y[i],And4(keep,Mul4(vy,invLength)));
+		Store4(&z[i],And4(keep,Mul4(vz,invLength)));
+		if (lengths)
+		{
+			Store4(lengths + i,And4(keep,length));
+		}
+	}
+	for (; i < n; ++i)
+	{
+		Vector3<float> vec = Get(i);
+		float length = vec.Normalize(epsilon);
+		Set(i,vec);
+		if (lengths)
+		{
+			lengths[i] = length;
+		}
+	}
+}
+
+#endif
+
+typedef Vector3Stream<float> Vector3Streamf;
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef Z_MEMORYTRACKER_H_
+#define Z_MEMORYTRACKER_H_
+
+#include "Core.h"
+
+// Counts every operator new and delete in the process, per tag and per
+// thread.  A thread's tag is set with MemoryTagScope and travels with the
+// jobs it queues, so allocations land with the subsystem that caused them
+// wherever they run.  Frees count against the tag of the thread freeing.
+// Only C++ allocations are seen, what SDL, SDL_ttf or the GL driver
+// mallocs doesn't show up.
+//
+// With site tracking on, every allocation also records the call stack it
+// came from, a few frames deep, for Report.  That is a backtrace per
+// allocation, so it is off unless asked for.
+//
+// Building with -DZ_MEMORY_TRACKING=0 leaves operator new alone and every
+// counter at zero.
+
+#ifndef Z_MEMORY_TRACKING
+  #define Z_MEMORY_TRACKING 1
+#endif
+
+enum MemoryTag
+{
+  MEMORY_UNTAGGED,
+  MEMORY_PARSER,
+  MEMORY_TEXTURES,
+  MEMORY_RENDERER,
+  MEMORY_FRAME,
+  MEMORY_TAG_COUNT
+};
+
+struct MemoryCounters
+{
+  uint64_t allocations;
+  uint64_t bytes;
+  uint64_t frees;
+};
+
+class MemoryTracker
+{
+public:
+  // Frames recorded per allocation site.
+  static const int SITE_DEPTH = 6;
+  // Distinct sites kept, allocations from any more only show in counters.
+  static const size_t SITE_SLOTS = 4096;
+
+  static MemoryCounters GetCounters(MemoryTag tag);
+  static MemoryCounters GetTotal();
+
+  // Everything the calling thread has allocated and freed so far.
+  static MemoryCounters GetThreadCounters();
+
+  static MemoryTag GetTag();
+  static void SetTag(MemoryTag tag);
+  static const char* GetTagName(MemoryTag tag);
+
+  static void SetSiteTracking(bool enabled);
+  static bool IsSiteTracking();
+
+  // Whether armed AllocationGuards check anything, off by default.
+  static void SetGuardsEnabled(bool enabled);
+  static bool AreGuardsEnabled();
+
+  // The counters of every tag, then the top sites by bytes and by count
+  // when site tracking was on.
+  static void Report(std::ostream& out, size_t top = 10);
+
+  // Called by operator new and delete.
+  static void RecordAllocation(size_t size, void* caller);
+  static void RecordFree();
+};
+
+// Tags the calling thread's allocations until it goes out of scope.
+class MemoryTagScope
+{
+public:
+  MemoryTagScope(MemoryTag tag)
+    :previous_(MemoryTracker::GetTag())
+  {
+    MemoryTracker::SetTag(tag);
+  }
+
+  ~MemoryTagScope()
+  {
+    MemoryTracker::SetTag(previous_);
+  }
+
+private:
+  MemoryTag previous_;
+};
+
+// What the calling thread allocated and freed since construction.
+class MemoryScope
+{
+public:
+  MemoryScope()
+    :start_(MemoryTracker::GetThreadCounters())
+  {
+  }
+
+  MemoryCounters GetCounters() const
+  {
+    MemoryCounters now = MemoryTracker::GetThreadCounters();
+    MemoryCounters counters = {now.allocations - start_.allocations,
+      now.bytes - start_.bytes,now.frees - start_.frees};
+    return counters;
+  }
+
+private:
+  MemoryCounters start_;
+};
+
+// Asserts that the calling thread doesn't allocate between construction
+// and End, when guards are enabled and the guard is armed.
+class AllocationGuard
+{
+public:
+  AllocationGuard(const char* name, bool armed = true)
+    :name_(name),armed_(armed && MemoryTracker::AreGuardsEnabled())
+  {
+  }
+
+  ~AllocationGuard()
+  {
+    End();
+  }
+
+  // Checks now instead of at the end of the scope.
+  void End();
+
+private:
+  const char* name_;
+  bool armed_;
+  MemoryScope scope_;
+};
+
+#endif
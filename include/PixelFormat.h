@@ -0,0 +1,62 @@
+#ifndef Z_PIXELFORMAT_H_
+#define Z_PIXELFORMAT_H_
+
+#include "Core.h"
+#include "SDL2/SDL.h"
+
+using namespace std;
+
+//	Pixel format conversion to tightly packed RGBA8
+//	Everything the loaders hand to GL goes through here first, so uploads
+//	always take the GL_RGBA8 <- GL_RGBA / GL_UNSIGNED_BYTE path and never
+//	depend on the driver swizzling or on GL_UNPACK_ALIGNMENT for 3 byte
+//	rows.  The kernels are picked once at runtime: AVX2 or SSSE3 on x86,
+//	NEON on ARM, plain C++ everywhere else.
+
+enum PixelLayout
+{
+	PIXEL_RGB,
+	PIXEL_BGR,
+	PIXEL_RGBA,
+	PIXEL_BGRA
+};
+
+enum PixelSIMD
+{
+	PIXEL_SIMD_SCALAR,
+	PIXEL_SIMD_SSSE3,
+	PIXEL_SIMD_AVX2,
+	PIXEL_SIMD_NEON
+};
+
+// Kernel set in use, and a way to force one for benchmarking.  Returns
+// false and keeps the current set if the CPU can't run it.
+PixelSIMD pixel_simd();
+bool set_pixel_simd(PixelSIMD simd);
+const char* pixel_simd_name(PixelSIMD simd);
+
+// count pixels of layout to RGBA, alpha 255 for 3 byte layouts.  src and
+// dst may be the same for the 4 byte layouts.
+void convert_row(PixelLayout layout, const uint8_t* src, uint8_t* dst,
+	size_t count);
+
+// Whole image with rows pitch bytes apart, bottom row first if flip.
+void convert_image(PixelLayout layout, const uint8_t* src, size_t pitch,
+	uint32_t width, uint32_t height, uint8_t* dst, bool flip = false);
+
+// count RGBA pixels, each the rounded average of a 2x2 block of the two
+// rows, which hold at least 2*count pixels.
+void box_filter_row(const uint8_t* row0, const uint8_t* row1, uint8_t* dst,
+	size_t count);
+
+// Mirror an image vertically in place.
+void flip_rows(uint8_t* pixels, size_t pitch, uint32_t height);
+
+// Layout of an SDL surface, false if it isn't one of the above.
+bool surface_layout(const SDL_Surface* surface, PixelLayout& layout);
+
+// Any surface to tightly packed RGBA8, through SDL for unusual formats.
+bool surface_to_rgba(SDL_Surface* surface, vector<uint8_t>& rgba,
+	bool flip = false);
+
+#endif
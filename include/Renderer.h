@@ -44,6 +44,16 @@ public:
     height_ = height;
   }
 
+  int GetWidth() const
+  {
+    return width_;
+  }
+
+  int GetHeight() const
+  {
+    return height_;
+  }
+
 private:
   Window* window_;
   int width_,height_;
@@ -0,0 +1,57 @@
+#ifndef Z_RESOLUTIONCONTROLLER_H_
+#define Z_RESOLUTIONCONTROLLER_H_
+
+#include "Core.h"
+
+// Picks the scale of the internal render resolution, per axis, that keeps
+// the time of the scaled work near a target.  The time is taken to go
+// with the pixel count, so a frame over target drops the scale to what
+// would have fit right away, while a frame well under raises it one step
+// at a time and only after a while under, so it doesn't flicker between
+// two sizes.  Scales are multiples of STEP, few enough sizes for the
+// render targets to be kept around.
+class ResolutionController
+{
+public:
+  static const float STEP;
+  // Fraction of the target a raised scale is expected to stay under.
+  static const double HEADROOM;
+  // Frames timed too early to see a change of scale.
+  static const int SETTLE_FRAMES = 4;
+  // Frames a larger scale has to look affordable before it's taken.
+  static const int RAISE_FRAMES = 30;
+
+  ResolutionController(double milliseconds, float minScale = 0.5f,
+    float maxScale = 1.0f);
+  virtual ~ResolutionController() {}
+
+  // What the scaled work of a frame drawn not long ago took.
+  void Update(double milliseconds);
+
+  float GetScale() const
+  {
+    return scale_;
+  }
+
+  // Smoothed time of the last frames, in milliseconds.
+  double GetAverage() const
+  {
+    return average_;
+  }
+
+  double GetTarget() const
+  {
+    return target_;
+  }
+
+private:
+  double target_;
+  float min_;
+  float max_;
+  float scale_;
+  double average_;
+  int settle_;
+  int under_;
+};
+
+#endif
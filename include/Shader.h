@@ -12,11 +12,23 @@ public:
   {
 
   }
-  Shader(GLenum type, const char* source)
+  // defines, one "#define NAME value" per line, go right after the
+  // #version line, which GLSL wants first.
+  Shader(GLenum type, const char* source, const std::string& defines = "")
   {
     shader_ = glCreateShader(type);
-    const GLchar* buffer = reinterpret_cast<const GLchar*>(source);
-    glShaderSource(shader_,1,(const GLchar**)&(buffer),0);
+    const char* body = source;
+    std::string version;
+    if(!strncmp(source,"#version",8))
+    {
+      const char* end = strchr(source,'\n');
+      body = end ? end + 1 : source + strlen(source);
+      version.assign(source,body);
+      if(!end)
+        version += '\n';
+    }
+    const GLchar* buffers[3] = {version.c_str(),defines.c_str(),body};
+    glShaderSource(shader_,3,buffers,0);
     glCompileShader(shader_);
 
     GLint status;
@@ -38,12 +50,14 @@ public:
   {
     return shader_;
   }
-  static Shader CreateShaderFromFile(GLenum type, const char* filename)
+  static Shader CreateShaderFromFile(GLenum type, const char* filename,
+    const std::string& defines = "")
   {
     std::ifstream fi(filename,ios::binary);
-    return CreateShaderFromStream(type,fi);
+    return CreateShaderFromStream(type,fi,defines);
   }
-  static Shader CreateShaderFromStream(GLenum type, std::istream& inStream)
+  static Shader CreateShaderFromStream(GLenum type, std::istream& inStream,
+    const std::string& defines = "")
   {
     char* data;
     size_t size;
@@ -53,7 +67,9 @@ public:
     data = new char[size+1];
     inStream.read(data,size);
     data[size] = 0;
-    return Shader(type,data);
+    Shader shader(type,data,defines);
+    delete[] data;
+    return shader;
   }
 
 private:
@@ -5,6 +5,7 @@
 #include "GL/glew.h"
 #include "SDL2/SDL.h"
 #include "SDL2/SDL_image.h"
+#include "DDS.h"
 
 class Texture
 {
@@ -17,7 +18,7 @@ public:
     :texture_(texture)
   {
   }
-  Texture(int width,int height,GLenum format,void* data)
+  Texture(int width,int height,GLenum format,void* data,GLenum wrap = GL_REPEAT)
     :width_(width),height_(height)
   {
     glGenTextures(1,&texture_);
@@ -28,13 +29,13 @@ public:
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     wrap);
     //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
     //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
     glTexImage2D(
       GL_TEXTURE_2D, 0,           /* target, level of detail */
-      GL_RGBA,                    /* internal format */
+      GL_RGBA8,                   /* internal format */
       width, height, 0,           /* width, height, border */
       format, GL_UNSIGNED_BYTE,   /* external format, type */
       data                   /* pixels */
@@ -42,37 +43,113 @@ public:
     glGenerateMipmap(GL_TEXTURE_2D);
     //glBindTexture(GL_TEXTURE_2D,0);
   }
+  // Uploads the stored mip chain as is.  DXT data goes to the driver
+  // compressed when S3TC is available and is decoded on the CPU otherwise.
+  // With upload false only the name and sampling state are set up, for
+  // the levels to be uploaded later.
+  Texture(const DDSImage& image,GLenum wrap = GL_REPEAT,bool upload = true)
+    :width_(image.width),height_(image.height)
+  {
+    glGenTextures(1,&texture_);
 
-  GLuint GetTexture()
+    glBindTexture(GL_TEXTURE_2D,texture_);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+      image.levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     wrap);
+
+    if(upload)
+      UploadLevels(image);
+  }
+
+  // Replaces the storage of the bound texture with levels first.. of
+  // image, which become GL levels 0..  Returns the bytes now resident.
+  static size_t UploadLevels(const DDSImage& image,size_t first = 0)
   {
-    return texture_;
+    GLint levels = image.levels.size() - first;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,  levels - 1);
+
+    size_t bytes = 0;
+    std::vector<uint8_t> rgba;
+    for(GLint i=0;i!=levels;i++)
+    {
+      const uint8_t* pixels = &image.data[image.levels[first+i].offset];
+      if(!UploadsNative(image))
+      {
+        rgba.resize(LevelUploadSize(image,first+i));
+        StageLevel(image,first+i,rgba.data());
+        pixels = rgba.data();
+      }
+      bytes += UploadLevel(image,first+i,i,pixels);
+    }
+    return bytes;
   }
 
-  void Bind()
+  // True when the driver takes the stored format directly, otherwise
+  // levels go up as RGBA8 decoded by StageLevel.
+  static bool UploadsNative(const DDSImage& image)
   {
-    glBindTexture(GL_TEXTURE_2D,texture_);
+    return !image.compressed() || GLEW_EXT_texture_compression_s3tc;
+  }
+
+  // Bytes UploadLevel reads for a level.
+  static size_t LevelUploadSize(const DDSImage& image,size_t level)
+  {
+    const DDSLevel& l = image.levels[level];
+    return UploadsNative(image) ? l.size : l.width*l.height*4;
   }
 
-  static Texture CreateTextureFromFile(const char* filename)
+  // Writes LevelUploadSize bytes ready for UploadLevel to dst.
+  static void StageLevel(const DDSImage& image,size_t level,uint8_t* dst)
   {
-    SDL_Surface* sf = IMG_Load(filename);
-    if(!sf)
-      return Texture();
-    GLenum format = GL_RGBA;
-    if(sf->format->BytesPerPixel == 4)
+    if(UploadsNative(image))
+      memcpy(dst,&image.data[image.levels[level].offset],image.levels[level].size);
+    else
+      decode_dds_level(image,level,dst);
+  }
+
+  // Specifies GL level glLevel of the bound texture from staged pixels,
+  // which may be an offset into a bound GL_PIXEL_UNPACK_BUFFER.
+  static size_t UploadLevel(const DDSImage& image,size_t level,GLint glLevel,
+    const GLvoid* pixels)
+  {
+    const DDSLevel& l = image.levels[level];
+    if(image.compressed() && UploadsNative(image))
     {
-      if(sf->format->Rmask != 0x000000ff)
-        format = GL_BGRA;
-    } else {
-      if(sf->format->Rmask == 0x000000ff)
-        format = GL_RGB;
-      else
-        format = GL_BGR;
+      GLenum internal = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+      if(image.format == DDS_DXT3)
+        internal = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+      else if(image.format == DDS_DXT5)
+        internal = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+      glCompressedTexImage2D(
+        GL_TEXTURE_2D, glLevel, internal,
+        l.width, l.height, 0,
+        l.size, pixels
+      );
+      return l.size;
     }
-    Texture tex = Texture(sf->w,sf->h,format,sf->pixels);
-    //std::cerr << "Load Texture: " << filename << " " << tex.GetTexture() << std::endl;
-    SDL_FreeSurface(sf);
-    return tex;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(
+      GL_TEXTURE_2D, glLevel, GL_RGBA8,
+      l.width, l.height, 0,
+      GL_RGBA, GL_UNSIGNED_BYTE, pixels
+    );
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return l.width*l.height*4;
+  }
+
+  GLuint GetTexture()
+  {
+    return texture_;
+  }
+
+  void Bind()
+  {
+    glBindTexture(GL_TEXTURE_2D,texture_);
   }
 
 private:
@@ -0,0 +1,53 @@
+#ifndef Z_TEXTURECOMPRESSOR_H_
+#define Z_TEXTURECOMPRESSOR_H_
+
+#include "Core.h"
+#include "DDS.h"
+
+//	BC1 (DXT1) / BC3 (DXT5) block compressor
+//	Opaque images become BC1, anything with alpha BC3.  Every mip level is
+//	compressed, block rows are spread over all hardware threads.
+
+// rgba is 16 pixels, row major, 4 bytes each.
+void compress_bc1_block(const uint8_t* rgba, uint8_t* block);
+void compress_bc3_block(const uint8_t* rgba, uint8_t* block);
+
+// Box filter one RGBA8 level down to max(1,w/2) x max(1,h/2).
+void downsample_rgba(const uint8_t* src, uint32_t width, uint32_t height,
+	uint8_t* dst);
+
+// Full mip chain of a tightly packed RGBA8 image, as a DDS_RGBA8 image.
+void build_mip_chain(const uint8_t* rgba, uint32_t width, uint32_t height,
+	DDSImage& image);
+
+// Build the full mip chain of a tightly packed RGBA8 image and compress it.
+void compress_image(const uint8_t* rgba, uint32_t width, uint32_t height,
+	DDSImage& image);
+
+// Decode any image SDL_image understands to tightly packed RGBA8.
+bool load_rgba(const char* filename, vector<uint8_t>& rgba,
+	uint32_t& width, uint32_t& height);
+
+// DDS files as stored, anything else decoded with a generated mip chain.
+// Generated chains are kept in the mip cache when one is set.
+bool load_image(const char* filename, DDSImage& image);
+
+// Levels first.. of what load_image gives, rebased so first becomes level
+// 0.  DDS files and cached chains are read from first on, anything else
+// is decoded whole and sliced.
+bool load_image_levels(const char* filename, size_t first, DDSImage& image);
+
+// The same from the first level whose largest side is at most max_size,
+// for when only a mip tail is wanted.  first is set to that level, size to
+// the largest side of level 0.
+bool load_image_tail(const char* filename, uint32_t max_size,
+	DDSImage& image, size_t& first, uint32_t& size);
+
+// Directory for generated mip chains, stored as RGBA8 DDS files named by
+// a hash of the source file's bytes.  Empty (the default) disables it.
+void set_mip_cache(const string& directory);
+
+// Load any image SDL_image understands and write it out as a DDS.
+bool compress_file(const char* src, const char* dst);
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef Z_TEXTURESTREAMER_H_
+#define Z_TEXTURESTREAMER_H_
+
+#include "Core.h"
+#include "GL/glew.h"
+#include "DDS.h"
+#include "Texture.h"
+#include "JobSystem.h"
+
+// Keeps every texture resident at a small mip and streams finer levels in
+// on the job system as the renderer asks for them.  Level 0 of the GL
+// texture is always the finest resident level, so streaming in or evicting
+// re-specifies the storage of the same texture name and nothing that holds
+// on to the Texture has to change.
+class TextureStreamer
+{
+public:
+  TextureStreamer(size_t budget = 256 << 20, uint32_t tailSize = 64);
+  virtual ~TextureStreamer();
+
+  // Reads and uploads only the tail of the mip chain whose largest side is
+  // at most tailSize.  Returns an empty Texture if the file can't be read.
+  Texture Load(const string& filename, GLenum wrap);
+
+  // The same for a tail already read with load_image_tail, first and size
+  // as it set them.  tail is emptied, streaming reads filename again for
+  // finer levels.
+  Texture Load(const string& filename, DDSImage& tail, size_t first,
+    uint32_t size, GLenum wrap);
+
+  // Deletes a texture from Load and forgets it.
+  void Release(GLuint texture);
+
+  // Ask for enough resolution that uvExtent of the texture covers the
+  // given number of screen pixels.  Requests are collected until Update.
+  void Request(GLuint texture, float uvExtent, float pixels);
+
+  // Once per frame on the GL thread: starts loads for textures that need
+  // more than they have, uploads finished ones and evicts least recently
+  // used textures back to their tail when over budget.
+  void Update();
+
+  // Nothing being read.
+  bool Idle() const
+  {
+    return reads_.Done();
+  }
+
+  size_t GetResidentBytes() const
+  {
+    return resident_;
+  }
+
+  size_t GetBudget() const
+  {
+    return budget_;
+  }
+
+  uint32_t GetTailSize() const
+  {
+    return tailSize_;
+  }
+
+private:
+  struct Entry
+  {
+    string filename;
+    GLuint texture;
+    uint32_t size;      // largest side of level 0
+    int tail;           // first level of the always resident tail
+    int resident;       // finest level on the GPU
+    int wanted;         // finest level asked for since the last Update
+    bool pending;
+    uint32_t used;      // frame of the last request
+    size_t bytes;
+    size_t tailBytes;   // bytes with only the tail resident
+    int refused;        // finest level MakeRoom had no room for, or -1
+    size_t refusedBytes;
+    DDSImage coarse;    // the tail, kept to evict without touching disk
+  };
+
+  struct Job
+  {
+    size_t entry;
+    int level;
+    string filename;
+    bool ok;
+    DDSImage image;     // levels level.. of the file
+  };
+
+  bool MakeRoom(size_t bytes, size_t keep);
+  void Evict(Entry& entry);
+  void Read(Job& job);
+
+  vector<Entry> entries_;
+  unordered_map<GLuint,size_t> lookup_;
+  // Released entries to reuse, none with a read in flight.
+  vector<size_t> free_;
+
+  size_t budget_;
+  size_t resident_;
+  uint32_t tailSize_;
+  uint32_t frame_;
+
+  JobCounter reads_;
+  std::mutex mutex_;
+  vector<Job> done_;
+};
+
+#endif
@@ -18,6 +18,11 @@ public:
 	{
 		return SDL_GetTicks()/1000.0f;
 	}
+	// Sub-millisecond resolution, for timing work within a frame.
+	static double GetPreciseTimeInSeconds()
+	{
+		return SDL_GetPerformanceCounter()/(double)SDL_GetPerformanceFrequency();
+	}
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef Z_TRACE_H_
+#define Z_TRACE_H_
+
+#include "Core.h"
+
+// Scoped timing zones for chrome://tracing and Perfetto.  Every thread
+// records into a ring buffer of its own, so a zone costs two clock reads
+// and an uncontended lock, and only the newest zones of each thread are
+// kept.  Dump writes what is there as Chrome trace JSON, one track per
+// thread.
+//
+//	void load()
+//	{
+//	  TRACE_ZONE("load");
+//	  ...
+//	}
+//
+// Zone names have to be string literals, only the pointer is stored.
+// Building with -DZ_TRACE=0 compiles the zones out.
+
+#ifndef Z_TRACE
+  #define Z_TRACE 1
+#endif
+
+class Trace
+{
+public:
+  // Zones kept per thread.
+  static const size_t BUFFER_EVENTS = 1 << 14;
+
+  // Nanoseconds since the first call.
+  static uint64_t Now();
+
+  static void Record(const char* name, uint64_t begin, uint64_t end);
+
+  // Name of the calling thread's track, copied.
+  static void SetThreadName(const char* name);
+
+  // Zones are recorded from the start.  Turning it off keeps what is in
+  // the buffers.
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled();
+
+  // Writes the buffered zones of every thread that recorded any, returns
+  // false if the file can't be written.
+  static bool Dump(const char* filename);
+};
+
+class TraceZone
+{
+public:
+  TraceZone(const char* name)
+    :name_(name),begin_(Trace::Now())
+  {
+  }
+
+  ~TraceZone()
+  {
+    Trace::Record(name_,begin_,Trace::Now());
+  }
+
+private:
+  const char* name_;
+  uint64_t begin_;
+};
+
+#if Z_TRACE
+  #define Z_TRACE_CONCAT_(a,b) a##b
+  #define Z_TRACE_CONCAT(a,b) Z_TRACE_CONCAT_(a,b)
+  #define TRACE_ZONE(name) TraceZone Z_TRACE_CONCAT(traceZone,__LINE__)(name)
+  #define TRACE_THREAD(name) Trace::SetThreadName(name)
+#else
+  #define TRACE_ZONE(name)
+  #define TRACE_THREAD(name)
+#endif
+
+#endif
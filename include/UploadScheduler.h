@@ -0,0 +1,113 @@
+#ifndef Z_UPLOADSCHEDULER_H_
+#define Z_UPLOADSCHEDULER_H_
+
+#include "Core.h"
+#include "GL/glew.h"
+#include "DDS.h"
+
+// Spreads buffer and texture uploads over frames.  Every Update copies
+// queued data into a staging buffer until the per-frame time or byte
+// budget is spent and then has the GL copy it out of there, so a map can
+// be loaded while the viewer keeps drawing.
+//
+// Staging is a persistently mapped ring guarded by fences when
+// ARB_buffer_storage is there, an orphaned pixel buffer mapped once per
+// frame otherwise, and plain client memory uploads without PBOs.
+class UploadScheduler
+{
+public:
+  UploadScheduler(double milliseconds = 2.0, size_t bytes = 8 << 20,
+    size_t stagingSize = 32 << 20);
+  virtual ~UploadScheduler();
+
+  // Creates a buffer of size bytes now and fills it from data over the
+  // next frames.  data has to stay valid until done is called.
+  GLuint QueueBuffer(GLenum target, const void* data, size_t size,
+    std::function<void()> done = std::function<void()>());
+
+  // Uploads levels first.. of image into a texture that has no storage
+  // yet, coarsest level first.  GL_TEXTURE_BASE_LEVEL follows the finest
+  // level uploaded so far, so the texture can be drawn with meanwhile.
+  void QueueTexture(GLuint texture, std::shared_ptr<DDSImage> image,
+    size_t first = 0, std::function<void()> done = std::function<void()>());
+
+  // Once per frame on the GL thread.
+  void Update();
+
+  void SetBudget(double milliseconds, size_t bytes)
+  {
+    milliseconds_ = milliseconds;
+    bytes_ = bytes;
+  }
+
+  bool Idle() const
+  {
+    return jobs_.empty();
+  }
+
+  size_t GetPendingBytes() const
+  {
+    return pending_;
+  }
+
+private:
+  enum Staging
+  {
+    STAGING_NONE,
+    STAGING_PBO,
+    STAGING_PERSISTENT
+  };
+
+  struct Job
+  {
+    GLuint name;
+    GLenum target;
+    bool texture;
+    const uint8_t* data;               // buffer jobs
+    size_t size;
+    size_t next;                       // next byte, or level counting down
+    std::shared_ptr<DDSImage> image;   // texture jobs
+    size_t first;
+    std::function<void()> done;
+  };
+
+  // One chunk of a job, read from the staging buffer at offset or from
+  // source when it could not be staged.
+  struct Op
+  {
+    Job* job;
+    size_t target;                     // byte offset or level
+    size_t size;
+    size_t offset;
+    const uint8_t* source;
+    vector<uint8_t> scratch;
+  };
+
+  struct Frame
+  {
+    GLsync fence;
+    size_t bytes;
+  };
+
+  static bool Finished(const Job& job);
+  bool Allocate(size_t size, size_t& offset);
+  void Retire();
+  void Issue(Op& op);
+
+  double milliseconds_;
+  size_t bytes_;
+
+  Staging staging_;
+  GLuint buffer_;
+  size_t size_;
+  uint8_t* mapped_;
+  size_t head_;
+  size_t inflight_;
+  size_t frameBytes_;
+  deque<Frame> frames_;
+
+  deque<Job> jobs_;
+  size_t pending_;
+};
+
+#endif
@@ -53,6 +53,13 @@ public:
     return SDL_PollEvent(&e);
   }
 
+  // Sleeps until an event is queued or milliseconds pass, leaving the
+  // event for PollEvent.
+  int WaitEvent(int milliseconds)
+  {
+    return SDL_WaitEventTimeout(0, milliseconds);
+  }
+
   int GetWidth()
   {
     return width_;
@@ -0,0 +1,21 @@
+#include "CPU.h"
+
+bool cpu_supports(CPUFeature feature)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	// Kernels are picked from static initializers, which may run before
+	// libgcc's own has filled in the feature bits.  Calling it again is
+	// cheap.
+	__builtin_cpu_init();
+	switch(feature)
+	{
+	case CPU_SSSE3:
+		return __builtin_cpu_supports("ssse3");
+	case CPU_AVX:
+		return __builtin_cpu_supports("avx");
+	case CPU_AVX2:
+		return __builtin_cpu_supports("avx2");
+	}
+#endif
+	return false;
+}
@@ -0,0 +1,282 @@
+#include "ChunkStreamer.h"
+#include "Trace.h"
+#include "MemoryTracker.h"
+
+// Cells on either side of the grid at most.
+static const int MAX_CELLS = 256;
+
+ChunkStreamer::ChunkStreamer(const LOLMap* map, const Vector3Streamf& centers,
+  const Vector3Streamf& extents, UploadScheduler* uploads, float radius,
+  size_t budget, float cellSize)
+  :map_(map),uploads_(uploads),radius_(radius),budget_(budget),resident_(0),
+   pending_(0)
+{
+  TRACE_ZONE("ChunkStreamer::ChunkStreamer");
+  MemoryTagScope tag(MEMORY_RENDERER);
+
+  Buffer empty = {0,0,0};
+  vertexBuffers_.resize(map->num_vertex_list,empty);
+  indexBuffers_.resize(map->num_index_list,empty);
+  modelCells_.resize(map->num_model);
+  if(!map->num_model)
+    return;
+
+  // The box of every model, of the whole map and of every chunk.
+  const float big = FLT_MAX;
+  Vector3f lo(big,big,big), hi(-big,-big,-big);
+  vector<Vector3f> chunkMin(map->num_material,lo);
+  vector<Vector3f> chunkMax(map->num_material,hi);
+  for(uint32_t m=0;m!=map->num_model;m++)
+  {
+    Vector3f c = centers.Get(m), e = extents.Get(m);
+    uint32_t material = map->models[m].material;
+    bool chunk = strstr(map->materials[material].name,"_chunk_") != 0;
+    for(int k=0;k!=3;k++)
+    {
+      lo[k] = min(lo[k],c[k] - e[k]);
+      hi[k] = max(hi[k],c[k] + e[k]);
+      if(chunk)
+      {
+        chunkMin[material][k] = min(chunkMin[material][k],c[k] - e[k]);
+        chunkMax[material][k] = max(chunkMax[material][k],c[k] + e[k]);
+      }
+    }
+  }
+
+  if(cellSize <= 0)
+  {
+    vector<float> sizes;
+    for(uint32_t i=0;i!=map->num_material;i++)
+      if(chunkMin[i].x <= chunkMax[i].x)
+        sizes.push_back(max(chunkMax[i].x - chunkMin[i].x,
+          chunkMax[i].z - chunkMin[i].z));
+    if(!sizes.empty())
+    {
+      nth_element(sizes.begin(),sizes.begin() + sizes.size()/2,sizes.end());
+      cellSize = sizes[sizes.size()/2];
+    } else {
+      cellSize = max(hi.x - lo.x,hi.z - lo.z) / 8;
+    }
+  }
+  cellSize = max(cellSize,max(hi.x - lo.x,hi.z - lo.z) / MAX_CELLS);
+  cellSize = max(cellSize,1.0f);
+  int nx = max((int)ceil((hi.x - lo.x) / cellSize),1);
+  int nz = max((int)ceil((hi.z - lo.z) / cellSize),1);
+
+  vector<int> grid(nx*nz,-1);
+  for(uint32_t m=0;m!=map->num_model;m++)
+  {
+    uint32_t material = map->models[m].material;
+    Vector3f c = centers.Get(m), e = extents.Get(m);
+    Vector3f key = c;
+    if(chunkMin[material].x <= chunkMax[material].x)
+      key = (chunkMin[material] + chunkMax[material]) * 0.5f;
+    int x = min(max((int)((key.x - lo.x) / cellSize),0),nx - 1);
+    int z = min(max((int)((key.z - lo.z) / cellSize),0),nz - 1);
+
+    int& index = grid[x + z*nx];
+    if(index < 0)
+    {
+      index = (int)cells_.size();
+      Cell cell;
+      cell.min = Vector3f(big,big,big);
+      cell.max = Vector3f(-big,-big,-big);
+      cell.resident = false;
+      cell.distance = 0;
+      cells_.push_back(cell);
+    }
+    Cell& cell = cells_[index];
+    for(int k=0;k!=3;k++)
+    {
+      cell.min[k] = min(cell.min[k],c[k] - e[k]);
+      cell.max[k] = max(cell.max[k],c[k] + e[k]);
+    }
+    cell.vertexLists.push_back(map->models[m].model[0].vertex_index);
+    cell.indexLists.push_back(map->models[m].model[0].index_index);
+    modelCells_[m] = index;
+  }
+
+  for(size_t i=0;i!=cells_.size();i++)
+  {
+    Cell& cell = cells_[i];
+    sort(cell.vertexLists.begin(),cell.vertexLists.end());
+    cell.vertexLists.erase(unique(cell.vertexLists.begin(),
+      cell.vertexLists.end()),cell.vertexLists.end());
+    sort(cell.indexLists.begin(),cell.indexLists.end());
+    cell.indexLists.erase(unique(cell.indexLists.begin(),
+      cell.indexLists.end()),cell.indexLists.end());
+    order_.push_back((uint32_t)i);
+  }
+
+  cout << "Chunks: " << cells_.size() << " cells of " << cellSize << endl;
+}
+
+ChunkStreamer::~ChunkStreamer()
+{
+  for(size_t i=0;i!=vertexBuffers_.size();i++)
+    if(vertexBuffers_[i].name)
+      glDeleteBuffers(1,&vertexBuffers_[i].name);
+  for(size_t i=0;i!=indexBuffers_.size();i++)
+    if(indexBuffers_[i].name)
+      glDeleteBuffers(1,&indexBuffers_[i].name);
+}
+
+void ChunkStreamer::Update(const Vector3f& eye)
+{
+  TRACE_ZONE("ChunkStreamer::Update");
+  MemoryTagScope tag(MEMORY_RENDERER);
+
+  for(size_t i=0;i!=cells_.size();i++)
+  {
+    Cell& cell = cells_[i];
+    Vector3f d;
+    for(int k=0;k!=3;k++)
+      d[k] = max(max(cell.min[k] - eye[k],eye[k] - cell.max[k]),0.0f);
+    cell.distance = d.Length();
+  }
+  sort(order_.begin(),order_.end(),[this](uint32_t a, uint32_t b)
+  {
+    return cells_[a].distance < cells_[b].distance;
+  });
+
+  // Nearest first, making room from the far end.  A cell that doesn't fit
+  // stops the rest, the farther ones would only evict it again.
+  size_t far = order_.size();
+  for(size_t i=0;i!=order_.size();i++)
+  {
+    Cell& cell = cells_[order_[i]];
+    if(cell.distance > radius_)
+      break;
+    if(cell.resident)
+      continue;
+
+    // Releasing a victim that shares a list with cell adds to what cell
+    // is missing, so that is counted again after every release.
+    while(resident_ + Missing(cell) > budget_ && far > i + 1)
+    {
+      Cell& victim = cells_[order_[--far]];
+      if(victim.resident && !Pending(victim))
+        Release(victim);
+    }
+    if(resident_ + Missing(cell) > budget_)
+      break;
+    Acquire(cell);
+  }
+
+  // Still over, the budget changed or uploads held on to some cells.
+  for(size_t i=order_.size();i-- && resident_ > budget_;)
+  {
+    Cell& cell = cells_[order_[i]];
+    if(cell.distance <= radius_)
+      break;
+    if(cell.resident && !Pending(cell))
+      Release(cell);
+  }
+}
+
+bool ChunkStreamer::IsReady(uint32_t model) const
+{
+  const LOLMapModelData& data = map_->models[model].model[0];
+  return cells_[modelCells_[model]].resident &&
+    !vertexBuffers_[data.vertex_index].pending &&
+    !indexBuffers_[data.index_index].pending;
+}
+
+size_t ChunkStreamer::GetResidentCells() const
+{
+  size_t count = 0;
+  for(size_t i=0;i!=cells_.size();i++)
+    count += cells_[i].resident;
+  return count;
+}
+
+size_t ChunkStreamer::Missing(const Cell& cell) const
+{
+  size_t bytes = 0;
+  for(size_t i=0;i!=cell.vertexLists.size();i++)
+    if(!vertexBuffers_[cell.vertexLists[i]].refs)
+      bytes += map_->vertex_lists[cell.vertexLists[i]].size;
+  for(size_t i=0;i!=cell.indexLists.size();i++)
+    if(!indexBuffers_[cell.indexLists[i]].refs)
+      bytes += map_->index_lists[cell.indexLists[i]].size;
+  return bytes;
+}
+
+bool ChunkStreamer::Pending(const Cell& cell) const
+{
+  for(size_t i=0;i!=cell.vertexLists.size();i++)
+    if(vertexBuffers_[cell.vertexLists[i]].pending)
+      return true;
+  for(size_t i=0;i!=cell.indexLists.size();i++)
+    if(indexBuffers_[cell.indexLists[i]].pending)
+      return true;
+  return false;
+}
+
+void ChunkStreamer::Acquire(Cell& cell)
+{
+  for(size_t i=0;i!=cell.vertexLists.size();i++)
+  {
+    const LOLMapVertexList& list = map_->vertex_lists[cell.vertexLists[i]];
+    AddRef(vertexBuffers_,cell.vertexLists[i],GL_ARRAY_BUFFER,
+      list.vertices,list.size);
+  }
+  for(size_t i=0;i!=cell.indexLists.size();i++)
+  {
+    const LOLMapIndexList& list = map_->index_lists[cell.indexLists[i]];
+    AddRef(indexBuffers_,cell.indexLists[i],GL_ELEMENT_ARRAY_BUFFER,
+      list.indices,list.size);
+  }
+  cell.resident = true;
+}
+
+void ChunkStreamer::Release(Cell& cell)
+{
+  for(size_t i=0;i!=cell.vertexLists.size();i++)
+    RemoveRef(vertexBuffers_,cell.vertexLists[i],
+      map_->vertex_lists[cell.vertexLists[i]].size);
+  for(size_t i=0;i!=cell.indexLists.size();i++)
+    RemoveRef(indexBuffers_,cell.indexLists[i],
+      map_->index_lists[cell.indexLists[i]].size);
+  cell.resident = false;
+}
+
+void ChunkStreamer::AddRef(vector<Buffer>& buffers, uint32_t list,
+  GLenum target, const void* data, size_t size)
+{
+  Buffer& buffer = buffers[list];
+  if(buffer.refs++)
+    return;
+
+  resident_ += size;
+  if(uploads_)
+  {
+    // buffers is never resized after construction.
+    Buffer* uploading = &buffer;
+    uploading->pending = 1;
+    pending_++;
+    buffer.name = uploads_->QueueBuffer(target,data,size,
+      [this,uploading]()
+    {
+      uploading->pending = 0;
+      pending_--;
+    });
+    return;
+  }
+  glGenBuffers(1,&buffer.name);
+  glBindBuffer(target,buffer.name);
+  glBufferData(target,size,data,GL_STATIC_DRAW);
+  glBindBuffer(target,0);
+}
+
+void ChunkStreamer::RemoveRef(vector<Buffer>& buffers, uint32_t list,
+  size_t size)
+{
+  Buffer& buffer = buffers[list];
+  if(--buffer.refs)
+    return;
+
+  resident_ -= size;
+  glDeleteBuffers(1,&buffer.name);
+  buffer.name = 0;
+}
@@ -0,0 +1,544 @@
+#include "DDS.h"
+#include "Trace.h"
+#include <fstream>
+using namespace std;
+
+#define DDS_MAGIC 0x20534444 // "DDS "
+
+#define DDSD_CAPS 0x00000001
+#define DDSD_HEIGHT 0x00000002
+#define DDSD_WIDTH 0x00000004
+#define DDSD_PIXELFORMAT 0x00001000
+#define DDSD_MIPMAPCOUNT 0x00020000
+#define DDSD_LINEARSIZE 0x00080000
+
+#define DDSCAPS_COMPLEX 0x00000008
+#define DDSCAPS_TEXTURE 0x00001000
+#define DDSCAPS_MIPMAP 0x00400000
+
+#define DDPF_ALPHAPIXELS 0x00000001
+#define DDPF_FOURCC 0x00000004
+#define DDPF_RGB 0x00000040
+
+#define FOURCC(a,b,c,d) \
+	((uint32_t)(a) | ((uint32_t)(b) << 8) | \
+	((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+uint32_t dds_level_size(DDSFormat format, uint32_t width, uint32_t height)
+{
+	switch(format)
+	{
+	case DDS_DXT1:
+		return max(1u,(width+3)/4) * max(1u,(height+3)/4) * 8;
+	case DDS_DXT3:
+	case DDS_DXT5:
+		return max(1u,(width+3)/4) * max(1u,(height+3)/4) * 16;
+	case DDS_RGBA8:
+		return width * height * 4;
+	default:
+		return 0;
+	}
+}
+
+static int mask_shift(uint32_t mask)
+{
+	if(!mask)
+		return 0;
+	int shift = 0;
+	while(!(mask & 1))
+	{
+		mask >>= 1;
+		shift++;
+	}
+	return shift;
+}
+
+// Largest side accepted, keeps every level size and offset well inside
+// 32 bits.
+static const uint32_t MAX_DIMENSION = 16384;
+
+// Reads and checks the header, then lays out the levels the rest of the
+// file holds: format, size and levels of image are set, data is left
+// alone.  Offsets are from the end of the header, where dds is left.
+// Levels past the end of the file are dropped.
+static bool read_header(ifstream& dds, DDSImage& image, DDSPixelFormat& pf)
+{
+	uint32_t magic;
+	DDSHeader header;
+	dds.read((char*)&magic,sizeof(magic));
+	dds.read((char*)&header,sizeof(header));
+	if(!dds || magic != DDS_MAGIC || header.size != sizeof(DDSHeader))
+		return false;
+
+	pf = header.pixel_format;
+	if(pf.flags & DDPF_FOURCC)
+	{
+		if(pf.fourcc == FOURCC('D','X','T','1'))
+			image.format = DDS_DXT1;
+		else if(pf.fourcc == FOURCC('D','X','T','3'))
+			image.format = DDS_DXT3;
+		else if(pf.fourcc == FOURCC('D','X','T','5'))
+			image.format = DDS_DXT5;
+		else
+			return false;
+	}
+	else if((pf.flags & DDPF_RGB) && pf.rgb_bit_count == 32)
+	{
+		image.format = DDS_RGBA8;
+	}
+	else
+	{
+		return false;
+	}
+
+	if(!header.width || !header.height ||
+		header.width > MAX_DIMENSION || header.height > MAX_DIMENSION)
+		return false;
+	image.width = header.width;
+	image.height = header.height;
+
+	// Whatever is left in the file is the mip chain, largest level first.
+	streampos start = dds.tellg();
+	dds.seekg(0,ios::end);
+	uint64_t remain = (uint64_t)(dds.tellg() - start);
+	dds.seekg(start);
+
+	// No chain is longer than it takes to get to 1x1.
+	uint32_t count = 1;
+	if((header.flags & DDSD_MIPMAPCOUNT) && header.mip_map_count)
+		count = min(header.mip_map_count,32u);
+
+	image.levels.clear();
+	uint32_t offset = 0;
+	uint32_t w = image.width, h = image.height;
+	for(uint32_t i=0;i!=count;i++)
+	{
+		DDSLevel level;
+		level.width = w;
+		level.height = h;
+		level.offset = offset;
+		level.size = dds_level_size(image.format,w,h);
+		if((uint64_t)offset + level.size > remain)
+			break;
+		image.levels.push_back(level);
+		offset += level.size;
+		if(w == 1 && h == 1)
+			break;
+		w = max(1u,w/2);
+		h = max(1u,h/2);
+	}
+	return !image.levels.empty();
+}
+
+// Reads levels first.. from dds, left after the header, into image.data
+// rebased to first, and swizzles RGBA8 data to RGBA.
+static bool read_levels(ifstream& dds, const DDSPixelFormat& pf, size_t first,
+	DDSImage& image)
+{
+	if(first >= image.levels.size())
+		return false;
+
+	const DDSLevel& base = image.levels[first];
+	const DDSLevel& last = image.levels.back();
+	uint32_t size = last.offset + last.size - base.offset;
+	dds.seekg(base.offset,ios::cur);
+	image.data.resize(size);
+	dds.read((char*)image.data.data(),size);
+	if(!dds)
+		return false;
+
+	if(first)
+	{
+		image.width = base.width;
+		image.height = base.height;
+		image.levels.erase(image.levels.begin(),image.levels.begin()+first);
+		uint32_t offset = image.levels[0].offset;
+		for(size_t i=0;i!=image.levels.size();i++)
+			image.levels[i].offset -= offset;
+	}
+
+	if(image.format == DDS_RGBA8)
+	{
+		// Arbitrary channel masks, normally BGRA.  Swizzle once here so
+		// the uploader only ever sees RGBA.
+		int rs = mask_shift(pf.r_mask);
+		int gs = mask_shift(pf.g_mask);
+		int bs = mask_shift(pf.b_mask);
+		int as = mask_shift(pf.a_mask);
+		bool alpha = (pf.flags & DDPF_ALPHAPIXELS) && pf.a_mask;
+		uint32_t* px = (uint32_t*)image.data.data();
+		for(size_t i=0;i!=size/4;i++)
+		{
+			uint32_t c = px[i];
+			uint8_t* out = (uint8_t*)&px[i];
+			out[0] = (c & pf.r_mask) >> rs;
+			out[1] = (c & pf.g_mask) >> gs;
+			out[2] = (c & pf.b_mask) >> bs;
+			out[3] = alpha ? (c & pf.a_mask) >> as : 255;
+		}
+	}
+
+	return true;
+}
+
+bool read_dds(const char* filename, DDSImage& image)
+{
+	TRACE_ZONE("read_dds");
+	ifstream dds(filename,ios::binary);
+	if(!dds)
+		return false;
+
+	DDSPixelFormat pf;
+	return read_header(dds,image,pf) && read_levels(dds,pf,0,image);
+}
+
+bool read_dds_header(const char* filename, DDSImage& image)
+{
+	ifstream dds(filename,ios::binary);
+	if(!dds)
+		return false;
+
+	DDSPixelFormat pf;
+	image.data.clear();
+	return read_header(dds,image,pf);
+}
+
+bool read_dds_levels(const char* filename, size_t first, DDSImage& image)
+{
+	TRACE_ZONE("read_dds_levels");
+	ifstream dds(filename,ios::binary);
+	if(!dds)
+		return false;
+
+	DDSPixelFormat pf;
+	return read_header(dds,image,pf) && read_levels(dds,pf,first,image);
+}
+
+bool write_dds(const char* filename, const DDSImage& image)
+{
+	if(image.levels.empty())
+		return false;
+
+	ofstream dds(filename,ios::binary);
+	if(!dds)
+		return false;
+
+	DDSHeader header;
+	memset(&header,0,sizeof(header));
+	header.size = sizeof(DDSHeader);
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT |
+		DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.width = image.width;
+	header.height = image.height;
+	header.pitch_or_linear_size = image.levels[0].size;
+	header.mip_map_count = image.levels.size();
+	header.caps = DDSCAPS_TEXTURE;
+	if(image.levels.size() > 1)
+		header.caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+
+	DDSPixelFormat& pf = header.pixel_format;
+	pf.size = sizeof(DDSPixelFormat);
+	switch(image.format)
+	{
+	case DDS_DXT1:
+		pf.flags = DDPF_FOURCC;
+		pf.fourcc = FOURCC('D','X','T','1');
+		break;
+	case DDS_DXT3:
+		pf.flags = DDPF_FOURCC;
+		pf.fourcc = FOURCC('D','X','T','3');
+		break;
+	case DDS_DXT5:
+		pf.flags = DDPF_FOURCC;
+		pf.fourcc = FOURCC('D','X','T','5');
+		break;
+	case DDS_RGBA8:
+		pf.flags = DDPF_RGB | DDPF_ALPHAPIXELS;
+		pf.rgb_bit_count = 32;
+		pf.r_mask = 0x000000ff;
+		pf.g_mask = 0x0000ff00;
+		pf.b_mask = 0x00ff0000;
+		pf.a_mask = 0xff000000;
+		break;
+	default:
+		return false;
+	}
+
+	uint32_t magic = DDS_MAGIC;
+	dds.write((const char*)&magic,sizeof(magic));
+	dds.write((const char*)&header,sizeof(header));
+	for(size_t i=0;i!=image.levels.size();i++)
+	{
+		const DDSLevel& level = image.levels[i];
+		dds.write((const char*)&image.data[level.offset],level.size);
+	}
+	return (bool)dds;
+}
+
+void slice_dds(const DDSImage& image, size_t first, DDSImage& out)
+{
+	const DDSLevel& base = image.levels[first];
+	out.format = image.format;
+	out.width = base.width;
+	out.height = base.height;
+	out.levels.assign(image.levels.begin()+first,image.levels.end());
+	for(size_t i=0;i!=out.levels.size();i++)
+		out.levels[i].offset -= base.offset;
+	out.data.assign(image.data.begin()+base.offset,image.data.end());
+}
+
+static void expand_565(uint16_t c, uint8_t* out)
+{
+	uint32_t r = (c >> 11) & 31;
+	uint32_t g = (c >> 5) & 63;
+	uint32_t b = c & 31;
+	out[0] = (r << 3) | (r >> 2);
+	out[1] = (g << 2) | (g >> 4);
+	out[2] = (b << 3) | (b >> 2);
+	out[3] = 255;
+}
+
+// Color part shared by all three formats.  Only DXT1 may use the three
+// color plus transparent mode.
+static void decode_color_block(const uint8_t* block, uint8_t pixels[16][4],
+	bool dxt1)
+{
+	uint16_t c0 = block[0] | (block[1] << 8);
+	uint16_t c1 = block[2] | (block[3] << 8);
+	uint32_t bits = block[4] | (block[5] << 8) | (block[6] << 16) |
+		((uint32_t)block[7] << 24);
+
+	uint8_t palette[4][4];
+	expand_565(c0,palette[0]);
+	expand_565(c1,palette[1]);
+	if(!dxt1 || c0 > c1)
+	{
+		for(int k=0;k!=3;k++)
+		{
+			palette[2][k] = (2*palette[0][k] + palette[1][k]) / 3;
+			palette[3][k] = (palette[0][k] + 2*palette[1][k]) / 3;
+		}
+		palette[2][3] = 255;
+		palette[3][3] = 255;
+	}
+	else
+	{
+		for(int k=0;k!=3;k++)
+		{
+			palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+			palette[3][k] = 0;
+		}
+		palette[2][3] = 255;
+		palette[3][3] = 0;
+	}
+
+	for(int i=0;i!=16;i++)
+	{
+		memcpy(pixels[i],palette[bits & 3],4);
+		bits >>= 2;
+	}
+}
+
+static void decode_dxt3_alpha(const uint8_t* block, uint8_t pixels[16][4])
+{
+	for(int i=0;i!=8;i++)
+	{
+		pixels[2*i][3] = (block[i] & 0x0f) * 17;
+		pixels[2*i+1][3] = (block[i] >> 4) * 17;
+	}
+}
+
+static void dxt5_alpha_palette(const uint8_t* block, uint8_t palette[8])
+{
+	uint32_t a0 = block[0];
+	uint32_t a1 = block[1];
+	palette[0] = a0;
+	palette[1] = a1;
+	if(a0 > a1)
+	{
+		for(int i=1;i!=7;i++)
+			palette[i+1] = ((7-i)*a0 + i*a1) / 7;
+	}
+	else
+	{
+		for(int i=1;i!=5;i++)
+			palette[i+1] = ((5-i)*a0 + i*a1) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+static void decode_dxt5_alpha(const uint8_t* block, uint8_t pixels[16][4])
+{
+	uint8_t palette[8];
+	dxt5_alpha_palette(block,palette);
+
+	uint64_t bits = 0;
+	for(int i=0;i!=6;i++)
+		bits |= (uint64_t)block[2+i] << (8*i);
+	for(int i=0;i!=16;i++)
+	{
+		pixels[i][3] = palette[bits & 7];
+		bits >>= 3;
+	}
+}
+
+void decode_dds_level(const DDSImage& image, size_t level, uint8_t* rgba)
+{
+	const DDSLevel& l = image.levels[level];
+	const uint8_t* src = image.data.data() + l.offset;
+
+	if(!image.compressed())
+	{
+		memcpy(rgba,src,l.size);
+		return;
+	}
+
+	uint32_t bw = max(1u,(l.width+3)/4);
+	uint32_t bh = max(1u,(l.height+3)/4);
+	uint32_t stride = image.block_size();
+
+	uint8_t pixels[16][4];
+	for(uint32_t by=0;by!=bh;by++)
+	{
+		for(uint32_t bx=0;bx!=bw;bx++)
+		{
+			const uint8_t* block = src + (by*bw + bx)*stride;
+			switch(image.format)
+			{
+			case DDS_DXT1:
+				decode_color_block(block,pixels,true);
+				break;
+			case DDS_DXT3:
+				decode_color_block(block+8,pixels,false);
+				decode_dxt3_alpha(block,pixels);
+				break;
+			case DDS_DXT5:
+				decode_color_block(block+8,pixels,false);
+				decode_dxt5_alpha(block,pixels);
+				break;
+			default:
+				break;
+			}
+
+			// Edge blocks of non multiple of four levels are clipped.
+			uint32_t w = min(4u,l.width - bx*4);
+			uint32_t h = min(4u,l.height - by*4);
+			for(uint32_t y=0;y!=h;y++)
+			{
+				uint8_t* row = rgba + ((by*4 + y)*l.width + bx*4)*4;
+				memcpy(row,pixels[y*4],w*4);
+			}
+		}
+	}
+}
+
+// Bit i set for the pixels of a block that lie inside a level of w by h
+// pixels left of and below the block's corner.
+static uint32_t block_visible(uint32_t w, uint32_t h)
+{
+	uint32_t row = (1u << min(4u,w)) - 1;
+	uint32_t mask = 0;
+	for(uint32_t y=0;y!=min(4u,h);y++)
+		mask |= row << (4*y);
+	return mask;
+}
+
+// The alpha of a compressed block, read straight from its indices
+// without decoding any color.
+static bool block_has_cutout(DDSFormat format, const uint8_t* block,
+	uint32_t visible, uint8_t threshold)
+{
+	switch(format)
+	{
+	case DDS_DXT1:
+	{
+		// Only the three color mode has a transparent entry, index 3.
+		uint16_t c0 = block[0] | (block[1] << 8);
+		uint16_t c1 = block[2] | (block[3] << 8);
+		if(c0 > c1)
+			return false;
+		uint32_t bits = block[4] | (block[5] << 8) | (block[6] << 16) |
+			((uint32_t)block[7] << 24);
+		for(int i=0;i!=16;i++,bits>>=2)
+			if((visible >> i & 1) && (bits & 3) == 3)
+				return true;
+		return false;
+	}
+	case DDS_DXT3:
+		for(int i=0;i!=16;i++)
+		{
+			uint32_t a = (block[i/2] >> (4*(i&1))) & 0x0f;
+			if((visible >> i & 1) && a*17 <= threshold)
+				return true;
+		}
+		return false;
+	case DDS_DXT5:
+	{
+		uint8_t palette[8];
+		dxt5_alpha_palette(block,palette);
+
+		// Most blocks have no entry at or below threshold at all.
+		uint32_t low = 0;
+		for(int i=0;i!=8;i++)
+			if(palette[i] <= threshold)
+				low |= 1 << i;
+		if(!low)
+			return false;
+
+		uint64_t bits = 0;
+		for(int i=0;i!=6;i++)
+			bits |= (uint64_t)block[2+i] << (8*i);
+		for(int i=0;i!=16;i++,bits>>=3)
+			if((visible >> i & 1) && (low >> (bits & 7) & 1))
+				return true;
+		return false;
+	}
+	default:
+		return false;
+	}
+}
+
+bool dds_has_cutout(const DDSImage& image, uint8_t threshold)
+{
+	if(image.levels.empty() || image.format == DDS_UNKNOWN)
+		return false;
+	// Every pixel is at or below 255, opaque DXT1 entries included.
+	if(threshold == 255)
+		return true;
+
+	// A thin cutout can average away in the coarser levels, and a hole
+	// can appear only once it is averaged with its neighbours, so every
+	// level is looked at.  Coarsest first, they are the cheap ones.  Only
+	// the alpha is read, in place, nothing is decoded.
+	for(size_t level=image.levels.size();level--;)
+	{
+		const DDSLevel& l = image.levels[level];
+		const uint8_t* src = image.data.data() + l.offset;
+
+		if(!image.compressed())
+		{
+			for(size_t i=3;i<l.size;i+=4)
+				if(src[i] <= threshold)
+					return true;
+			continue;
+		}
+
+		uint32_t bw = max(1u,(l.width+3)/4);
+		uint32_t bh = max(1u,(l.height+3)/4);
+		uint32_t stride = image.block_size();
+		for(uint32_t by=0;by!=bh;by++)
+		{
+			for(uint32_t bx=0;bx!=bw;bx++)
+			{
+				// Edge blocks of non multiple of four levels are clipped.
+				uint32_t visible = block_visible(l.width - bx*4,
+					l.height - by*4);
+				const uint8_t* block = src + (by*bw + bx)*stride;
+				if(block_has_cutout(image.format,block,visible,threshold))
+					return true;
+			}
+		}
+	}
+	return false;
+}
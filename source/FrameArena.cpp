@@ -0,0 +1,77 @@
+#include "FrameArena.h"
+#include "Assert.h"
+using namespace std;
+
+const size_t FrameArena::DEFAULT_SIZE;
+const size_t FrameArena::ALIGNMENT;
+
+FrameArena::FrameArena(size_t size)
+  :current_(0)
+{
+  for(int i=0;i!=2;i++)
+  {
+    buffers_[i].data = new char[size];
+    buffers_[i].size = size;
+    buffers_[i].used = 0;
+    buffers_[i].requested = 0;
+  }
+}
+
+FrameArena::~FrameArena()
+{
+  for(int i=0;i!=2;i++)
+  {
+    for(size_t j=0;j!=buffers_[i].spills.size();j++)
+      ::operator delete(buffers_[i].spills[j]);
+    delete[] buffers_[i].data;
+  }
+}
+
+FrameArena& FrameArena::Instance()
+{
+  static FrameArena arena;
+  return arena;
+}
+
+void FrameArena::BeginFrame()
+{
+  current_ ^= 1;
+  Buffer& buffer = buffers_[current_];
+
+  for(size_t i=0;i!=buffer.spills.size();i++)
+    ::operator delete(buffer.spills[i]);
+  buffer.spills.clear();
+
+  // Whatever spilled last time round fits from now on.
+  if(buffer.requested > buffer.size)
+  {
+    size_t size = buffer.size;
+    while(size < buffer.requested)
+      size *= 2;
+    delete[] buffer.data;
+    buffer.data = new char[size];
+    buffer.size = size;
+  }
+  buffer.used = 0;
+  buffer.requested = 0;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+  assertion(alignment && alignment <= ALIGNMENT &&
+    !(alignment & (alignment - 1)),"Bad arena alignment %zu\n",alignment);
+
+  Buffer& buffer = buffers_[current_];
+  size_t offset = (buffer.used + alignment - 1) & ~(alignment - 1);
+  buffer.requested += offset - buffer.used + size;
+  if(offset + size <= buffer.size)
+  {
+    buffer.used = offset + size;
+    return buffer.data + offset;
+  }
+
+  // operator new aligns to at least ALIGNMENT.
+  void* spill = ::operator new(size ? size : 1);
+  buffer.spills.push_back(spill);
+  return spill;
+}
@@ -0,0 +1,295 @@
+#include "Math/Frustum.h"
+#include "CPU.h"
+
+#if Z_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+// The batched kernels do the same adds and multiplies in the same order as
+// TestBox and TestSphere, so the masks match the Reference versions bit
+// for bit.  Whatever is left after the last full batch goes through the
+// scalar tests.
+
+#if Z_SIMD
+
+static int CullBoxes4 (const float planes[6][4],
+	const Vector3Stream<float>& centers, const Vector3Stream<float>& extents,
+	uint32_t* visible)
+{
+	Float4 p[6][4], a[6][3];
+	for (int k = 0; k < 6; ++k)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			p[k][j] = Splat4(planes[k][j]);
+		}
+		for (int j = 0; j < 3; ++j)
+		{
+			a[k][j] = Splat4(Math<float>::FAbs(planes[k][j]));
+		}
+	}
+
+	Float4 zero = Splat4(0.0f);
+	int n = centers.GetQuantity();
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		Float4 cx = Load4(&centers.x[i]);
+		Float4 cy = Load4(&centers.y[i]);
+		Float4 cz = Load4(&centers.z[i]);
+		Float4 ex = Load4(&extents.x[i]);
+		Float4 ey = Load4(&extents.y[i]);
+		Float4 ez = Load4(&extents.z[i]);
+		Float4 outside = zero;
+		for (int k = 0; k < 6; ++k)
+		{
+			Float4 distance = Add4(MulAdd4(p[k][2],cz,
+				MulAdd4(p[k][1],cy,Mul4(p[k][0],cx))),p[k][3]);
+			Float4 radius = MulAdd4(a[k][2],ez,
+				MulAdd4(a[k][1],ey,Mul4(a[k][0],ex)));
+			outside = Or4(outside,Greater4(zero,Add4(distance,radius)));
+		}
+		visible[i >> 5] |= (uint32_t)(~Mask4(outside) & 0xf) << (i & 31);
+	}
+	return i;
+}
+
+static int CullSpheres4 (const float planes[6][4],
+	const Vector3Stream<float>& centers, const float* radii,
+	uint32_t* visible)
+{
+	Float4 p[6][4];
+	for (int k = 0; k < 6; ++k)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			p[k][j] = Splat4(planes[k][j]);
+		}
+	}
+
+	Float4 zero = Splat4(0.0f);
+	int n = centers.GetQuantity();
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		Float4 cx = Load4(&centers.x[i]);
+		Float4 cy = Load4(&centers.y[i]);
+		Float4 cz = Load4(&centers.z[i]);
+		Float4 radius = Load4(radii + i);
+		Float4 outside = zero;
+		for (int k = 0; k < 6; ++k)
+		{
+			Float4 distance = Add4(MulAdd4(p[k][2],cz,
+				MulAdd4(p[k][1],cy,Mul4(p[k][0],cx))),p[k][3]);
+			outside = Or4(outside,Greater4(zero,Add4(distance,radius)));
+		}
+		visible[i >> 5] |= (uint32_t)(~Mask4(outside) & 0xf) << (i & 31);
+	}
+	return i;
+}
+
+#endif
+
+#if Z_SIMD_SSE
+
+// Eight at a time.  No FMA, a fused multiply-add would round differently
+// from the reference.
+
+__attribute__((target("avx")))
+static int CullBoxes8 (const float planes[6][4],
+	const Vector3Stream<float>& centers, const Vector3Stream<float>& extents,
+	uint32_t* visible)
+{
+	__m256 p[6][4], a[6][3];
+	for (int k = 0; k < 6; ++k)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			p[k][j] = _mm256_set1_ps(planes[k][j]);
+		}
+		for (int j = 0; j < 3; ++j)
+		{
+			a[k][j] = _mm256_set1_ps(Math<float>::FAbs(planes[k][j]));
+		}
+	}
+
+	__m256 zero = _mm256_setzero_ps();
+	int n = centers.GetQuantity();
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256 cx = _mm256_loadu_ps(&centers.x[i]);
+		__m256 cy = _mm256_loadu_ps(&centers.y[i]);
+		__m256 cz = _mm256_loadu_ps(&centers.z[i]);
+		__m256 ex = _mm256_loadu_ps(&extents.x[i]);
+		__m256 ey = _mm256_loadu_ps(&extents.y[i]);
+		__m256 ez = _mm256_loadu_ps(&extents.z[i]);
+		__m256 outside = zero;
+		for (int k = 0; k < 6; ++k)
+		{
+			__m256 distance = _mm256_mul_ps(p[k][0],cx);
+			distance = _mm256_add_ps(_mm256_mul_ps(p[k][1],cy),distance);
+			distance = _mm256_add_ps(_mm256_mul_ps(p[k][2],cz),distance);
+			distance = _mm256_add_ps(distance,p[k][3]);
+			__m256 radius = _mm256_mul_ps(a[k][0],ex);
+			radius = _mm256_add_ps(_mm256_mul_ps(a[k][1],ey),radius);
+			radius = _mm256_add_ps(_mm256_mul_ps(a[k][2],ez),radius);
+			outside = _mm256_or_ps(outside,_mm256_cmp_ps(zero,
+				_mm256_add_ps(distance,radius),_CMP_GT_OQ));
+		}
+		visible[i >> 5] |=
+			(uint32_t)(~_mm256_movemask_ps(outside) & 0xff) << (i & 31);
+	}
+	return i;
+}
+
+__attribute__((target("avx")))
+static int CullSpheres8 (const float planes[6][4],
+	const Vector3Stream<float>& centers, const float* radii,
+	uint32_t* visible)
+{
+	__m256 p[6][4];
+	for (int k = 0; k < 6; ++k)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			p[k][j] = _mm256_set1_ps(planes[k][j]);
+		}
+	}
+
+	__m256 zero = _mm256_setzero_ps();
+	int n = centers.GetQuantity();
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256 cx = _mm256_loadu_ps(&centers.x[i]);
+		__m256 cy = _mm256_loadu_ps(&centers.y[i]);
+		__m256 cz = _mm256_loadu_ps(&centers.z[i]);
+		__m256 radius = _mm256_loadu_ps(radii + i);
+		__m256 outside = zero;
+		for (int k = 0; k < 6; ++k)
+		{
+			__m256 distance = _mm256_mul_ps(p[k][0],cx);
+			distance = _mm256_add_ps(_mm256_mul_ps(p[k][1],cy),distance);
+			distance = _mm256_add_ps(_mm256_mul_ps(p[k][2],cz),distance);
+			distance = _mm256_add_ps(distance,p[k][3]);
+			outside = _mm256_or_ps(outside,_mm256_cmp_ps(zero,
+				_mm256_add_ps(distance,radius),_CMP_GT_OQ));
+		}
+		visible[i >> 5] |=
+			(uint32_t)(~_mm256_movemask_ps(outside) & 0xff) << (i & 31);
+	}
+	return i;
+}
+
+#endif
+
+static bool LanesSupported (int lanes)
+{
+	switch (lanes)
+	{
+	case 1:
+		return true;
+#if Z_SIMD
+	case 4:
+		return true;
+#endif
+#if Z_SIMD_SSE
+	case 8:
+		return cpu_supports(CPU_AVX);
+#endif
+	default:
+		return false;
+	}
+}
+
+static int BestLanes ()
+{
+	const int order[] = {8, 4};
+	for (int i = 0; i < 2; ++i)
+	{
+		if (LanesSupported(order[i]))
+		{
+			return order[i];
+		}
+	}
+	return 1;
+}
+
+static int gLanes = BestLanes();
+
+template <>
+int Frustum<float>::GetLanes ()
+{
+	return gLanes;
+}
+
+template <>
+bool Frustum<float>::SetLanes (int lanes)
+{
+	if (!LanesSupported(lanes))
+	{
+		return false;
+	}
+	gLanes = lanes;
+	return true;
+}
+
+template <>
+void Frustum<float>::CullBoxes (const Vector3Stream<float>& centers,
+	const Vector3Stream<float>& extents, uint32_t* visible) const
+{
+	assertion(extents.GetQuantity() == centers.GetQuantity(),
+		"Stream size mismatch\n");
+
+	int n = centers.GetQuantity();
+	memset(visible,0,GetMaskWords(n)*sizeof(uint32_t));
+	int i = 0;
+#if Z_SIMD_SSE
+	if (gLanes == 8)
+	{
+		i = CullBoxes8(planes,centers,extents,visible);
+	}
+#endif
+#if Z_SIMD
+	if (gLanes == 4)
+	{
+		i = CullBoxes4(planes,centers,extents,visible);
+	}
+#endif
+	for (; i < n; ++i)
+	{
+		if (TestBox(centers.Get(i),extents.Get(i)))
+		{
+			visible[i >> 5] |= 1u << (i & 31);
+		}
+	}
+}
+
+template <>
+void Frustum<float>::CullSpheres (const Vector3Stream<float>& centers,
+	const float* radii, uint32_t* visible) const
+{
+	int n = centers.GetQuantity();
+	memset(visible,0,GetMaskWords(n)*sizeof(uint32_t));
+	int i = 0;
+#if Z_SIMD_SSE
+	if (gLanes == 8)
+	{
+		i = CullSpheres8(planes,centers,radii,visible);
+	}
+#endif
+#if Z_SIMD
+	if (gLanes == 4)
+	{
+		i = CullSpheres4(planes,centers,radii,visible);
+	}
+#endif
+	for (; i < n; ++i)
+	{
+		if (TestSphere(centers.Get(i),radii[i]))
+		{
+			visible[i >> 5] |= 1u << (i & 31);
+		}
+	}
+}
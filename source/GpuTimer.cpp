@@ -0,0 +1,59 @@
+#include "GpuTimer.h"
+
+const int GpuTimer::QUERIES;
+
+GpuTimer::GpuTimer()
+  :next_(0),oldest_(0),active_(false)
+{
+  for(int i=0;i!=QUERIES;i++)
+  {
+    queries_[i] = 0;
+    pending_[i] = false;
+  }
+  if(GLEW_ARB_timer_query)
+    glGenQueries(QUERIES,queries_);
+}
+
+GpuTimer::~GpuTimer()
+{
+  if(IsSupported())
+    glDeleteQueries(QUERIES,queries_);
+}
+
+void GpuTimer::Begin()
+{
+  if(!IsSupported() || pending_[next_])
+    return;
+  glBeginQuery(GL_TIME_ELAPSED,queries_[next_]);
+  active_ = true;
+}
+
+void GpuTimer::End()
+{
+  if(!active_)
+    return;
+  glEndQuery(GL_TIME_ELAPSED);
+  pending_[next_] = true;
+  next_ = (next_ + 1) % QUERIES;
+  active_ = false;
+}
+
+bool GpuTimer::GetResult(double& milliseconds)
+{
+  // Queries finish in order, the first one not done ends the search.
+  bool found = false;
+  while(pending_[oldest_])
+  {
+    GLint available = 0;
+    glGetQueryObjectiv(queries_[oldest_],GL_QUERY_RESULT_AVAILABLE,&available);
+    if(!available)
+      break;
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(queries_[oldest_],GL_QUERY_RESULT,&nanoseconds);
+    milliseconds = nanoseconds / 1e6;
+    found = true;
+    pending_[oldest_] = false;
+    oldest_ = (oldest_ + 1) % QUERIES;
+  }
+  return found;
+}
@@ -0,0 +1,260 @@
+#include "JobSystem.h"
+#include "Assert.h"
+#include "Trace.h"
+
+// The system and worker index of the calling thread, -1 off the pool.
+static thread_local JobSystem* gSystem = 0;
+static thread_local int gWorker = -1;
+
+JobSystem::JobSystem(uint32_t workers)
+  :main_(std::this_thread::get_id()),queued_(0),quit_(false)
+{
+  if(!workers)
+    workers = max(2u,std::thread::hardware_concurrency()) - 1;
+
+  for(uint32_t i=0;i!=workers+1;i++)
+    queues_.push_back(std::unique_ptr<Queue>(new Queue));
+  for(uint32_t i=0;i!=workers;i++)
+    workers_.push_back(std::thread(&JobSystem::Worker,this,i));
+}
+
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    quit_ = true;
+  }
+  wake_.notify_all();
+  for(size_t i=0;i!=workers_.size();i++)
+    workers_[i].join();
+}
+
+JobSystem& JobSystem::Instance()
+{
+  static JobSystem system;
+  return system;
+}
+
+void JobSystem::Run(std::function<void()> job, JobCounter* counter)
+{
+  Count(counter);
+  Task task = {std::move(job),counter,MemoryTracker::GetTag()};
+  Enqueue(task,false);
+}
+
+void JobSystem::RunOnMain(std::function<void()> job, JobCounter* counter)
+{
+  Count(counter);
+  Task task = {std::move(job),counter,MemoryTracker::GetTag()};
+  Enqueue(task,true);
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, std::function<void()> job,
+  JobCounter* counter)
+{
+  Count(counter);
+  {
+    std::lock_guard<std::mutex> lock(dependency.mutex_);
+    if(dependency.pending_)
+    {
+      JobCounter::Continuation next = {std::move(job),counter,false,
+        MemoryTracker::GetTag()};
+      dependency.continuations_.push_back(std::move(next));
+      return;
+    }
+  }
+  Task task = {std::move(job),counter,MemoryTracker::GetTag()};
+  Enqueue(task,false);
+}
+
+void JobSystem::RunOnMainAfter(JobCounter& dependency,
+  std::function<void()> job, JobCounter* counter)
+{
+  Count(counter);
+  {
+    std::lock_guard<std::mutex> lock(dependency.mutex_);
+    if(dependency.pending_)
+    {
+      JobCounter::Continuation next = {std::move(job),counter,true,
+        MemoryTracker::GetTag()};
+      dependency.continuations_.push_back(std::move(next));
+      return;
+    }
+  }
+  Task task = {std::move(job),counter,MemoryTracker::GetTag()};
+  Enqueue(task,true);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+  bool main = IsMainThread();
+  while(!counter.Done())
+  {
+    Task task;
+    if((main && PopMain(task)) || Pop(task))
+      Execute(task);
+    else
+      std::this_thread::yield();
+  }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grain,
+  const std::function<void(size_t,size_t)>& body)
+{
+  grain = max(grain,(size_t)1);
+  if(count <= grain)
+  {
+    if(count)
+      body(0,count);
+    return;
+  }
+
+  // A few pieces per thread, so the ones that finish early can steal.
+  size_t pieces = min((count + grain - 1) / grain,(workers_.size() + 1) * 4);
+  size_t size = (count + pieces - 1) / pieces;
+
+  JobCounter counter;
+  for(size_t begin=size;begin<count;begin+=size)
+  {
+    size_t end = min(count,begin + size);
+    Run([&body,begin,end]() { body(begin,end); },&counter);
+  }
+  body(0,size);
+  Wait(counter);
+}
+
+void JobSystem::PumpMain()
+{
+  assertion(IsMainThread(),"PumpMain off the main thread\n");
+  TRACE_ZONE("JobSystem::PumpMain");
+
+  {
+    std::lock_guard<std::mutex> lock(mainQueue_.mutex);
+    pumped_.swap(mainQueue_.tasks);
+  }
+  for(size_t i=0;i!=pumped_.size();i++)
+    Execute(pumped_[i]);
+  pumped_.clear();
+}
+
+void JobSystem::Count(JobCounter* counter)
+{
+  if(!counter)
+    return;
+  std::lock_guard<std::mutex> lock(counter->mutex_);
+  counter->pending_++;
+}
+
+void JobSystem::Enqueue(Task& task, bool main)
+{
+  if(main)
+  {
+    std::lock_guard<std::mutex> lock(mainQueue_.mutex);
+    mainQueue_.tasks.push_back(std::move(task));
+    return;
+  }
+
+  // Counted first so queued_ never drops below the jobs in the queues.
+  queued_++;
+  Queue& queue = gSystem == this ? *queues_[gWorker] : *queues_.back();
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+
+  // A worker checks queued_ under sleepMutex_ before it waits, so taking
+  // the lock here means it either sees the job or gets the notify.
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+  }
+  wake_.notify_one();
+}
+
+bool JobSystem::Pop(Task& task)
+{
+  if(!queued_)
+    return false;
+
+  // Own jobs newest first, then the oldest of everyone else's.
+  size_t own = gSystem == this ? gWorker : queues_.size() - 1;
+  for(size_t i=0;i!=queues_.size();i++)
+  {
+    Queue& queue = *queues_[(own + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty())
+      continue;
+    if(i == 0 && gSystem == this)
+    {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    queued_--;
+    return true;
+  }
+  return false;
+}
+
+bool JobSystem::PopMain(Task& task)
+{
+  std::lock_guard<std::mutex> lock(mainQueue_.mutex);
+  if(mainQueue_.tasks.empty())
+    return false;
+  task = std::move(mainQueue_.tasks.front());
+  mainQueue_.tasks.pop_front();
+  return true;
+}
+
+void JobSystem::Execute(Task& task)
+{
+  {
+    TRACE_ZONE("job");
+    MemoryTagScope tag(task.tag);
+    task.job();
+  }
+  if(!task.counter)
+    return;
+
+  // Nothing may touch the counter after its lock is released, a Wait can
+  // return and destroy it right then.
+  vector<JobCounter::Continuation> next;
+  {
+    std::lock_guard<std::mutex> lock(task.counter->mutex_);
+    if(--task.counter->pending_ == 0)
+      next.swap(task.counter->continuations_);
+  }
+  for(size_t i=0;i!=next.size();i++)
+  {
+    Task continuation = {std::move(next[i].job),next[i].counter,
+      next[i].tag};
+    Enqueue(continuation,next[i].main);
+  }
+}
+
+void JobSystem::Worker(uint32_t index)
+{
+  gSystem = this;
+  gWorker = index;
+
+  char name[32];
+  snprintf(name,sizeof(name),"worker %u",index);
+  TRACE_THREAD(name);
+
+  while(true)
+  {
+    Task task;
+    if(Pop(task))
+    {
+      Execute(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    while(!quit_ && !queued_)
+      wake_.wait(lock);
+    if(quit_ && !queued_)
+      return;
+  }
+}
@@ -1,4 +1,6 @@
 #include "LOLMap.h"
+#include "Trace.h"
+#include "MemoryTracker.h"
 #include <fstream>
 using namespace std;
 
@@ -16,6 +18,8 @@ void Read(T& data,size_t num,istream& in)
 
 LOLMap* read_map(const char* filename)
 {
+	TRACE_ZONE("read_map");
+	MemoryTagScope tag(MEMORY_PARSER);
 	cout << "Reading " << filename << endl;
 	ifstream nvr(filename,ios::binary);
 
@@ -138,4 +142,20 @@ LOLMap* read_map(const char* filename)
 	nvr.close();
 
 	return map;
-}
\ No newline at end of file
+}
+
+void free_map(LOLMap* map)
+{
+	if(!map)
+		return;
+	for(uint32_t i=0;i!=map->num_vertex_list;i++)
+		delete[] map->vertex_lists[i].vertices;
+	for(uint32_t i=0;i!=map->num_index_list;i++)
+		delete[] map->index_lists[i].indices;
+	delete[] map->materials;
+	delete[] map->vertex_lists;
+	delete[] map->index_lists;
+	delete[] map->models;
+	delete[] map->unknowns;
+	delete map;
+}
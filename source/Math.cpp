@@ -1,39 +0,0 @@
-#include "Math/Math.h"
-
-template<> const float Math<float>::EPSILON = std::numeric_limits<float>::epsilon();
-template<> const float Math<float>::MAX_VALUE = std::numeric_limits<float>::max();
-template<> const float Math<float>::MIN_VALUE = std::numeric_limits<float>::min();
-template<> const float Math<float>::PI = (float)(4.0*atan(1.0));
-template<> const float Math<float>::TWO_PI = 2.0f*Math<float>::PI;
-template<> const float Math<float>::HALF_PI = 0.5f*Math<float>::PI;
-template<> const float Math<float>::INV_PI = 1.0f/Math<float>::PI;
-template<> const float Math<float>::INV_TWO_PI = 1.0f/Math<float>::TWO_PI;
-template<> const float Math<float>::DEG_TO_RAD = Math<float>::PI/180.0f;
-template<> const float Math<float>::RAD_TO_DEG = 180.0f/Math<float>::PI;
-template<> const float Math<float>::LN_2 = Math<float>::Log(2.0f);
-template<> const float Math<float>::LN_10 = Math<float>::Log(10.0f);
-template<> const float Math<float>::INV_LN_2 = 1.0f/Math<float>::LN_2;
-template<> const float Math<float>::INV_LN_10 = 1.0f/Math<float>::LN_10;
-template<> const float Math<float>::SQRT_2 = (float)(sqrt(2.0));
-template<> const float Math<float>::INV_SQRT_2 = 1.0f/Math<float>::SQRT_2;
-template<> const float Math<float>::SQRT_3 = (float)(sqrt(3.0));
-template<> const float Math<float>::INV_SQRT_3 = 1.0f/Math<float>::SQRT_3;
-
-template<> const double Math<double>::EPSILON = std::numeric_limits<double>::epsilon();
-template<> const double Math<double>::MAX_VALUE = std::numeric_limits<double>::max();
-template<> const double Math<double>::MIN_VALUE = std::numeric_limits<double>::min();
-template<> const double Math<double>::PI = 4.0*atan(1.0);
-template<> const double Math<double>::TWO_PI = 2.0*Math<double>::PI;
-template<> const double Math<double>::HALF_PI = 0.5*Math<double>::PI;
-template<> const double Math<double>::INV_PI = 1.0/Math<double>::PI;
-template<> const double Math<double>::INV_TWO_PI = 1.0/Math<double>::TWO_PI;
-template<> const double Math<double>::DEG_TO_RAD = Math<double>::PI/180.0;
-template<> const double Math<double>::RAD_TO_DEG = 180.0/Math<double>::PI;
-template<> const double Math<double>::LN_2 = Math<double>::Log(2.0);
-template<> const double Math<double>::LN_10 = Math<double>::Log(10.0);
-template<> const double Math<double>::INV_LN_2 = 1.0/Math<double>::LN_2;
-template<> const double Math<double>::INV_LN_10 = 1.0/Math<double>::LN_10;
-template<> const double Math<double>::SQRT_2 = sqrt(2.0);
-template<> const double Math<double>::INV_SQRT_2 = 1.0f/Math<double>::SQRT_2;
-template<> const double Math<double>::SQRT_3 = sqrt(3.0);
-template<> const double Math<double>::INV_SQRT_3 = 1.0f/Math<double>::SQRT_3;
\ No newline at end of file
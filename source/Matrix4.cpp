@@ -1,45 +1,5 @@
 #include "Math/Matrix4.h"
 
-template<> const Matrix4<float> Matrix4<float>::ZERO(		
-	0, 0, 0, 0,
-	0, 0, 0, 0,
-	0, 0, 0, 0,
-	0, 0, 0, 0 
-);
-template<> const Matrix4<float> Matrix4<float>::IDENTITY(
-	1, 0, 0, 0,
-	0, 1, 0, 0,
-	0, 0, 1, 0,
-	0, 0, 0, 1 
-);
-
-template<> const Matrix4<float> Matrix4<float>::ZEROAFFINE(
-	0, 0, 0, 0,
-	0, 0, 0, 0,
-	0, 0, 0, 0,
-	0, 0, 0, 1 
-);
-
-template<> const Matrix4<double> Matrix4<double>::ZERO(       
-    0, 0, 0, 0,
-    0, 0, 0, 0,
-    0, 0, 0, 0,
-    0, 0, 0, 0 
-);
-template<> const Matrix4<double> Matrix4<double>::IDENTITY(
-    1, 0, 0, 0,
-    0, 1, 0, 0,
-    0, 0, 1, 0,
-    0, 0, 0, 1 
-);
-
-template<> const Matrix4<double> Matrix4<double>::ZEROAFFINE(
-    0, 0, 0, 0,
-    0, 0, 0, 0,
-    0, 0, 0, 0,
-    0, 0, 0, 1 
-);
-
 /*
 	//-----------------------------------------------------------------------
 	inline static Real
@@ -0,0 +1,356 @@
+#include "MemoryTracker.h"
+#include "Assert.h"
+
+#include <atomic>
+#if defined(__GLIBC__) || defined(__APPLE__)
+  #include <execinfo.h>
+  #define Z_MEMORY_BACKTRACE 1
+#else
+  #define Z_MEMORY_BACKTRACE 0
+#endif
+using namespace std;
+
+const int MemoryTracker::SITE_DEPTH;
+const size_t MemoryTracker::SITE_SLOTS;
+
+struct MemoryTagCounters
+{
+  std::atomic<uint64_t> allocations;
+  std::atomic<uint64_t> bytes;
+  std::atomic<uint64_t> frees;
+};
+
+// Claimed by swapping key in, frames are only read once ready is set.
+struct MemorySite
+{
+  std::atomic<uint64_t> key;
+  std::atomic<bool> ready;
+  void* frames[MemoryTracker::SITE_DEPTH];
+  int depth;
+  std::atomic<uint64_t> allocations;
+  std::atomic<uint64_t> bytes;
+};
+
+// All of it constant initialized, operator new runs before any
+// constructor does.
+static MemoryTagCounters gCounters[MEMORY_TAG_COUNT];
+static MemorySite gSites[MemoryTracker::SITE_SLOTS];
+static std::atomic<uint64_t> gDroppedSites(0);
+static std::atomic<bool> gSiteTracking(false);
+static std::atomic<bool> gGuards(false);
+
+static thread_local MemoryTag tTag = MEMORY_UNTAGGED;
+static thread_local uint64_t tAllocations = 0;
+static thread_local uint64_t tBytes = 0;
+static thread_local uint64_t tFrees = 0;
+// Set while the thread records a site or reports, backtrace allocates the
+// first time it runs.
+static thread_local bool tInSite = false;
+
+static const char* TAG_NAMES[MEMORY_TAG_COUNT] = {
+  "untagged",
+  "parser",
+  "textures",
+  "renderer",
+  "frame"
+};
+
+// At most the frames of record_site, RecordAllocation and operator new,
+// which nobody wants to see.  allocate is always inlined into the latter,
+// the stack starts at the caller of operator new when it is found.
+static const int SKIPPED_FRAMES = 3;
+
+__attribute__((noinline))
+static void record_site(size_t size, void* caller)
+{
+  tInSite = true;
+
+  void* frames[MemoryTracker::SITE_DEPTH + SKIPPED_FRAMES];
+  int depth = 1;
+#if Z_MEMORY_BACKTRACE
+  depth = backtrace(frames,MemoryTracker::SITE_DEPTH + SKIPPED_FRAMES);
+  int skip = 0;
+  while(skip != min(depth,SKIPPED_FRAMES) && frames[skip] != caller)
+    skip++;
+  depth = min(depth - skip,MemoryTracker::SITE_DEPTH);
+  memmove(frames,frames + skip,depth * sizeof(void*));
+#else
+  frames[0] = caller;
+#endif
+
+  // FNV-1a over the frames, zero marks a free slot.
+  uint64_t key = 14695981039346656037ull;
+  for(int i=0;i!=depth;i++)
+  {
+    key ^= (uint64_t)(uintptr_t)frames[i];
+    key *= 1099511628211ull;
+  }
+  key = key ? key : 1;
+
+  // Linear probing, a bounded number of slots so a full table stays cheap.
+  for(size_t i=0;i!=64;i++)
+  {
+    MemorySite& site = gSites[(key + i) % MemoryTracker::SITE_SLOTS];
+    uint64_t current = site.key.load(std::memory_order_acquire);
+    if(!current && site.key.compare_exchange_strong(current,key))
+    {
+      memcpy(site.frames,frames,depth * sizeof(void*));
+      site.depth = depth;
+      site.ready.store(true,std::memory_order_release);
+      current = key;
+    }
+    if(current == key)
+    {
+      site.allocations.fetch_add(1,std::memory_order_relaxed);
+      site.bytes.fetch_add(size,std::memory_order_relaxed);
+      tInSite = false;
+      return;
+    }
+  }
+  gDroppedSites++;
+  tInSite = false;
+}
+
+__attribute__((noinline))
+void MemoryTracker::RecordAllocation(size_t size, void* caller)
+{
+  MemoryTagCounters& counters = gCounters[tTag];
+  counters.allocations.fetch_add(1,std::memory_order_relaxed);
+  counters.bytes.fetch_add(size,std::memory_order_relaxed);
+  tAllocations++;
+  tBytes += size;
+
+  if(gSiteTracking.load(std::memory_order_relaxed) && !tInSite)
+    record_site(size,caller);
+}
+
+void MemoryTracker::RecordFree()
+{
+  gCounters[tTag].frees.fetch_add(1,std::memory_order_relaxed);
+  tFrees++;
+}
+
+MemoryCounters MemoryTracker::GetCounters(MemoryTag tag)
+{
+  MemoryCounters counters = {gCounters[tag].allocations,gCounters[tag].bytes,
+    gCounters[tag].frees};
+  return counters;
+}
+
+MemoryCounters MemoryTracker::GetTotal()
+{
+  MemoryCounters total = {0,0,0};
+  for(int i=0;i!=MEMORY_TAG_COUNT;i++)
+  {
+    MemoryCounters counters = GetCounters((MemoryTag)i);
+    total.allocations += counters.allocations;
+    total.bytes += counters.bytes;
+    total.frees += counters.frees;
+  }
+  return total;
+}
+
+MemoryCounters MemoryTracker::GetThreadCounters()
+{
+  MemoryCounters counters = {tAllocations,tBytes,tFrees};
+  return counters;
+}
+
+MemoryTag MemoryTracker::GetTag()
+{
+  return tTag;
+}
+
+void MemoryTracker::SetTag(MemoryTag tag)
+{
+  tTag = tag;
+}
+
+const char* MemoryTracker::GetTagName(MemoryTag tag)
+{
+  return TAG_NAMES[tag];
+}
+
+void MemoryTracker::SetSiteTracking(bool enabled)
+{
+  gSiteTracking = enabled;
+}
+
+bool MemoryTracker::IsSiteTracking()
+{
+  return gSiteTracking;
+}
+
+void MemoryTracker::SetGuardsEnabled(bool enabled)
+{
+  gGuards = enabled;
+}
+
+bool MemoryTracker::AreGuardsEnabled()
+{
+  return gGuards;
+}
+
+static void report_sites(ostream& out, vector<MemorySite*>& sites,
+  size_t top, bool byBytes)
+{
+  sort(sites.begin(),sites.end(),[byBytes](MemorySite* a, MemorySite* b)
+  {
+    return byBytes ? a->bytes > b->bytes : a->allocations > b->allocations;
+  });
+
+  out << "top sites by " << (byBytes ? "bytes" : "count") << endl;
+  for(size_t i=0;i!=min(top,sites.size());i++)
+  {
+    const MemorySite& site = *sites[i];
+    out << "  " << site.bytes << " bytes, " << site.allocations <<
+      " allocations" << endl;
+#if Z_MEMORY_BACKTRACE
+    char** symbols = backtrace_symbols(site.frames,site.depth);
+    for(int f=0;f!=site.depth;f++)
+      out << "    " << (symbols ? symbols[f] : "?") << endl;
+    free(symbols);
+#else
+    for(int f=0;f!=site.depth;f++)
+      out << "    " << site.frames[f] << endl;
+#endif
+  }
+}
+
+void MemoryTracker::Report(ostream& out, size_t top)
+{
+  bool inSite = tInSite;
+  tInSite = true;
+
+  char line[128];
+  snprintf(line,sizeof(line),"%-10s%16s%16s%16s","memory","allocations",
+    "bytes","frees");
+  out << line << endl;
+  for(int i=0;i!=MEMORY_TAG_COUNT;i++)
+  {
+    MemoryCounters counters = GetCounters((MemoryTag)i);
+    snprintf(line,sizeof(line),"%-10s%16" PRIu64 "%16" PRIu64 "%16" PRIu64,
+      TAG_NAMES[i],counters.allocations,counters.bytes,counters.frees);
+    out << line << endl;
+  }
+
+  vector<MemorySite*> sites;
+  for(size_t i=0;i!=SITE_SLOTS;i++)
+    if(gSites[i].ready.load(std::memory_order_acquire))
+      sites.push_back(&gSites[i]);
+  if(!sites.empty())
+  {
+    report_sites(out,sites,top,true);
+    report_sites(out,sites,top,false);
+    if(gDroppedSites)
+      out << gDroppedSites << " allocations from sites that didn't fit" <<
+        endl;
+  }
+
+  tInSite = inSite;
+}
+
+void AllocationGuard::End()
+{
+  if(!armed_)
+    return;
+  armed_ = false;
+
+  MemoryCounters counters = scope_.GetCounters();
+  assertion(counters.allocations == 0,
+    "%s allocated %" PRIu64 " times, %" PRIu64 " bytes\n",name_,
+    counters.allocations,counters.bytes);
+}
+
+#if Z_MEMORY_TRACKING
+
+__attribute__((always_inline))
+static inline void* allocate(size_t size, void* caller)
+{
+  MemoryTracker::RecordAllocation(size,caller);
+  void* p;
+  while(!(p = malloc(size ? size : 1)))
+  {
+    std::new_handler handler = std::get_new_handler();
+    if(!handler)
+      throw std::bad_alloc();
+    handler();
+  }
+  return p;
+}
+
+static void deallocate(void* p)
+{
+  if(!p)
+    return;
+  MemoryTracker::RecordFree();
+  free(p);
+}
+
+void* operator new(size_t size)
+{
+  return allocate(size,__builtin_return_address(0));
+}
+
+void* operator new[](size_t size)
+{
+  return allocate(size,__builtin_return_address(0));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+  try
+  {
+    return allocate(size,__builtin_return_address(0));
+  }
+  catch(...)
+  {
+    return 0;
+  }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+  try
+  {
+    return allocate(size,__builtin_return_address(0));
+  }
+  catch(...)
+  {
+    return 0;
+  }
+}
+
+void operator delete(void* p) noexcept
+{
+  deallocate(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+  deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+  deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+  deallocate(p);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void* p, size_t) noexcept
+{
+  deallocate(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+  deallocate(p);
+}
+#endif
+
+#endif
@@ -0,0 +1,595 @@
+#include "PixelFormat.h"
+#include "CPU.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+	#define PIXEL_X86 1
+	#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define PIXEL_NEON 1
+	#include <arm_neon.h>
+#endif
+
+struct PixelKernels
+{
+	void (*rgb_to_rgba)(const uint8_t* src, uint8_t* dst, size_t count);
+	void (*bgr_to_rgba)(const uint8_t* src, uint8_t* dst, size_t count);
+	void (*bgra_to_rgba)(const uint8_t* src, uint8_t* dst, size_t count);
+	void (*swap_rows)(uint8_t* a, uint8_t* b, size_t bytes);
+	void (*box_filter)(const uint8_t* row0, const uint8_t* row1, uint8_t* dst,
+		size_t count);
+};
+
+//	Scalar
+
+static void rgb_to_rgba_scalar(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	for(size_t i=0;i!=count;i++)
+	{
+		dst[4*i+0] = src[3*i+0];
+		dst[4*i+1] = src[3*i+1];
+		dst[4*i+2] = src[3*i+2];
+		dst[4*i+3] = 255;
+	}
+}
+
+static void bgr_to_rgba_scalar(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	for(size_t i=0;i!=count;i++)
+	{
+		dst[4*i+0] = src[3*i+2];
+		dst[4*i+1] = src[3*i+1];
+		dst[4*i+2] = src[3*i+0];
+		dst[4*i+3] = 255;
+	}
+}
+
+static void bgra_to_rgba_scalar(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	for(size_t i=0;i!=count;i++)
+	{
+		uint8_t b = src[4*i+0];
+		uint8_t r = src[4*i+2];
+		dst[4*i+0] = r;
+		dst[4*i+1] = src[4*i+1];
+		dst[4*i+2] = b;
+		dst[4*i+3] = src[4*i+3];
+	}
+}
+
+static void swap_rows_scalar(uint8_t* a, uint8_t* b, size_t bytes)
+{
+	for(size_t i=0;i!=bytes;i++)
+		swap(a[i],b[i]);
+}
+
+static void box_filter_scalar(const uint8_t* row0, const uint8_t* row1,
+	uint8_t* dst, size_t count)
+{
+	for(size_t i=0;i!=count*4;i++)
+	{
+		size_t x = (i/4)*8 + i%4;
+		dst[i] = (row0[x] + row0[x+4] + row1[x] + row1[x+4] + 2) >> 2;
+	}
+}
+
+static const PixelKernels SCALAR_KERNELS = {
+	rgb_to_rgba_scalar,
+	bgr_to_rgba_scalar,
+	bgra_to_rgba_scalar,
+	swap_rows_scalar,
+	box_filter_scalar
+};
+
+#if PIXEL_X86
+
+//	SSSE3, four pixels per shuffle
+
+// Three byte pixels are read 16 bytes at a time at a 12 byte stride, so the
+// last 4 bytes of every load belong to the next group.  The vector loop
+// stops early enough that this never reads past the end of the row.
+#define PIXEL_SHUFFLE_RGB \
+	0,1,2,-128, 3,4,5,-128, 6,7,8,-128, 9,10,11,-128
+#define PIXEL_SHUFFLE_BGR \
+	2,1,0,-128, 5,4,3,-128, 8,7,6,-128, 11,10,9,-128
+#define PIXEL_SHUFFLE_BGRA \
+	2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15
+
+__attribute__((target("ssse3")))
+static size_t expand3_ssse3(const uint8_t* src, uint8_t* dst, size_t count,
+	__m128i shuffle)
+{
+	const __m128i alpha = _mm_set1_epi32(0xff000000);
+	size_t i = 0;
+	for(;i+18<=count;i+=16)
+	{
+		const uint8_t* s = src + 3*i;
+		__m128i p0 = _mm_loadu_si128((const __m128i*)(s + 0));
+		__m128i p1 = _mm_loadu_si128((const __m128i*)(s + 12));
+		__m128i p2 = _mm_loadu_si128((const __m128i*)(s + 24));
+		__m128i p3 = _mm_loadu_si128((const __m128i*)(s + 36));
+		__m128i* d = (__m128i*)(dst + 4*i);
+		_mm_storeu_si128(d + 0,_mm_or_si128(_mm_shuffle_epi8(p0,shuffle),alpha));
+		_mm_storeu_si128(d + 1,_mm_or_si128(_mm_shuffle_epi8(p1,shuffle),alpha));
+		_mm_storeu_si128(d + 2,_mm_or_si128(_mm_shuffle_epi8(p2,shuffle),alpha));
+		_mm_storeu_si128(d + 3,_mm_or_si128(_mm_shuffle_epi8(p3,shuffle),alpha));
+	}
+	return i;
+}
+
+__attribute__((target("ssse3")))
+static void rgb_to_rgba_ssse3(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	size_t i = expand3_ssse3(src,dst,count,_mm_setr_epi8(PIXEL_SHUFFLE_RGB));
+	rgb_to_rgba_scalar(src + 3*i,dst + 4*i,count - i);
+}
+
+__attribute__((target("ssse3")))
+static void bgr_to_rgba_ssse3(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	size_t i = expand3_ssse3(src,dst,count,_mm_setr_epi8(PIXEL_SHUFFLE_BGR));
+	bgr_to_rgba_scalar(src + 3*i,dst + 4*i,count - i);
+}
+
+__attribute__((target("ssse3")))
+static void bgra_to_rgba_ssse3(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	const __m128i shuffle = _mm_setr_epi8(PIXEL_SHUFFLE_BGRA);
+	size_t i = 0;
+	for(;i+4<=count;i+=4)
+	{
+		__m128i p = _mm_loadu_si128((const __m128i*)(src + 4*i));
+		_mm_storeu_si128((__m128i*)(dst + 4*i),_mm_shuffle_epi8(p,shuffle));
+	}
+	bgra_to_rgba_scalar(src + 4*i,dst + 4*i,count - i);
+}
+
+__attribute__((target("sse2")))
+static void swap_rows_sse2(uint8_t* a, uint8_t* b, size_t bytes)
+{
+	size_t i = 0;
+	for(;i+16<=bytes;i+=16)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+		__m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+		_mm_storeu_si128((__m128i*)(a + i),y);
+		_mm_storeu_si128((__m128i*)(b + i),x);
+	}
+	swap_rows_scalar(a + i,b + i,bytes - i);
+}
+
+// Pixels are widened to 16 bits, the two rows added and then neighbouring
+// pixels, which sit in the two 64 bit halves after widening.
+__attribute__((target("sse2")))
+static void box_filter_sse2(const uint8_t* row0, const uint8_t* row1,
+	uint8_t* dst, size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i two = _mm_set1_epi16(2);
+	size_t i = 0;
+	for(;i+4<=count;i+=4)
+	{
+		__m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + 8*i));
+		__m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + 8*i + 16));
+		__m128i b0 = _mm_loadu_si128((const __m128i*)(row1 + 8*i));
+		__m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + 8*i + 16));
+		__m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(a0,zero),
+			_mm_unpacklo_epi8(b0,zero));
+		__m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(a0,zero),
+			_mm_unpackhi_epi8(b0,zero));
+		__m128i s45 = _mm_add_epi16(_mm_unpacklo_epi8(a1,zero),
+			_mm_unpacklo_epi8(b1,zero));
+		__m128i s67 = _mm_add_epi16(_mm_unpackhi_epi8(a1,zero),
+			_mm_unpackhi_epi8(b1,zero));
+		__m128i o01 = _mm_add_epi16(_mm_unpacklo_epi64(s01,s23),
+			_mm_unpackhi_epi64(s01,s23));
+		__m128i o23 = _mm_add_epi16(_mm_unpacklo_epi64(s45,s67),
+			_mm_unpackhi_epi64(s45,s67));
+		o01 = _mm_srli_epi16(_mm_add_epi16(o01,two),2);
+		o23 = _mm_srli_epi16(_mm_add_epi16(o23,two),2);
+		_mm_storeu_si128((__m128i*)(dst + 4*i),_mm_packus_epi16(o01,o23));
+	}
+	box_filter_scalar(row0 + 8*i,row1 + 8*i,dst + 4*i,count - i);
+}
+
+static const PixelKernels SSSE3_KERNELS = {
+	rgb_to_rgba_ssse3,
+	bgr_to_rgba_ssse3,
+	bgra_to_rgba_ssse3,
+	swap_rows_sse2,
+	box_filter_sse2
+};
+
+//	AVX2, the same shuffles on both 128 bit lanes
+
+__attribute__((target("avx2")))
+static inline __m256i load_2x128(const uint8_t* lo, const uint8_t* hi)
+{
+	return _mm256_inserti128_si256(
+		_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)lo)),
+		_mm_loadu_si128((const __m128i*)hi),1);
+}
+
+__attribute__((target("avx2")))
+static size_t expand3_avx2(const uint8_t* src, uint8_t* dst, size_t count,
+	__m256i shuffle)
+{
+	const __m256i alpha = _mm256_set1_epi32(0xff000000);
+	size_t i = 0;
+	for(;i+18<=count;i+=16)
+	{
+		const uint8_t* s = src + 3*i;
+		__m256i p0 = load_2x128(s + 0,s + 12);
+		__m256i p1 = load_2x128(s + 24,s + 36);
+		__m256i* d = (__m256i*)(dst + 4*i);
+		_mm256_storeu_si256(d + 0,
+			_mm256_or_si256(_mm256_shuffle_epi8(p0,shuffle),alpha));
+		_mm256_storeu_si256(d + 1,
+			_mm256_or_si256(_mm256_shuffle_epi8(p1,shuffle),alpha));
+	}
+	return i;
+}
+
+__attribute__((target("avx2")))
+static void rgb_to_rgba_avx2(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	size_t i = expand3_avx2(src,dst,count,
+		_mm256_setr_epi8(PIXEL_SHUFFLE_RGB,PIXEL_SHUFFLE_RGB));
+	rgb_to_rgba_scalar(src + 3*i,dst + 4*i,count - i);
+}
+
+__attribute__((target("avx2")))
+static void bgr_to_rgba_avx2(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	size_t i = expand3_avx2(src,dst,count,
+		_mm256_setr_epi8(PIXEL_SHUFFLE_BGR,PIXEL_SHUFFLE_BGR));
+	bgr_to_rgba_scalar(src + 3*i,dst + 4*i,count - i);
+}
+
+__attribute__((target("avx2")))
+static void bgra_to_rgba_avx2(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	const __m256i shuffle =
+		_mm256_setr_epi8(PIXEL_SHUFFLE_BGRA,PIXEL_SHUFFLE_BGRA);
+	size_t i = 0;
+	for(;i+8<=count;i+=8)
+	{
+		__m256i p = _mm256_loadu_si256((const __m256i*)(src + 4*i));
+		_mm256_storeu_si256((__m256i*)(dst + 4*i),_mm256_shuffle_epi8(p,shuffle));
+	}
+	bgra_to_rgba_scalar(src + 4*i,dst + 4*i,count - i);
+}
+
+__attribute__((target("avx2")))
+static void swap_rows_avx2(uint8_t* a, uint8_t* b, size_t bytes)
+{
+	size_t i = 0;
+	for(;i+32<=bytes;i+=32)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+		__m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+		_mm256_storeu_si256((__m256i*)(a + i),y);
+		_mm256_storeu_si256((__m256i*)(b + i),x);
+	}
+	swap_rows_scalar(a + i,b + i,bytes - i);
+}
+
+// Same as the SSE2 filter per 128 bit lane.  The pack interleaves the
+// lanes, the final permute puts the 8 output pixels back in order.
+__attribute__((target("avx2")))
+static void box_filter_avx2(const uint8_t* row0, const uint8_t* row1,
+	uint8_t* dst, size_t count)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i two = _mm256_set1_epi16(2);
+	size_t i = 0;
+	for(;i+8<=count;i+=8)
+	{
+		__m256i a0 = _mm256_loadu_si256((const __m256i*)(row0 + 8*i));
+		__m256i a1 = _mm256_loadu_si256((const __m256i*)(row0 + 8*i + 32));
+		__m256i b0 = _mm256_loadu_si256((const __m256i*)(row1 + 8*i));
+		__m256i b1 = _mm256_loadu_si256((const __m256i*)(row1 + 8*i + 32));
+		__m256i lo0 = _mm256_add_epi16(_mm256_unpacklo_epi8(a0,zero),
+			_mm256_unpacklo_epi8(b0,zero));
+		__m256i hi0 = _mm256_add_epi16(_mm256_unpackhi_epi8(a0,zero),
+			_mm256_unpackhi_epi8(b0,zero));
+		__m256i lo1 = _mm256_add_epi16(_mm256_unpacklo_epi8(a1,zero),
+			_mm256_unpacklo_epi8(b1,zero));
+		__m256i hi1 = _mm256_add_epi16(_mm256_unpackhi_epi8(a1,zero),
+			_mm256_unpackhi_epi8(b1,zero));
+		__m256i o0 = _mm256_add_epi16(_mm256_unpacklo_epi64(lo0,hi0),
+			_mm256_unpackhi_epi64(lo0,hi0));
+		__m256i o1 = _mm256_add_epi16(_mm256_unpacklo_epi64(lo1,hi1),
+			_mm256_unpackhi_epi64(lo1,hi1));
+		o0 = _mm256_srli_epi16(_mm256_add_epi16(o0,two),2);
+		o1 = _mm256_srli_epi16(_mm256_add_epi16(o1,two),2);
+		__m256i packed = _mm256_packus_epi16(o0,o1);
+		_mm256_storeu_si256((__m256i*)(dst + 4*i),
+			_mm256_permute4x64_epi64(packed,_MM_SHUFFLE(3,1,2,0)));
+	}
+	box_filter_sse2(row0 + 8*i,row1 + 8*i,dst + 4*i,count - i);
+}
+
+static const PixelKernels AVX2_KERNELS = {
+	rgb_to_rgba_avx2,
+	bgr_to_rgba_avx2,
+	bgra_to_rgba_avx2,
+	swap_rows_avx2,
+	box_filter_avx2
+};
+
+#endif
+
+#if PIXEL_NEON
+
+//	NEON, structured loads do the deinterleaving
+
+static void rgb_to_rgba_neon(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	size_t i = 0;
+	for(;i+16<=count;i+=16)
+	{
+		uint8x16x3_t p = vld3q_u8(src + 3*i);
+		uint8x16x4_t q;
+		q.val[0] = p.val[0];
+		q.val[1] = p.val[1];
+		q.val[2] = p.val[2];
+		q.val[3] = vdupq_n_u8(255);
+		vst4q_u8(dst + 4*i,q);
+	}
+	rgb_to_rgba_scalar(src + 3*i,dst + 4*i,count - i);
+}
+
+static void bgr_to_rgba_neon(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	size_t i = 0;
+	for(;i+16<=count;i+=16)
+	{
+		uint8x16x3_t p = vld3q_u8(src + 3*i);
+		uint8x16x4_t q;
+		q.val[0] = p.val[2];
+		q.val[1] = p.val[1];
+		q.val[2] = p.val[0];
+		q.val[3] = vdupq_n_u8(255);
+		vst4q_u8(dst + 4*i,q);
+	}
+	bgr_to_rgba_scalar(src + 3*i,dst + 4*i,count - i);
+}
+
+static void bgra_to_rgba_neon(const uint8_t* src, uint8_t* dst, size_t count)
+{
+	size_t i = 0;
+	for(;i+16<=count;i+=16)
+	{
+		uint8x16x4_t p = vld4q_u8(src + 4*i);
+		uint8x16_t b = p.val[0];
+		p.val[0] = p.val[2];
+		p.val[2] = b;
+		vst4q_u8(dst + 4*i,p);
+	}
+	bgra_to_rgba_scalar(src + 4*i,dst + 4*i,count - i);
+}
+
+static void swap_rows_neon(uint8_t* a, uint8_t* b, size_t bytes)
+{
+	size_t i = 0;
+	for(;i+16<=bytes;i+=16)
+	{
+		uint8x16_t x = vld1q_u8(a + i);
+		uint8x16_t y = vld1q_u8(b + i);
+		vst1q_u8(a + i,y);
+		vst1q_u8(b + i,x);
+	}
+	swap_rows_scalar(a + i,b + i,bytes - i);
+}
+
+static void box_filter_neon(const uint8_t* row0, const uint8_t* row1,
+	uint8_t* dst, size_t count)
+{
+	size_t i = 0;
+	for(;i+8<=count;i+=8)
+	{
+		uint8x16x4_t a = vld4q_u8(row0 + 8*i);
+		uint8x16x4_t b = vld4q_u8(row1 + 8*i);
+		uint8x8x4_t o;
+		for(int k=0;k!=4;k++)
+		{
+			uint16x8_t sum = vaddq_u16(vpaddlq_u8(a.val[k]),vpaddlq_u8(b.val[k]));
+			o.val[k] = vrshrn_n_u16(sum,2);
+		}
+		vst4_u8(dst + 4*i,o);
+	}
+	box_filter_scalar(row0 + 8*i,row1 + 8*i,dst + 4*i,count - i);
+}
+
+static const PixelKernels NEON_KERNELS = {
+	rgb_to_rgba_neon,
+	bgr_to_rgba_neon,
+	bgra_to_rgba_neon,
+	swap_rows_neon,
+	box_filter_neon
+};
+
+#endif
+
+//	Dispatch
+
+static bool simd_supported(PixelSIMD simd)
+{
+	switch(simd)
+	{
+	case PIXEL_SIMD_SCALAR:
+		return true;
+#if PIXEL_X86
+	case PIXEL_SIMD_SSSE3:
+		return cpu_supports(CPU_SSSE3);
+	case PIXEL_SIMD_AVX2:
+		return cpu_supports(CPU_AVX2);
+#endif
+#if PIXEL_NEON
+	case PIXEL_SIMD_NEON:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+static const PixelKernels& simd_kernels(PixelSIMD simd)
+{
+	switch(simd)
+	{
+#if PIXEL_X86
+	case PIXEL_SIMD_SSSE3:
+		return SSSE3_KERNELS;
+	case PIXEL_SIMD_AVX2:
+		return AVX2_KERNELS;
+#endif
+#if PIXEL_NEON
+	case PIXEL_SIMD_NEON:
+		return NEON_KERNELS;
+#endif
+	default:
+		return SCALAR_KERNELS;
+	}
+}
+
+static PixelSIMD best_simd()
+{
+	const PixelSIMD order[] = {
+		PIXEL_SIMD_AVX2,PIXEL_SIMD_NEON,PIXEL_SIMD_SSSE3
+	};
+	for(size_t i=0;i!=sizeof(order)/sizeof(order[0]);i++)
+	{
+		if(simd_supported(order[i]))
+			return order[i];
+	}
+	return PIXEL_SIMD_SCALAR;
+}
+
+static PixelSIMD current = best_simd();
+static const PixelKernels* kernels = &simd_kernels(current);
+
+PixelSIMD pixel_simd()
+{
+	return current;
+}
+
+bool set_pixel_simd(PixelSIMD simd)
+{
+	if(!simd_supported(simd))
+		return false;
+	current = simd;
+	kernels = &simd_kernels(simd);
+	return true;
+}
+
+const char* pixel_simd_name(PixelSIMD simd)
+{
+	switch(simd)
+	{
+	case PIXEL_SIMD_SSSE3:
+		return "ssse3";
+	case PIXEL_SIMD_AVX2:
+		return "avx2";
+	case PIXEL_SIMD_NEON:
+		return "neon";
+	default:
+		return "scalar";
+	}
+}
+
+void convert_row(PixelLayout layout, const uint8_t* src, uint8_t* dst,
+	size_t count)
+{
+	switch(layout)
+	{
+	case PIXEL_RGB:
+		kernels->rgb_to_rgba(src,dst,count);
+		break;
+	case PIXEL_BGR:
+		kernels->bgr_to_rgba(src,dst,count);
+		break;
+	case PIXEL_RGBA:
+		if(src != dst)
+			memcpy(dst,src,count*4);
+		break;
+	case PIXEL_BGRA:
+		kernels->bgra_to_rgba(src,dst,count);
+		break;
+	}
+}
+
+void convert_image(PixelLayout layout, const uint8_t* src, size_t pitch,
+	uint32_t width, uint32_t height, uint8_t* dst, bool flip)
+{
+	for(uint32_t y=0;y!=height;y++)
+	{
+		uint32_t row = flip ? height - 1 - y : y;
+		convert_row(layout,src + row*pitch,dst + (size_t)y*width*4,width);
+	}
+}
+
+void box_filter_row(const uint8_t* row0, const uint8_t* row1, uint8_t* dst,
+	size_t count)
+{
+	kernels->box_filter(row0,row1,dst,count);
+}
+
+void flip_rows(uint8_t* pixels, size_t pitch, uint32_t height)
+{
+	for(uint32_t y=0;y<height/2;y++)
+		kernels->swap_rows(pixels + y*pitch,pixels + (height-1-y)*pitch,pitch);
+}
+
+bool surface_layout(const SDL_Surface* surface, PixelLayout& layout)
+{
+	const SDL_PixelFormat* f = surface->format;
+	// Masks are of the pixel read as a native integer, little endian only.
+	if(f->BytesPerPixel == 4 && f->Amask == 0xff000000 && f->Gmask == 0x0000ff00)
+	{
+		if(f->Rmask == 0x000000ff && f->Bmask == 0x00ff0000)
+			layout = PIXEL_RGBA;
+		else if(f->Rmask == 0x00ff0000 && f->Bmask == 0x000000ff)
+			layout = PIXEL_BGRA;
+		else
+			return false;
+		return true;
+	}
+	if(f->BytesPerPixel == 3 && f->Gmask == 0x00ff00)
+	{
+		if(f->Rmask == 0x0000ff && f->Bmask == 0xff0000)
+			layout = PIXEL_RGB;
+		else if(f->Rmask == 0xff0000 && f->Bmask == 0x0000ff)
+			layout = PIXEL_BGR;
+		else
+			return false;
+		return true;
+	}
+	return false;
+}
+
+bool surface_to_rgba(SDL_Surface* surface, vector<uint8_t>& rgba, bool flip)
+{
+	PixelLayout layout;
+	SDL_Surface* conv = 0;
+	if(!surface_layout(surface,layout))
+	{
+		// Palettes, 16 bit and masks without alpha, none of which the maps
+		// use.  SDL gets them to RGBA the slow way.
+		conv = SDL_ConvertSurfaceFormat(surface,SDL_PIXELFORMAT_ABGR8888,0);
+		if(!conv)
+			return false;
+		surface = conv;
+		layout = PIXEL_RGBA;
+	}
+
+	SDL_LockSurface(surface);
+	rgba.resize((size_t)surface->w*surface->h*4);
+	convert_image(layout,(const uint8_t*)surface->pixels,surface->pitch,
+		surface->w,surface->h,rgba.data(),flip);
+	SDL_UnlockSurface(surface);
+
+	if(conv)
+		SDL_FreeSurface(conv);
+	return true;
+}
@@ -0,0 +1,71 @@
+#include "ResolutionController.h"
+using namespace std;
+
+const float ResolutionController::STEP = 1.0f / 16;
+const double ResolutionController::HEADROOM = 0.85;
+const int ResolutionController::SETTLE_FRAMES;
+const int ResolutionController::RAISE_FRAMES;
+
+// How much of every new time goes into the average.
+static const double SMOOTHING = 0.2;
+
+static float quantize(float scale)
+{
+  return floor(scale / ResolutionController::STEP + 1e-3f) *
+    ResolutionController::STEP;
+}
+
+ResolutionController::ResolutionController(double milliseconds,
+  float minScale, float maxScale)
+  :target_(milliseconds),min_(max(quantize(minScale),STEP)),
+   max_(max(quantize(maxScale),STEP)),scale_(max_),average_(-1),settle_(0),
+   under_(0)
+{
+  min_ = min(min_,max_);
+}
+
+void ResolutionController::Update(double milliseconds)
+{
+  if(settle_ > 0)
+  {
+    settle_--;
+    return;
+  }
+  if(average_ < 0)
+    average_ = milliseconds;
+  else
+    average_ += (milliseconds - average_) * SMOOTHING;
+
+  // The scale the average would have been on target at.
+  float ideal = max_;
+  if(average_ > 0)
+    ideal = scale_ * (float)sqrt(target_ * HEADROOM / average_);
+
+  float next = scale_;
+  if(average_ > target_)
+  {
+    next = quantize(ideal);
+    under_ = 0;
+  }
+  else if(ideal >= scale_ + STEP)
+  {
+    if(++under_ < RAISE_FRAMES)
+      return;
+    next = scale_ + STEP;
+    under_ = 0;
+  }
+  else
+  {
+    under_ = 0;
+  }
+
+  next = min(max(next,min_),max_);
+  if(next == scale_)
+    return;
+
+  // Carry the average over to the new size, the frames already timed at
+  // the old one would only pull it back.
+  average_ *= (next * next) / (scale_ * scale_);
+  scale_ = next;
+  settle_ = SETTLE_FRAMES;
+}
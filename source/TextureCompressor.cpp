@@ -0,0 +1,538 @@
+#include "TextureCompressor.h"
+#include "PixelFormat.h"
+#include "JobSystem.h"
+#include "Trace.h"
+#include "MemoryTracker.h"
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_image.h"
+#include <thread>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Runs body over [0,count) on the job system, a row at a time at least.
+// Small ranges stay on the calling thread.
+static void parallel_range(uint32_t count,
+	const function<void(uint32_t,uint32_t)>& body)
+{
+	JobSystem::Instance().ParallelFor(count,1,[&](size_t begin, size_t end)
+	{
+		body((uint32_t)begin,(uint32_t)end);
+	});
+}
+
+// Levels smaller than this aren't worth splitting into jobs.
+static const size_t MIN_PARALLEL_PIXELS = 256*256;
+
+static uint16_t pack_565(const float* c)
+{
+	int r = (int)(c[0] * (31.0f/255.0f) + 0.5f);
+	int g = (int)(c[1] * (63.0f/255.0f) + 0.5f);
+	int b = (int)(c[2] * (31.0f/255.0f) + 0.5f);
+	r = max(0,min(31,r));
+	g = max(0,min(63,g));
+	b = max(0,min(31,b));
+	return (r << 11) | (g << 5) | b;
+}
+
+static void unpack_565(uint16_t c, float* out)
+{
+	uint32_t r = (c >> 11) & 31;
+	uint32_t g = (c >> 5) & 63;
+	uint32_t b = c & 31;
+	out[0] = (float)((r << 3) | (r >> 2));
+	out[1] = (float)((g << 2) | (g >> 4));
+	out[2] = (float)((b << 3) | (b >> 2));
+}
+
+// Endpoints are the extremes of the block along its principal axis, the
+// indices come from projecting every pixel onto the quantized segment.
+static void compress_color_block(const uint8_t* rgba, uint8_t* block)
+{
+	alignas(16) float r[16];
+	alignas(16) float g[16];
+	alignas(16) float b[16];
+	float mean[3] = {0,0,0};
+	for(int i=0;i!=16;i++)
+	{
+		r[i] = rgba[i*4+0];
+		g[i] = rgba[i*4+1];
+		b[i] = rgba[i*4+2];
+		mean[0] += r[i];
+		mean[1] += g[i];
+		mean[2] += b[i];
+	}
+	mean[0] /= 16;
+	mean[1] /= 16;
+	mean[2] /= 16;
+
+	float cov[6] = {0,0,0,0,0,0};
+	for(int i=0;i!=16;i++)
+	{
+		float dr = r[i] - mean[0];
+		float dg = g[i] - mean[1];
+		float db = b[i] - mean[2];
+		cov[0] += dr*dr;
+		cov[1] += dr*dg;
+		cov[2] += dr*db;
+		cov[3] += dg*dg;
+		cov[4] += dg*db;
+		cov[5] += db*db;
+	}
+
+	// A few power iterations are plenty for a 3x3 symmetric matrix.
+	float axis[3] = {1,1,1};
+	for(int k=0;k!=4;k++)
+	{
+		float x = cov[0]*axis[0] + cov[1]*axis[1] + cov[2]*axis[2];
+		float y = cov[1]*axis[0] + cov[3]*axis[1] + cov[4]*axis[2];
+		float z = cov[2]*axis[0] + cov[4]*axis[1] + cov[5]*axis[2];
+		float m = max(fabsf(x),max(fabsf(y),fabsf(z)));
+		if(m <= 0)
+			break;
+		axis[0] = x/m;
+		axis[1] = y/m;
+		axis[2] = z/m;
+	}
+
+	float lo = 0, hi = 0;
+	for(int i=0;i!=16;i++)
+	{
+		float p = (r[i]-mean[0])*axis[0] + (g[i]-mean[1])*axis[1] +
+			(b[i]-mean[2])*axis[2];
+		lo = min(lo,p);
+		hi = max(hi,p);
+	}
+	float len = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+	float e0[3], e1[3];
+	for(int k=0;k!=3;k++)
+	{
+		e0[k] = mean[k] + axis[k]*hi/len;
+		e1[k] = mean[k] + axis[k]*lo/len;
+	}
+
+	uint16_t c0 = pack_565(e0);
+	uint16_t c1 = pack_565(e1);
+	if(c0 < c1)
+		swap(c0,c1);
+
+	block[0] = c0 & 0xff;
+	block[1] = c0 >> 8;
+	block[2] = c1 & 0xff;
+	block[3] = c1 >> 8;
+	if(c0 == c1)
+	{
+		memset(block+4,0,4);
+		return;
+	}
+
+	unpack_565(c0,e0);
+	unpack_565(c1,e1);
+	float d[3] = {e0[0]-e1[0], e0[1]-e1[1], e0[2]-e1[2]};
+	float scale = 3.0f / (d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+	float base = (e1[0]*d[0] + e1[1]*d[1] + e1[2]*d[2]) * scale;
+
+	// Position along e1->e0 in thirds, 0 at c1 and 3 at c0.
+	alignas(16) int32_t steps[16];
+#if defined(__SSE2__)
+	__m128 dr = _mm_set1_ps(d[0]*scale);
+	__m128 dg = _mm_set1_ps(d[1]*scale);
+	__m128 db = _mm_set1_ps(d[2]*scale);
+	__m128 offset = _mm_set1_ps(0.5f - base);
+	__m128 zero = _mm_setzero_ps();
+	__m128 three = _mm_set1_ps(3.0f);
+	for(int i=0;i!=16;i+=4)
+	{
+		__m128 t = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_load_ps(r+i),dr),
+				_mm_mul_ps(_mm_load_ps(g+i),dg)),
+			_mm_add_ps(_mm_mul_ps(_mm_load_ps(b+i),db),offset));
+		t = _mm_min_ps(_mm_max_ps(t,zero),three);
+		_mm_store_si128((__m128i*)(steps+i),_mm_cvttps_epi32(t));
+	}
+#else
+	for(int i=0;i!=16;i++)
+	{
+		float t = (r[i]*d[0] + g[i]*d[1] + b[i]*d[2])*scale - base + 0.5f;
+		steps[i] = (int32_t)max(0.0f,min(3.0f,t));
+	}
+#endif
+
+	static const uint32_t remap[4] = {1,3,2,0};
+	uint32_t bits = 0;
+	for(int i=0;i!=16;i++)
+		bits |= remap[steps[i]] << (2*i);
+	block[4] = bits & 0xff;
+	block[5] = (bits >> 8) & 0xff;
+	block[6] = (bits >> 16) & 0xff;
+	block[7] = bits >> 24;
+}
+
+static void compress_alpha_block(const uint8_t* rgba, uint8_t* block)
+{
+	uint32_t lo = 255, hi = 0;
+	for(int i=0;i!=16;i++)
+	{
+		lo = min(lo,(uint32_t)rgba[i*4+3]);
+		hi = max(hi,(uint32_t)rgba[i*4+3]);
+	}
+
+	block[0] = hi;
+	block[1] = lo;
+	uint64_t bits = 0;
+	if(hi != lo)
+	{
+		// Eight value mode, 7 at hi and 0 at lo.
+		uint32_t range = hi - lo;
+		for(int i=0;i!=16;i++)
+		{
+			uint32_t t = ((rgba[i*4+3] - lo)*14 + range) / (2*range);
+			uint64_t index = t == 7 ? 0 : t == 0 ? 1 : 8 - t;
+			bits |= index << (3*i);
+		}
+	}
+	for(int i=0;i!=6;i++)
+		block[2+i] = (bits >> (8*i)) & 0xff;
+}
+
+void compress_bc1_block(const uint8_t* rgba, uint8_t* block)
+{
+	compress_color_block(rgba,block);
+}
+
+void compress_bc3_block(const uint8_t* rgba, uint8_t* block)
+{
+	compress_alpha_block(rgba,block);
+	compress_color_block(rgba,block+8);
+}
+
+void downsample_rgba(const uint8_t* src, uint32_t width, uint32_t height,
+	uint8_t* dst)
+{
+	uint32_t w = max(1u,width/2);
+	uint32_t h = max(1u,height/2);
+	if(width == 1)
+	{
+		for(uint32_t y=0;y!=h;y++)
+		{
+			const uint8_t* p0 = src + (2*y)*4;
+			const uint8_t* p1 = src + min(2*y+1,height-1)*4;
+			for(int k=0;k!=4;k++)
+				dst[y*4+k] = (p0[k] + p1[k] + 1) >> 1;
+		}
+		return;
+	}
+
+	// Rows of an odd height level only pair up with themselves at the end.
+	auto filter = [=](uint32_t begin, uint32_t end)
+	{
+		for(uint32_t y=begin;y!=end;y++)
+		{
+			const uint8_t* row0 = src + (size_t)(2*y)*width*4;
+			const uint8_t* row1 = src + (size_t)min(2*y+1,height-1)*width*4;
+			box_filter_row(row0,row1,dst + (size_t)y*w*4,w);
+		}
+	};
+	if((size_t)w*h >= MIN_PARALLEL_PIXELS)
+		parallel_range(h,filter);
+	else
+		filter(0,h);
+}
+
+static void compress_level(const uint8_t* rgba, uint32_t width,
+	uint32_t height, DDSFormat format, uint8_t* out)
+{
+	uint32_t bw = max(1u,(width+3)/4);
+	uint32_t bh = max(1u,(height+3)/4);
+	uint32_t stride = format == DDS_DXT1 ? 8 : 16;
+
+	parallel_range(bh,[=](uint32_t begin, uint32_t end)
+	{
+		uint8_t pixels[16*4];
+		for(uint32_t by=begin;by!=end;by++)
+		{
+			for(uint32_t bx=0;bx!=bw;bx++)
+			{
+				// Edge blocks repeat the last row/column.
+				for(uint32_t y=0;y!=4;y++)
+				{
+					uint32_t sy = min(by*4+y,height-1);
+					for(uint32_t x=0;x!=4;x++)
+					{
+						uint32_t sx = min(bx*4+x,width-1);
+						memcpy(pixels+(y*4+x)*4,rgba+(sy*width+sx)*4,4);
+					}
+				}
+				uint8_t* block = out + (by*bw+bx)*stride;
+				if(format == DDS_DXT1)
+					compress_bc1_block(pixels,block);
+				else
+					compress_bc3_block(pixels,block);
+			}
+		}
+	});
+}
+
+void build_mip_chain(const uint8_t* rgba, uint32_t width, uint32_t height,
+	DDSImage& image)
+{
+	image.format = DDS_RGBA8;
+	image.width = width;
+	image.height = height;
+	image.levels.clear();
+
+	uint32_t size = 0;
+	for(uint32_t w=width,h=height;;w=max(1u,w/2),h=max(1u,h/2))
+	{
+		DDSLevel level;
+		level.width = w;
+		level.height = h;
+		level.offset = size;
+		level.size = w*h*4;
+		image.levels.push_back(level);
+		size += level.size;
+		if(w == 1 && h == 1)
+			break;
+	}
+
+	image.data.resize(size);
+	memcpy(image.data.data(),rgba,image.levels[0].size);
+	for(size_t i=1;i!=image.levels.size();i++)
+	{
+		const DDSLevel& src = image.levels[i-1];
+		downsample_rgba(&image.data[src.offset],src.width,src.height,
+			&image.data[image.levels[i].offset]);
+	}
+}
+
+void compress_image(const uint8_t* rgba, uint32_t width, uint32_t height,
+	DDSImage& image)
+{
+	bool alpha = false;
+	for(size_t i=0;i!=(size_t)width*height && !alpha;i++)
+		alpha = rgba[i*4+3] != 255;
+
+	DDSImage chain;
+	build_mip_chain(rgba,width,height,chain);
+
+	image.format = alpha ? DDS_DXT5 : DDS_DXT1;
+	image.width = width;
+	image.height = height;
+	image.levels = chain.levels;
+
+	uint32_t size = 0;
+	for(size_t i=0;i!=image.levels.size();i++)
+	{
+		DDSLevel& level = image.levels[i];
+		level.offset = size;
+		level.size = dds_level_size(image.format,level.width,level.height);
+		size += level.size;
+	}
+	image.data.resize(size);
+
+	for(size_t i=0;i!=image.levels.size();i++)
+	{
+		const DDSLevel& level = image.levels[i];
+		compress_level(&chain.data[chain.levels[i].offset],
+			level.width,level.height,image.format,&image.data[level.offset]);
+	}
+}
+
+static bool surface_rgba(SDL_Surface* sf, vector<uint8_t>& rgba,
+	uint32_t& width, uint32_t& height)
+{
+	if(!sf)
+		return false;
+	width = sf->w;
+	height = sf->h;
+	bool ok = surface_to_rgba(sf,rgba);
+	SDL_FreeSurface(sf);
+	return ok;
+}
+
+bool load_rgba(const char* filename, vector<uint8_t>& rgba,
+	uint32_t& width, uint32_t& height)
+{
+	return surface_rgba(IMG_Load(filename),rgba,width,height);
+}
+
+static string mip_cache;
+
+// Bump when the filter or the stored format changes so stale chains
+// aren't picked up.
+static const uint64_t MIP_CACHE_VERSION = 3;
+
+void set_mip_cache(const string& directory)
+{
+	mip_cache = directory;
+	if(mip_cache.empty())
+		return;
+	if(mip_cache[mip_cache.size()-1] != '/')
+		mip_cache += '/';
+
+	// Create every missing directory along the way.
+	for(size_t i=1;i!=mip_cache.size();i++)
+	{
+		if(mip_cache[i] != '/')
+			continue;
+		string path = mip_cache.substr(0,i);
+#if defined(_WIN32) || defined(_WIN64)
+		mkdir(path.c_str());
+#else
+		mkdir(path.c_str(),0755);
+#endif
+	}
+}
+
+// FNV-1a, 64 bit.
+static uint64_t hash_bytes(const vector<uint8_t>& bytes)
+{
+	uint64_t hash = 14695981039346656037ull ^ MIP_CACHE_VERSION;
+	for(size_t i=0;i!=bytes.size();i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static bool read_file(const char* filename, vector<uint8_t>& bytes)
+{
+	ifstream fi(filename,ios::binary);
+	if(!fi)
+		return false;
+	fi.seekg(0,ios::end);
+	bytes.resize((size_t)fi.tellg());
+	fi.seekg(0);
+	fi.read((char*)bytes.data(),bytes.size());
+	return (bool)fi;
+}
+
+static bool is_dds(const char* filename)
+{
+	size_t length = strlen(filename);
+	return length > 4 && !strcasecmp(filename + length - 4, ".dds");
+}
+
+// Where the levels of filename can be read from without decoding it: the
+// file itself for DDS, its cached chain for anything else.  image gets the
+// format, size and levels of that file, but no data.  Images not in the
+// cache are decoded whole into image, which puts them there, and path is
+// left empty.
+static bool find_levels(const char* filename, string& path, DDSImage& image)
+{
+	if(is_dds(filename))
+	{
+		path = filename;
+		return read_dds_header(filename,image);
+	}
+
+	vector<uint8_t> file;
+	if(!read_file(filename,file))
+		return false;
+
+	string cached;
+	if(!mip_cache.empty())
+	{
+		char name[32];
+		snprintf(name,sizeof(name),"%016" PRIx64 ".dds",hash_bytes(file));
+		cached = mip_cache + name;
+		if(read_dds_header(cached.c_str(),image) && image.format == DDS_RGBA8)
+		{
+			path = cached;
+			return true;
+		}
+	}
+
+	path.clear();
+	vector<uint8_t> rgba;
+	uint32_t width, height;
+	SDL_RWops* rw = SDL_RWFromConstMem(file.data(),file.size());
+	if(!surface_rgba(IMG_Load_RW(rw,1),rgba,width,height))
+		return false;
+	build_mip_chain(rgba.data(),width,height,image);
+
+	if(!cached.empty())
+	{
+		// Streaming workers may be writing the same entry, only ever let
+		// a complete file show up under the real name.
+		ostringstream tmp;
+		tmp << cached << "." << this_thread::get_id();
+		if(write_dds(tmp.str().c_str(),image))
+		{
+			if(rename(tmp.str().c_str(),cached.c_str()))
+				remove(tmp.str().c_str());
+		}
+	}
+	return true;
+}
+
+bool load_image(const char* filename, DDSImage& image)
+{
+	TRACE_ZONE("load_image");
+	MemoryTagScope tag(MEMORY_TEXTURES);
+	if(is_dds(filename))
+		return read_dds(filename,image);
+
+	string path;
+	if(!find_levels(filename,path,image))
+		return false;
+	return path.empty() || read_dds(path.c_str(),image);
+}
+
+bool load_image_levels(const char* filename, size_t first, DDSImage& image)
+{
+	TRACE_ZONE("load_image_levels");
+	MemoryTagScope tag(MEMORY_TEXTURES);
+	if(is_dds(filename))
+		return read_dds_levels(filename,first,image);
+
+	string path;
+	DDSImage chain;
+	if(!find_levels(filename,path,chain) || first >= chain.levels.size())
+		return false;
+	if(!path.empty())
+		return read_dds_levels(path.c_str(),first,image);
+	slice_dds(chain,first,image);
+	return true;
+}
+
+bool load_image_tail(const char* filename, uint32_t max_size,
+	DDSImage& image, size_t& first, uint32_t& size)
+{
+	TRACE_ZONE("load_image_tail");
+	MemoryTagScope tag(MEMORY_TEXTURES);
+	string path;
+	DDSImage chain;
+	if(!find_levels(filename,path,chain))
+		return false;
+
+	size = max(chain.width,chain.height);
+	first = 0;
+	while(first+1 < chain.levels.size() &&
+		max(chain.levels[first].width,chain.levels[first].height) > max_size)
+		first++;
+
+	if(!path.empty())
+		return read_dds_levels(path.c_str(),first,image);
+	slice_dds(chain,first,image);
+	return true;
+}
+
+bool compress_file(const char* src, const char* dst)
+{
+	TRACE_ZONE("compress_file");
+	MemoryTagScope tag(MEMORY_TEXTURES);
+	vector<uint8_t> rgba;
+	uint32_t width, height;
+	if(!load_rgba(src,rgba,width,height))
+		return false;
+
+	DDSImage image;
+	compress_image(rgba.data(),width,height,image);
+	return write_dds(dst,image);
+}
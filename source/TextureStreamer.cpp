@@ -0,0 +1,228 @@
+#include "TextureStreamer.h"
+#include "TextureCompressor.h"
+#include "Trace.h"
+#include "MemoryTracker.h"
+
+TextureStreamer::TextureStreamer(size_t budget, uint32_t tailSize)
+  :budget_(budget),resident_(0),tailSize_(tailSize),frame_(0)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+  JobSystem::Instance().Wait(reads_);
+}
+
+Texture TextureStreamer::Load(const string& filename, GLenum wrap)
+{
+  TRACE_ZONE("TextureStreamer::Load");
+  MemoryTagScope tag(MEMORY_TEXTURES);
+  DDSImage tail;
+  size_t first;
+  uint32_t size;
+  if(!load_image_tail(filename.c_str(),tailSize_,tail,first,size))
+    return Texture();
+  return Load(filename,tail,first,size,wrap);
+}
+
+Texture TextureStreamer::Load(const string& filename, DDSImage& tail,
+  size_t first, uint32_t size, GLenum wrap)
+{
+  MemoryTagScope tag(MEMORY_TEXTURES);
+  if(tail.levels.empty())
+    return Texture();
+
+  Entry entry;
+  entry.filename = filename;
+  entry.size = size;
+  entry.tail = first;
+  entry.resident = entry.tail;
+  entry.wanted = entry.tail;
+  entry.pending = false;
+  entry.used = frame_;
+  entry.refused = -1;
+  entry.refusedBytes = 0;
+  entry.coarse = std::move(tail);
+  tail = DDSImage();
+
+  glGenTextures(1,&entry.texture);
+  glBindTexture(GL_TEXTURE_2D,entry.texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+    first + entry.coarse.levels.size() > 1 ?
+    GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     wrap);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     wrap);
+  entry.bytes = Texture::UploadLevels(entry.coarse);
+  entry.tailBytes = entry.bytes;
+  resident_ += entry.bytes;
+
+  GLuint texture = entry.texture;
+  if(!free_.empty())
+  {
+    lookup_[texture] = free_.back();
+    entries_[free_.back()] = std::move(entry);
+    free_.pop_back();
+  } else {
+    lookup_[texture] = entries_.size();
+    entries_.push_back(std::move(entry));
+  }
+  return Texture(texture);
+}
+
+void TextureStreamer::Release(GLuint texture)
+{
+  unordered_map<GLuint,size_t>::iterator it = lookup_.find(texture);
+  if(it == lookup_.end())
+    return;
+
+  size_t index = it->second;
+  Entry& entry = entries_[index];
+  lookup_.erase(it);
+  glDeleteTextures(1,&entry.texture);
+  resident_ -= entry.bytes;
+  entry.texture = 0;
+  entry.bytes = 0;
+  entry.tail = entry.resident = entry.wanted = 0;
+  entry.refused = -1;
+  entry.coarse = DDSImage();
+  entry.filename.clear();
+  // A read in flight still points here, Update frees it once that's in.
+  if(!entry.pending)
+    free_.push_back(index);
+}
+
+void TextureStreamer::Request(GLuint texture, float uvExtent, float pixels)
+{
+  unordered_map<GLuint,size_t>::iterator it = lookup_.find(texture);
+  if(it == lookup_.end())
+    return;
+
+  Entry& entry = entries_[it->second];
+  entry.used = frame_;
+
+  // One level per halving of texels per screen pixel.
+  float texels = entry.size * uvExtent;
+  int level = 0;
+  if(pixels > 0 && texels > pixels)
+    level = (int)floor(log2(texels / pixels));
+  entry.wanted = min(entry.wanted,min(level,entry.tail));
+}
+
+void TextureStreamer::Update()
+{
+  TRACE_ZONE("TextureStreamer::Update");
+  MemoryTagScope tag(MEMORY_TEXTURES);
+
+  // What MakeRoom could have at most: the unused budget and every texture
+  // nobody asked for this frame evicted to its tail.
+  size_t spare = budget_ > resident_ ? budget_ - resident_ : 0;
+  for(size_t i=0;i!=entries_.size();i++)
+  {
+    const Entry& entry = entries_[i];
+    if(entry.texture && entry.resident != entry.tail && entry.used != frame_)
+      spare += entry.bytes - entry.tailBytes;
+  }
+
+  for(size_t i=0;i!=entries_.size();i++)
+  {
+    Entry& entry = entries_[i];
+    // A level that found no room before isn't read again until it could.
+    if(entry.wanted <= entry.refused &&
+      entry.refusedBytes > spare + entry.bytes)
+      continue;
+    if(!entry.pending && entry.wanted < entry.resident)
+    {
+      Job job;
+      job.entry = i;
+      job.level = entry.wanted;
+      job.filename = entry.filename;
+      job.ok = false;
+      JobSystem::Instance().Run([this,job]() mutable { Read(job); },&reads_);
+      entry.pending = true;
+    }
+  }
+
+  vector<Job> done;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done.swap(done_);
+  }
+
+  for(size_t i=0;i!=done.size();i++)
+  {
+    Job& job = done[i];
+    Entry& entry = entries_[job.entry];
+    entry.pending = false;
+    if(!entry.texture)
+    {
+      free_.push_back(job.entry);
+      continue;
+    }
+    if(!job.ok || job.level >= entry.resident)
+      continue;
+
+    // Not worth making room for something nobody looked at this frame.
+    size_t bytes = 0;
+    for(size_t l=0;l!=job.image.levels.size();l++)
+      bytes += job.image.levels[l].size;
+    if(entry.used != frame_)
+      continue;
+    if(!MakeRoom(bytes,job.entry))
+    {
+      entry.refused = job.level;
+      entry.refusedBytes = bytes;
+      continue;
+    }
+
+    glBindTexture(GL_TEXTURE_2D,entry.texture);
+    resident_ -= entry.bytes;
+    entry.bytes = Texture::UploadLevels(job.image);
+    resident_ += entry.bytes;
+    entry.resident = job.level;
+    entry.refused = -1;
+  }
+
+  for(size_t i=0;i!=entries_.size();i++)
+    entries_[i].wanted = entries_[i].tail;
+  frame_++;
+}
+
+bool TextureStreamer::MakeRoom(size_t bytes, size_t keep)
+{
+  while(resident_ - entries_[keep].bytes + bytes > budget_)
+  {
+    // Least recently requested texture that holds more than its tail.
+    Entry* victim = 0;
+    for(size_t i=0;i!=entries_.size();i++)
+    {
+      Entry& entry = entries_[i];
+      if(i == keep || entry.resident == entry.tail || entry.used == frame_)
+        continue;
+      if(!victim || entry.used < victim->used)
+        victim = &entry;
+    }
+    if(!victim)
+      return false;
+    Evict(*victim);
+  }
+  return true;
+}
+
+void TextureStreamer::Evict(Entry& entry)
+{
+  glBindTexture(GL_TEXTURE_2D,entry.texture);
+  resident_ -= entry.bytes;
+  entry.bytes = Texture::UploadLevels(entry.coarse);
+  resident_ += entry.bytes;
+  entry.resident = entry.tail;
+}
+
+void TextureStreamer::Read(Job& job)
+{
+  TRACE_ZONE("TextureStreamer::Read");
+  job.ok = load_image_levels(job.filename.c_str(),job.level,job.image);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  done_.push_back(std::move(job));
+}
@@ -0,0 +1,146 @@
+#include "Trace.h"
+
+#include <atomic>
+#include <mutex>
+using namespace std;
+
+const size_t Trace::BUFFER_EVENTS;
+
+struct TraceEvent
+{
+  const char* name;
+  uint64_t begin;
+  uint64_t end;
+};
+
+// Written by its own thread only, the lock is for Dump.
+struct TraceBuffer
+{
+  std::mutex mutex;
+  uint32_t tid;
+  string name;
+  vector<TraceEvent> events;
+  uint64_t head;      // events recorded, the newest at head-1
+};
+
+struct TraceRegistry
+{
+  std::mutex mutex;
+  vector<TraceBuffer*> buffers;
+};
+
+// Never freed, threads still record while statics are torn down.
+static TraceRegistry& registry()
+{
+  static TraceRegistry* registry = new TraceRegistry;
+  return *registry;
+}
+
+static std::atomic<bool> gEnabled(true);
+static thread_local TraceBuffer* tBuffer = 0;
+
+static TraceBuffer& buffer()
+{
+  if(!tBuffer)
+  {
+    tBuffer = new TraceBuffer;
+    tBuffer->events.resize(Trace::BUFFER_EVENTS);
+    tBuffer->head = 0;
+
+    TraceRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    tBuffer->tid = r.buffers.size() + 1;
+    r.buffers.push_back(tBuffer);
+  }
+  return *tBuffer;
+}
+
+uint64_t Trace::Now()
+{
+  static const std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start).count();
+}
+
+void Trace::Record(const char* name, uint64_t begin, uint64_t end)
+{
+  if(!gEnabled.load(std::memory_order_relaxed))
+    return;
+
+  TraceBuffer& b = buffer();
+  std::lock_guard<std::mutex> lock(b.mutex);
+  TraceEvent& event = b.events[b.head % BUFFER_EVENTS];
+  event.name = name;
+  event.begin = begin;
+  event.end = end;
+  b.head++;
+}
+
+void Trace::SetThreadName(const char* name)
+{
+  TraceBuffer& b = buffer();
+  std::lock_guard<std::mutex> lock(b.mutex);
+  b.name = name;
+}
+
+void Trace::SetEnabled(bool enabled)
+{
+  gEnabled = enabled;
+}
+
+bool Trace::IsEnabled()
+{
+  return gEnabled;
+}
+
+bool Trace::Dump(const char* filename)
+{
+  FILE* file = fopen(filename,"w");
+  if(!file)
+    return false;
+
+  vector<TraceBuffer*> buffers;
+  {
+    TraceRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    buffers = r.buffers;
+  }
+
+  // Complete events, timestamps in microseconds.
+  fprintf(file,"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  bool first = true;
+  vector<TraceEvent> events;
+  for(size_t i=0;i!=buffers.size();i++)
+  {
+    TraceBuffer& b = *buffers[i];
+    string name;
+    {
+      std::lock_guard<std::mutex> lock(b.mutex);
+      uint64_t count = min<uint64_t>(b.head,BUFFER_EVENTS);
+      events.resize(count);
+      for(uint64_t k=0;k!=count;k++)
+        events[k] = b.events[(b.head - count + k) % BUFFER_EVENTS];
+      name = b.name;
+    }
+
+    if(name.empty())
+      name = "thread " + to_string(b.tid);
+    fprintf(file,"%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,"
+      "\"tid\":%u,\"args\":{\"name\":\"%s\"}}",first ? "" : ",\n",b.tid,
+      name.c_str());
+    first = false;
+
+    for(size_t k=0;k!=events.size();k++)
+    {
+      const TraceEvent& e = events[k];
+      fprintf(file,",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,"
+        "\"ts\":%.3f,\"dur\":%.3f}",e.name,b.tid,e.begin / 1000.0,
+        (e.end - e.begin) / 1000.0);
+    }
+  }
+  fprintf(file,"\n]}\n");
+
+  bool ok = !ferror(file);
+  return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,288 @@
+#include "UploadScheduler.h"
+#include "Texture.h"
+#include "Timer.h"
+#include "Trace.h"
+#include "MemoryTracker.h"
+
+// Smallest piece a buffer is split into, however little budget is left.
+static const size_t MIN_CHUNK = 64 << 10;
+
+UploadScheduler::UploadScheduler(double milliseconds, size_t bytes,
+  size_t stagingSize)
+  :milliseconds_(milliseconds),bytes_(bytes),staging_(STAGING_NONE),buffer_(0),
+   size_(stagingSize),mapped_(0),head_(0),inflight_(0),frameBytes_(0),
+   pending_(0)
+{
+  if(GLEW_ARB_buffer_storage && GLEW_ARB_sync)
+  {
+    GLbitfield flags =
+      GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1,&buffer_);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER,buffer_);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER,size_,0,flags);
+    mapped_ = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,0,size_,flags);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+    if(mapped_)
+    {
+      staging_ = STAGING_PERSISTENT;
+    } else {
+      glDeleteBuffers(1,&buffer_);
+      buffer_ = 0;
+    }
+  }
+  if(staging_ == STAGING_NONE && GLEW_ARB_pixel_buffer_object)
+  {
+    glGenBuffers(1,&buffer_);
+    staging_ = STAGING_PBO;
+  }
+}
+
+UploadScheduler::~UploadScheduler()
+{
+  for(size_t i=0;i!=frames_.size();i++)
+    glDeleteSync(frames_[i].fence);
+  if(staging_ == STAGING_PERSISTENT)
+  {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER,buffer_);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+  }
+  if(buffer_)
+    glDeleteBuffers(1,&buffer_);
+}
+
+GLuint UploadScheduler::QueueBuffer(GLenum target, const void* data,
+  size_t size, std::function<void()> done)
+{
+  // Allocating the storage is cheap, only filling it is spread out.
+  GLuint buffer;
+  glGenBuffers(1,&buffer);
+  glBindBuffer(target,buffer);
+  glBufferData(target,size,0,GL_STATIC_DRAW);
+  glBindBuffer(target,0);
+
+  Job job;
+  job.name = buffer;
+  job.target = target;
+  job.texture = false;
+  job.data = (const uint8_t*)data;
+  job.size = size;
+  job.next = 0;
+  job.first = 0;
+  job.done = done;
+  jobs_.push_back(job);
+  pending_ += size;
+  return buffer;
+}
+
+void UploadScheduler::QueueTexture(GLuint texture,
+  std::shared_ptr<DDSImage> image, size_t first, std::function<void()> done)
+{
+  Job job;
+  job.name = texture;
+  job.target = GL_TEXTURE_2D;
+  job.texture = true;
+  job.data = 0;
+  job.size = 0;
+  job.next = image->levels.size();
+  job.image = image;
+  job.first = first;
+  job.done = done;
+  for(size_t i=first;i!=image->levels.size();i++)
+    pending_ += Texture::LevelUploadSize(*image,i);
+  jobs_.push_back(job);
+}
+
+bool UploadScheduler::Finished(const Job& job)
+{
+  return job.texture ? job.next == job.first : job.next == job.size;
+}
+
+void UploadScheduler::Update()
+{
+  TRACE_ZONE("UploadScheduler::Update");
+  MemoryTagScope tag(MEMORY_RENDERER);
+  if(staging_ == STAGING_PERSISTENT)
+    Retire();
+  if(jobs_.empty())
+    return;
+
+  // Stage chunks in queue order until the budget is gone.  At least one
+  // goes every frame so a level bigger than the budget still makes it.
+  double start = Timer::GetPreciseTimeInSeconds();
+  size_t spent = 0;
+  vector<Op> ops;
+  for(size_t j=0;j!=jobs_.size();j++)
+  {
+    Job& job = jobs_[j];
+    while(!Finished(job))
+    {
+      double elapsed = (Timer::GetPreciseTimeInSeconds() - start) * 1000.0;
+      if(!ops.empty() && (spent >= bytes_ || elapsed >= milliseconds_))
+        break;
+
+      ops.push_back(Op());
+      Op& op = ops.back();
+      op.job = &job;
+      op.source = 0;
+      op.offset = 0;
+      if(job.texture)
+      {
+        const DDSImage& image = *job.image;
+        size_t level = job.next - 1;
+        op.target = level;
+        op.size = Texture::LevelUploadSize(image,level);
+        if(Allocate(op.size,op.offset))
+        {
+          Texture::StageLevel(image,level,mapped_ + op.offset);
+        }
+        else if(!Texture::UploadsNative(image))
+        {
+          op.scratch.resize(op.size);
+          Texture::StageLevel(image,level,op.scratch.data());
+          op.source = op.scratch.data();
+        } else {
+          op.source = &image.data[image.levels[level].offset];
+        }
+        job.next--;
+      } else {
+        size_t left = bytes_ > spent ? bytes_ - spent : 0;
+        op.target = job.next;
+        op.size = min(job.size - job.next,max(left,MIN_CHUNK));
+        if(GLEW_ARB_copy_buffer && Allocate(op.size,op.offset))
+          memcpy(mapped_ + op.offset,job.data + job.next,op.size);
+        else
+          op.source = job.data + job.next;
+        job.next += op.size;
+      }
+      spent += op.size;
+    }
+    if(!Finished(job))
+      break;
+  }
+
+  if(staging_ == STAGING_PBO && mapped_)
+  {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER,buffer_);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+    mapped_ = 0;
+  }
+
+  for(size_t i=0;i!=ops.size();i++)
+    Issue(ops[i]);
+
+  if(staging_ == STAGING_PERSISTENT && frameBytes_)
+  {
+    Frame frame;
+    frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+    frame.bytes = frameBytes_;
+    frames_.push_back(frame);
+    inflight_ += frameBytes_;
+    frameBytes_ = 0;
+  }
+
+  // Jobs progress in order, so the finished ones are all at the front.
+  while(!jobs_.empty() && Finished(jobs_.front()))
+  {
+    std::function<void()> done = jobs_.front().done;
+    jobs_.pop_front();
+    if(done)
+      done();
+  }
+}
+
+bool UploadScheduler::Allocate(size_t size, size_t& offset)
+{
+  // Unpack offsets stay aligned for any pixel format.
+  size = (size + 15) & ~(size_t)15;
+  if(staging_ == STAGING_NONE || size > size_)
+    return false;
+
+  if(staging_ == STAGING_PBO)
+  {
+    if(!mapped_)
+    {
+      // Orphan whatever the GL may still be reading from last frame
+      // instead of waiting for it.
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER,buffer_);
+      glBufferData(GL_PIXEL_UNPACK_BUFFER,size_,0,GL_STREAM_DRAW);
+      mapped_ = (uint8_t*)glMapBuffer(GL_PIXEL_UNPACK_BUFFER,GL_WRITE_ONLY);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+      head_ = 0;
+      if(!mapped_)
+        return false;
+    }
+    if(head_ + size > size_)
+      return false;
+    offset = head_;
+    head_ += size;
+    return true;
+  }
+
+  // Ring buffer, a chunk that doesn't fit before the end starts over at
+  // the beginning and the rest of the end is skipped.
+  size_t begin = head_;
+  size_t skipped = 0;
+  if(begin + size > size_)
+  {
+    skipped = size_ - begin;
+    begin = 0;
+  }
+  if(inflight_ + frameBytes_ + skipped + size > size_)
+    return false;
+  frameBytes_ += skipped + size;
+  head_ = begin + size;
+  offset = begin;
+  return true;
+}
+
+void UploadScheduler::Retire()
+{
+  while(!frames_.empty())
+  {
+    GLenum status = glClientWaitSync(frames_.front().fence,0,0);
+    if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+      break;
+    glDeleteSync(frames_.front().fence);
+    inflight_ -= frames_.front().bytes;
+    frames_.pop_front();
+  }
+}
+
+void UploadScheduler::Issue(Op& op)
+{
+  Job& job = *op.job;
+  const GLvoid* pixels = op.source;
+  if(!op.source)
+  {
+    glBindBuffer(job.texture ? GL_PIXEL_UNPACK_BUFFER : GL_COPY_READ_BUFFER,
+      buffer_);
+    pixels = (const GLvoid*)op.offset;
+  }
+
+  if(job.texture)
+  {
+    GLint level = op.target - job.first;
+    glBindTexture(GL_TEXTURE_2D,job.name);
+    if(op.target + 1 == job.image->levels.size())
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level);
+    Texture::UploadLevel(*job.image,op.target,level,pixels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+    if(!op.source)
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+  }
+  else if(!op.source)
+  {
+    glBindBuffer(GL_COPY_WRITE_BUFFER,job.name);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER,GL_COPY_WRITE_BUFFER,
+      op.offset,op.target,op.size);
+    glBindBuffer(GL_COPY_WRITE_BUFFER,0);
+    glBindBuffer(GL_COPY_READ_BUFFER,0);
+  } else {
+    glBindBuffer(job.target,job.name);
+    glBufferSubData(job.target,op.target,op.size,op.source);
+    glBindBuffer(job.target,0);
+  }
+  pending_ -= op.size;
+}
@@ -11,6 +11,9 @@
 
 #include "Math/Vector3.h"
 #include "Math/Matrix4.h"
+#include "Math/Quaternion.h"
+#include "Math/Vector3Stream.h"
+#include "Math/Frustum.h"
 
 #if defined(_WIN32) || defined(_WIN64)
   #undef main
@@ -30,8 +33,20 @@
 #include "Renderer.h"
 #include "Program.h"
 #include "Shader.h"
+#include "PixelFormat.h"
 #include "Texture.h"
+#include "TextureCompressor.h"
+#include "TextureStreamer.h"
+#include "UploadScheduler.h"
+#include "ChunkStreamer.h"
 #include "Window.h"
+#include "JobSystem.h"
+#include "Trace.h"
+#include "MemoryTracker.h"
+#include "FrameArena.h"
+#include "GpuTimer.h"
+#include "ResolutionController.h"
+#include "Assert.h"
 using namespace std;
 
 const int WIDTH = 1280;
@@ -76,42 +91,23 @@ GLuint gdtexture(const char* file)
 
 }
 
-SDL_Surface* flipVert(SDL_Surface* sfc)
+void screenshot(int width, int height)
 {
-  SDL_Surface* result = SDL_CreateRGBSurface(sfc->flags, sfc->w, sfc->h,
-    sfc->format->BytesPerPixel * 8, sfc->format->Rmask, sfc->format->Gmask,
-    sfc->format->Bmask, sfc->format->Amask);
-  if (result == NULL) return NULL;
+  SDL_Surface * sf = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0);
 
-  uint8_t* pixels = (uint8_t*) sfc->pixels;
-  uint8_t* rpixels = (uint8_t*) result->pixels;
+  // SDL pads rows to 4 bytes, the same as the default GL_PACK_ALIGNMENT.
+  glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, sf->pixels);
 
-  uint32_t pitch = sfc->pitch;
-  uint32_t pxlength = pitch*sfc->h;
-
-  for(int line = 0; line < sfc->h; ++line) {
-    uint32_t pos = line * pitch;
-    memcpy(&rpixels[pos], &pixels[(pxlength-pos)-pitch], pitch);
-  }
-
-  return result;
-}
-
-void screenshot()
-{
-  SDL_Surface * sf = SDL_CreateRGBSurface(SDL_SWSURFACE, WIDTH, HEIGHT, 24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0);
-
-  glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, sf->pixels);
-
-  SDL_Surface * flip = flipVert(sf);
-  SDL_SaveBMP(flip,"screenshot.bmp");
+  // GL reads bottom up.
+  flip_rows((uint8_t*)sf->pixels,sf->pitch,height);
+  SDL_SaveBMP(sf,"screenshot.bmp");
 
   SDL_FreeSurface(sf);
-  SDL_FreeSurface(flip);
 }
 
 Program* map_default;
 Program* map_four_blend;
+Program* map_position;
 
 GLint fmvp;
 GLint ftex0;
@@ -123,84 +119,285 @@ GLint ftex4;
 GLint dtex;
 GLint dmvp;
 
-Program* split_1;
-GLint s1mvp;
-GLint s1tex0;
-GLint s1tex1;
-GLint s1mode;
+GLint pmvp;
+
+// The composite, built once per split mode and upscale filter.
+const int SPLIT_MODES = 5;
+enum Upscale
+{
+  UPSCALE_BILINEAR,
+  UPSCALE_SHARPEN,
+  UPSCALE_FILTERS
+};
+Program* split_1[SPLIT_MODES][UPSCALE_FILTERS];
+GLint s1mvp[SPLIT_MODES][UPSCALE_FILTERS];
+GLint s1tex0[SPLIT_MODES][UPSCALE_FILTERS];
+GLint s1tex1[SPLIT_MODES][UPSCALE_FILTERS];
+GLint s1texel[SPLIT_MODES][UPSCALE_FILTERS];
+GLint s1sharpness[SPLIT_MODES][UPSCALE_FILTERS];
+
+// The columns of each map's frame a split mode shows, as fractions of the
+// width, and nothing for a map it doesn't show.  SPLIT_1.frag decides.
+const float splitColumns[SPLIT_MODES][2][2] = {
+  {{0,1},{0,0}},
+  {{0,0},{0,1}},
+  {{0,0.5f},{0.5f,1}},
+  {{0.5f,1},{0,0.5f}},
+  {{0.25f,0.75f},{0.25f,0.75f}}
+};
 
 class RiotMap
 {
 public:
+  // Compress png-only textures to a DDS next to them on first load.
+  static bool compressTextures;
+  // Load textures at a low mip and stream the rest, when set.
+  static TextureStreamer* streamer;
+  // Spread buffer and texture uploads over frames, when set.
+  static UploadScheduler* uploads;
+  // Keep only the cells within chunkRadius resident, when not 0.
+  static float chunkRadius;
+  static size_t chunkBudget;
+  // Lay down the depth of opaque geometry before shading it, when set.
+  static bool depthPrepass;
+  // Four-blend models farther than this draw their terrainbake texture
+  // when there is one, 0 never does.
+  static float bakeDistance;
+
+  // The pass a material is drawn in.  Four-blend terrain is opaque, the
+  // clamped (flag1 1) materials blend, the others are alpha tested only
+  // when their texture has cutouts.
+  enum Queue
+  {
+    QUEUE_OPAQUE,
+    QUEUE_ALPHA_TEST,
+    QUEUE_BLEND,
+    QUEUES
+  };
+
+  struct Bounds
+  {
+    Vector3f min;
+    Vector3f max;
+    float uv0;  // largest extent of the UV0 set, in texture repeats
+    float uv1;
+  };
+
+  // A texture file as the constructor read it, once per file and wrap
+  // mode however many materials use it.
+  struct Image
+  {
+    string name;
+    GLenum wrap;
+    std::shared_ptr<DDSImage> image;  // until createObjects
+    // With a streamer image is only the tail from level first on, size
+    // is the largest side of level 0.
+    size_t first;
+    uint32_t size;
+    Texture texture;
+    bool cutout;  // has pixels the alpha test drops
+  };
+
   string folder;
   LOLMap* map;
+  vector<Image> images;
+  // Index into images of every material's eight slots, -1 for none.
+  vector<int> slots;
+  // The Queue of every material.
+  vector<uint8_t> queues;
+  // Index into images of every material's baked blend, -1 for none.
+  vector<int> baked;
   vector<vector<Texture> > texs;
   vector<GLuint> vbufs;
   vector<GLuint> ebufs;
-
-  RiotMap(string folder)
+  vector<Bounds> bounds;
+  // The same boxes as centers and half extents, for culling.
+  Vector3Streamf centers;
+  Vector3Streamf extents;
+  int pendingBuffers;
+  int pendingTextures;
+  // Owns the buffers instead of vbufs and ebufs in chunk mode.
+  ChunkStreamer* chunks;
+
+  // Reads the map, decodes its textures and computes the bounds without
+  // touching GL, so it can run on a worker.  createObjects does the rest
+  // on the main thread.
+  RiotMap(const string& folder)
+    :folder(folder),map(0),pendingBuffers(0),pendingTextures(0),chunks(0)
   {
-    this->folder = folder;
+    TRACE_ZONE("RiotMap::RiotMap");
+    MemoryTagScope tag(MEMORY_RENDERER);
     map = read_map((folder + "Scene/room.nvr").c_str());
 
+    std::map<pair<string,GLenum>,int> files;
+    slots.assign(map->num_material*8,-1);
     for(int i=0;i!=map->num_material;i++)
     {
-      vector<Texture> vt;
       for(int j=0;j!=8;j++)
       {
-        if(map->materials[i].textures[j].filename[0])
+        if(!map->materials[i].textures[j].filename[0])
+          continue;
+        string name = folder + "Scene/Textures/" +
+          map->materials[i].textures[j].filename;
+        GLenum wrap = map->materials[i].flag1 != 1 ? GL_REPEAT : GL_CLAMP;
+        pair<string,GLenum> key(name,wrap);
+        if(!files.count(key))
         {
-          string name = map->materials[i].textures[j].filename;
-          name = folder + "Scene/Textures/" +
-            name.substr(0,name.size()-3) + "png";
-          if(map->materials[i].flag1!=1)
+          files[key] = images.size();
+          images.push_back(Image());
+          images.back().name = name;
+          images.back().wrap = wrap;
+        }
+        slots[i*8+j] = files[key];
+      }
+    }
+
+    // What terrainbake wrote for the four-blend materials, over UV1.
+    baked.assign(map->num_material,-1);
+    for(int i=0;i!=map->num_material && bakeDistance > 0;i++)
+    {
+      if(map->materials[i].flag1 != 3)
+        continue;
+      string name = folder + "Scene/Baked/" + map->materials[i].name + ".dds";
+      if(!ifstream(name.c_str()))
+        continue;
+      baked[i] = images.size();
+      images.push_back(Image());
+      images.back().name = name;
+      images.back().wrap = GL_CLAMP;
+    }
+
+    readImages();
+    for(int i=0;i!=map->num_material;i++)
+      if(baked[i] >= 0 && !images[baked[i]].image)
+        baked[i] = -1;
+    queues.resize(map->num_material);
+    for(int i=0;i!=map->num_material;i++)
+    {
+      const LOLMapMaterial& mat = map->materials[i];
+      if(mat.flag1 == 1)
+        queues[i] = QUEUE_BLEND;
+      else if(mat.flag1 != 3 && slots[i*8] >= 0 && images[slots[i*8]].cutout)
+        queues[i] = QUEUE_ALPHA_TEST;
+      else
+        queues[i] = QUEUE_OPAQUE;
+    }
+    computeBounds();
+  }
+
+  // Only once busy() is false, uploads still hold on to the map before.
+  ~RiotMap()
+  {
+    delete chunks;
+    if(!vbufs.empty())
+      glDeleteBuffers(vbufs.size(),vbufs.data());
+    if(!ebufs.empty())
+      glDeleteBuffers(ebufs.size(),ebufs.data());
+    for(size_t i=0;i!=images.size();i++)
+    {
+      GLuint texture = images[i].texture.GetTexture();
+      if(!texture)
+        continue;
+      if(streamer)
+        streamer->Release(texture);
+      else
+        glDeleteTextures(1,&texture);
+    }
+    free_map(map);
+  }
+
+  bool busy() const
+  {
+    return pendingBuffers || pendingTextures || (chunks && !chunks->Idle());
+  }
+
+  void readImages()
+  {
+    TRACE_ZONE("RiotMap::readImages");
+    MemoryTagScope tag(MEMORY_TEXTURES);
+    JobSystem::Instance().ParallelFor(images.size(),1,
+      [this](size_t begin, size_t end)
+    {
+      for(size_t i=begin;i!=end;i++)
+      {
+        // Prefer the original DDS with its mip chain, older dumps only
+        // have the textures re-encoded as png.
+        Image& file = images[i];
+        file.image.reset(new DDSImage);
+        file.cutout = false;
+        if(!readImage(file,file.name))
+        {
+          string png = file.name.substr(0,file.name.size()-3) + "png";
+          if(!compressTextures ||
+            !compress_file(png.c_str(),file.name.c_str()) ||
+            !readImage(file,file.name))
           {
-            vt.push_back(Texture::CreateTextureFromFile(name.c_str()));
-          } else {
-            SDL_Surface* sf = IMG_Load(name.c_str());
-            if(!sf)
-              continue;
-            GLenum format = GL_RGBA;
-            if(sf->format->BytesPerPixel == 4)
+            file.name = png;
+            if(!readImage(file,png))
             {
-              if(sf->format->Rmask != 0x000000ff)
-                format = GL_BGRA;
-            } else {
-              if(sf->format->Rmask == 0x000000ff)
-                format = GL_RGB;
-              else
-                format = GL_BGR;
+              file.image.reset();
+              continue;
             }
-            GLuint texture_;
-            glGenTextures(1,&texture_);
-
-            glBindTexture(GL_TEXTURE_2D,texture_);
-
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP);
-
-            glTexImage2D(
-              GL_TEXTURE_2D, 0,           /* target, level of detail */
-              GL_RGBA,                    /* internal format */
-              sf->w, sf->h, 0,           /* width, height, border */
-              format, GL_UNSIGNED_BYTE,   /* external format, type */
-              sf->pixels                   /* pixels */
-            );
-            glGenerateMipmap(GL_TEXTURE_2D);
-            vt.push_back(Texture(texture_));
-            SDL_FreeSurface(sf);
           }
-
-        } else {
-          vt.push_back(Texture());
         }
+        // With only the tail read, level 0 may drop pixels the tail
+        // averaged into a partial alpha, so any alpha at all counts.
+        file.cutout = dds_has_cutout(*file.image,file.first ? 254 : 127);
       }
-      texs.push_back(vt);
+    });
+  }
+
+  // The streamer only needs the tail up front, it reads the rest itself.
+  bool readImage(Image& file, const string& name)
+  {
+    file.first = 0;
+    if(streamer)
+      return load_image_tail(name.c_str(),streamer->GetTailSize(),
+        *file.image,file.first,file.size);
+    return load_image(name.c_str(),*file.image);
+  }
+
+  // The GL objects of what the constructor read, on the main thread.
+  // With an UploadScheduler the data goes up over the next frames,
+  // pendingBuffers and pendingTextures count what is left.
+  void createObjects()
+  {
+    TRACE_ZONE("RiotMap::createObjects");
+    MemoryTagScope tag(MEMORY_RENDERER);
+    for(size_t i=0;i!=images.size();i++)
+    {
+      if(images[i].image)
+        images[i].texture = createTexture(images[i]);
+      images[i].image.reset();
     }
-    for(int m=0;m!=map->num_vertex_list;m++)
+    texs.assign(map->num_material,vector<Texture>(8));
+    for(int i=0;i!=map->num_material;i++)
+      for(int j=0;j!=8;j++)
+        if(slots[i*8+j] >= 0)
+          texs[i][j] = images[slots[i*8+j]].texture;
+
+    for(int m=0;m!=map->num_vertex_list && !chunkRadius;m++)
     {
+      if(uploads)
+      {
+        std::function<void()> done = [this]() { pendingBuffers--; };
+        vbufs.push_back(
+          uploads->QueueBuffer(GL_ARRAY_BUFFER,
+            map->vertex_lists[m].vertices,
+            map->vertex_lists[m].size,
+            done
+          )
+        );
+        ebufs.push_back(
+          uploads->QueueBuffer(GL_ELEMENT_ARRAY_BUFFER,
+            map->index_lists[m].indices,
+            map->index_lists[m].size,
+            done
+          )
+        );
+        pendingBuffers += 2;
+        continue;
+      }
       vbufs.push_back(
         glbuffer(GL_ARRAY_BUFFER,
           map->vertex_lists[m].vertices,
@@ -214,314 +411,575 @@ public:
         )
       );
     }
+
+    if(chunkRadius)
+      chunks = new ChunkStreamer(map,centers,extents,uploads,chunkRadius,
+        chunkBudget);
   }
 
-  void render(Matrix4f mvp)
+  Texture createTexture(Image& file)
   {
-    for(int m=0;m!=map->num_model;m++)
+    TRACE_ZONE("RiotMap::createTexture");
+    MemoryTagScope tag(MEMORY_TEXTURES);
+    if(streamer)
+      return streamer->Load(file.name,*file.image,file.first,file.size,
+        file.wrap);
+    if(uploads)
     {
-      if(map->materials[map->models[m].material].flag1 == 3 )
-      {
-        //continue;
-        // Four Blend
-        map_four_blend->Use();
-        glUniformMatrix4fv(fmvp, 1, GL_TRUE, mvp._m);
-
-        glUniform1i(ftex0,0);
-        glUniform1i(ftex1,1);
-        glUniform1i(ftex2,2);
-        glUniform1i(ftex3,3);
-        glUniform1i(ftex4,4);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D,texs[map->models[m].material][1].GetTexture());
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D,texs[map->models[m].material][0].GetTexture());
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D,texs[map->models[m].material][2].GetTexture());
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D,texs[map->models[m].material][4].GetTexture());
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D,texs[map->models[m].material][6].GetTexture());
-
-        glBindBuffer(GL_ARRAY_BUFFER,
-          vbufs[map->models[m].model[0].vertex_index]);
-
-        glVertexAttribPointer(
-          Program::POSITION,
-          3,
-          GL_FLOAT,
-          GL_FALSE,
-          sizeof(GLfloat)*11,
-          (const GLvoid*)(0)
-        );
-
-        glVertexAttribPointer(
-          Program::UV0,
-          2,
-          GL_FLOAT,
-          GL_FALSE,
-          sizeof(GLfloat)*11,
-          (const GLvoid*)(sizeof(GLfloat)*6)
-        );
-
-        glVertexAttribPointer(
-          Program::UV1,
-          2,
-          GL_FLOAT,
-          GL_FALSE,
-          sizeof(GLfloat)*11,
-          (const GLvoid*)(sizeof(GLfloat)*8)
-        );
-
+      Texture tex(*file.image,file.wrap,false);
+      pendingTextures++;
+      uploads->QueueTexture(tex.GetTexture(),file.image,0,
+        [this]() { pendingTextures--; });
+      return tex;
+    }
+    return Texture(*file.image,file.wrap);
+  }
 
-        glEnableVertexAttribArray(Program::POSITION);
-        glEnableVertexAttribArray(Program::UV0);
-        glEnableVertexAttribArray(Program::UV1);
+  // Bounds and UV extents of the vertices each model's indices use.
+  void computeBounds()
+  {
+    TRACE_ZONE("RiotMap::computeBounds");
+    bounds.resize(map->num_model);
+    centers.SetQuantity(map->num_model);
+    extents.SetQuantity(map->num_model);
+    // Every model writes only its own entries.
+    JobSystem::Instance().ParallelFor(map->num_model,64,
+      [this](size_t begin, size_t end)
+    {
+      for(int m=(int)begin;m!=(int)end;m++)
+      {
+        const LOLMapModelData& data = map->models[m].model[0];
+        const LOLMapMaterial& mat = map->materials[map->models[m].material];
+        const uint16_t* indices =
+          map->index_lists[data.index_index].indices + data.index_offset;
+        int s = mat.stride();
+
+        Bounds& b = bounds[m];
+        if(!data.index_length)
+        {
+          b.min = b.max = Vector3f::ZERO;
+          b.uv0 = b.uv1 = 0;
+          centers.Set(m,Vector3f::ZERO);
+          extents.Set(m,Vector3f::ZERO);
+          continue;
+        }
+        // A vertex list holds other models too, and a model's indices
+        // needn't cover a contiguous range of it.
+        const float* vertices =
+          map->vertex_lists[data.vertex_index].vertices;
+        int count = data.index_length;
+
+        Vector3Streamf::ComputeAABB(count,indices,vertices,s,b.min,b.max);
+        Vector3f lo, hi;
+        Vector3Streamf::ComputeAABB(count,indices,vertices + 6,s,lo,hi);
+        b.uv0 = max(hi.x-lo.x,hi.y-lo.y);
+        b.uv1 = 0;
+        if(mat.flag1 == 3)
+        {
+          Vector3Streamf::ComputeAABB(count,indices,vertices + 8,s,lo,hi);
+          b.uv1 = max(hi.x-lo.x,hi.y-lo.y);
+        }
+        centers.Set(m,(b.min + b.max) * 0.5f);
+        extents.Set(m,(b.max - b.min) * 0.5f);
+      }
+    });
+  }
 
+  // From eye to the closest point of model m's box, 0 inside it.
+  float distance(int m, const Vector3f& eye) const
+  {
+    const Bounds& b = bounds[m];
+    Vector3f d;
+    for(int k=0;k!=3;k++)
+      d[k] = max(max(b.min[k] - eye[k],eye[k] - b.max[k]),0.0f);
+    return d.Length();
+  }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
-          ebufs[map->models[m].model[0].index_index]);
-        glDrawElements(
-          GL_TRIANGLES,
-          map->models[m].model[0].index_length,
-          GL_UNSIGNED_SHORT,
-          (const GLvoid*)(sizeof(GLushort)*map->models[m].model[0].index_offset)
-        );
-        glDisableVertexAttribArray(Program::POSITION);
-        glDisableVertexAttribArray(Program::UV0);
-        glDisableVertexAttribArray(Program::UV1);
+  // Bring the cells around eye in and tell the streamer how large every
+  // model's textures end up on screen.  pixelScale is pixels covered by
+  // one unit at distance one.
+  void stream(const Vector3f& eye, float pixelScale)
+  {
+    TRACE_ZONE("RiotMap::stream");
+    if(chunks)
+      chunks->Update(eye);
+    if(!streamer)
+      return;
 
+    for(int m=0;m!=map->num_model;m++)
+    {
+      // Textures of cells that are gone fall back to their tail.
+      if(chunks && !chunks->IsResident(m))
+        continue;
+      const Bounds& b = bounds[m];
+      if(!b.uv0 && !b.uv1)
+        continue;
+
+      float d = distance(m,eye);
+      float pixels = (b.max - b.min).Length() * pixelScale / max(d,1.0f);
+
+      int material = map->models[m].material;
+      if(baked[material] >= 0)
+      {
+        streamer->Request(images[baked[material]].texture.GetTexture(),
+          b.uv1,pixels);
+        // The live blend is streamed in a little before it takes over.
+        if(d > bakeDistance * 1.5f)
+          continue;
+      }
+      if(map->materials[material].flag1 == 3)
+      {
+        streamer->Request(texs[material][1].GetTexture(),b.uv1,pixels);
+        streamer->Request(texs[material][0].GetTexture(),b.uv0,pixels);
+        streamer->Request(texs[material][2].GetTexture(),b.uv0,pixels);
+        streamer->Request(texs[material][4].GetTexture(),b.uv0,pixels);
+        streamer->Request(texs[material][6].GetTexture(),b.uv0,pixels);
+      } else {
+        streamer->Request(texs[material][0].GetTexture(),b.uv0,pixels);
       }
-    /*
     }
+  }
 
+  // Only the columns from x0 to x1, as fractions of the width, are
+  // culled for, the caller scissors to them.  eye is in map space, for
+  // the distance baked terrain starts at.
+  void render(Matrix4f mvp, const Vector3f& eye, float x0 = 0, float x1 = 1)
+  {
+    TRACE_ZONE("RiotMap::render");
+    // Nothing to draw before all the geometry is there.
+    if(pendingBuffers)
+      return;
+
+    // Narrow clip space x to the columns.
+    Matrix4f crop = Matrix4f::IDENTITY;
+    crop.m00 = 1 / (x1 - x0);
+    crop.m03 = (1 - x0 - x1) / (x1 - x0);
+
+    FrameVector<uint32_t> visible(Frustumf::GetMaskWords(map->num_model));
+    // mvp takes map space to clip space, so its planes cull the bounds
+    // as they are.
+    Frustumf frustum(crop * mvp);
+    frustum.CullBoxes(centers,extents,visible.data());
+
+    FrameVector<uint64_t> draws;
+    draws.reserve(map->num_model);
     for(int m=0;m!=map->num_model;m++)
     {
-      */
-      if(map->materials[map->models[m].material].flag1 == 1) {
-        //continue;
-        map_default->Use();
-
-        glUniformMatrix4fv(dmvp, 1, GL_TRUE, mvp._m);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D,texs[map->models[m].material][0].GetTexture());
-        glUniform1i(dtex,0);
-
-        glBindBuffer(GL_ARRAY_BUFFER,
-          vbufs[map->models[m].model[0].vertex_index]);
-
-        static int strides[] = {10,9,9,11};
-
-        int stride = strides[map->materials[map->models[m].material].flag1];
-        int uvoff = 6;
-
-        //if(map->materials[map->models[m].material].flag1 ==1  ) continue;
-        //if(map->materials[map->models[m].material].flag2 !=17 ) continue;
+      if(!Frustumf::IsVisible(visible.data(),m))
+        continue;
+      if(chunks && !chunks->IsReady(m))
+        continue;
+      if(map->materials[map->models[m].material].flag1 > 3)
+        continue;
+      draws.push_back(drawKey(m,mvp,eye));
+    }
+    sort(draws.begin(),draws.end());
 
-        //if(map->materials[map->models[m].material].flag1 ==3 ) uvoff = 6;
+    size_t ends[QUEUES];
+    for(int q=0;q!=QUEUES;q++)
+      ends[q] = lower_bound(draws.begin(),draws.end(),
+        (uint64_t)(q + 1) << 62) - draws.begin();
 
-        glVertexAttribPointer(
-          Program::POSITION,
-          3,
-          GL_FLOAT,
-          GL_FALSE,
-          sizeof(GLfloat)*stride,
-          (const GLvoid*)(0)
-        );
-
-        glVertexAttribPointer(
-          Program::UV0,
-          2,
-          GL_FLOAT,
-          GL_FALSE,
-          sizeof(GLfloat)*stride,
-          (const GLvoid*)(sizeof(GLfloat)*uvoff)
-        );
+    // The opaque queue neither tests nor blends alpha, so keeps early z.
+    glDisable(GL_BLEND);
+    glDisable(GL_ALPHA_TEST);
+    if(depthPrepass)
+    {
+      // Depth alone first, then every opaque pixel is shaded once.  The
+      // vertex shaders declare gl_Position invariant for GL_EQUAL to hold.
+      glColorMask(GL_FALSE,GL_FALSE,GL_FALSE,GL_FALSE);
+      draw(draws.data(),ends[QUEUE_OPAQUE],mvp,true);
+      glColorMask(GL_TRUE,GL_TRUE,GL_TRUE,GL_TRUE);
+      glDepthMask(GL_FALSE);
+      glDepthFunc(GL_EQUAL);
+      draw(draws.data(),ends[QUEUE_OPAQUE],mvp,false);
+      glDepthFunc(GL_LEQUAL);
+      glDepthMask(GL_TRUE);
+    } else {
+      draw(draws.data(),ends[QUEUE_OPAQUE],mvp,false);
+    }
 
+    glEnable(GL_ALPHA_TEST);
+    draw(draws.data() + ends[QUEUE_OPAQUE],
+      ends[QUEUE_ALPHA_TEST] - ends[QUEUE_OPAQUE],mvp,false);
 
-        glEnableVertexAttribArray(Program::POSITION);
-        glEnableVertexAttribArray(Program::UV0);
+    // Blended ones keep the alpha test they always had, and leave depth
+    // alone so the ones behind still show through.
+    glEnable(GL_BLEND);
+    glDepthMask(GL_FALSE);
+    draw(draws.data() + ends[QUEUE_ALPHA_TEST],
+      ends[QUEUE_BLEND] - ends[QUEUE_ALPHA_TEST],mvp,false);
+    glDepthMask(GL_TRUE);
+  }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
-          ebufs[map->models[m].model[0].index_index]);
-        glDrawElements(
-          GL_TRIANGLES,
-          map->models[m].model[0].index_length,
-          GL_UNSIGNED_SHORT,
-          (const GLvoid*)(sizeof(GLushort)*map->models[m].model[0].index_offset)
-        );
-        glDisableVertexAttribArray(Program::POSITION);
-        glDisableVertexAttribArray(Program::UV0);
-      }
-    /*
+  // Where model m goes in the sorted draw list, which alone decides the
+  // order the map is drawn in.  By queue, the top two bits, and within the
+  // opaque and alpha tested ones by material so each binds its program and
+  // textures once, baked terrain, bit 61, apart from the live blend.
+  // Blended ones go back to front by the clip w of their center.  The model
+  // is the low 32 bits.
+  uint64_t drawKey(int m, const Matrix4f& mvp, const Vector3f& eye) const
+  {
+    uint32_t material = map->models[m].material;
+    uint64_t queue = queues[material];
+    if(queue == QUEUE_BLEND)
+    {
+      // Non-negative floats sort like their bits.
+      Vector3f c = centers.Get(m);
+      float w = max(mvp.m30*c.x + mvp.m31*c.y + mvp.m32*c.z + mvp.m33,0.0f);
+      uint32_t depth;
+      memcpy(&depth,&w,sizeof(depth));
+      return queue << 62 | (uint64_t)(~depth >> 2) << 32 | m;
     }
+    uint64_t bake = baked[material] >= 0 && distance(m,eye) > bakeDistance;
+    return queue << 62 | bake << 61 | (uint64_t)material << 32 | m;
+  }
 
-    for(int m=0;m!=map->num_model;m++)
+  // Draws the models of count sorted keys.  positionOnly draws them with
+  // map_position for their depth, without binding any texture.
+  void draw(const uint64_t* draws, size_t count, const Matrix4f& mvp,
+    bool positionOnly)
+  {
+    if(positionOnly && count)
     {
-      */
-
-      if(map->materials[map->models[m].material].flag1 == 0) {
-        //continue;
-        map_default->Use();
-
-        glUniformMatrix4fv(dmvp, 1, GL_TRUE, mvp._m);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D,texs[map->models[m].material][0].GetTexture());
-        glUniform1i(dtex,0);
+      map_position->Use();
+      glUniformMatrix4fv(pmvp, 1, GL_TRUE, mvp._m);
+    }
 
-        glBindBuffer(GL_ARRAY_BUFFER,
-          vbufs[map->models[m].model[0].vertex_index]);
+    Program* program = 0;
+    uint32_t bound = ~0u;
+    for(size_t i=0;i!=count;i++)
+    {
+      const LOLMapModel& model = map->models[(uint32_t)draws[i]];
+      const LOLMapMaterial& mat = map->materials[model.material];
+      // Baked terrain is drawn like any single texture material, with its
+      // UV1 in place of UV0.
+      bool bake = (draws[i] >> 61 & 1) && !positionOnly;
+      bool fourBlend = mat.flag1 == 3 && !positionOnly && !bake;
+
+      if((model.material << 1 | bake) != bound && !positionOnly)
+      {
+        bound = model.material << 1 | bake;
+        Program* use = fourBlend ? map_four_blend : map_default;
+        if(use != program)
+        {
+          program = use;
+          program->Use();
+          if(fourBlend)
+          {
+            glUniformMatrix4fv(fmvp, 1, GL_TRUE, mvp._m);
+            glUniform1i(ftex0,0);
+            glUniform1i(ftex1,1);
+            glUniform1i(ftex2,2);
+            glUniform1i(ftex3,3);
+            glUniform1i(ftex4,4);
+          } else {
+            glUniformMatrix4fv(dmvp, 1, GL_TRUE, mvp._m);
+            glUniform1i(dtex,0);
+          }
+        }
 
-        int stride;
-        if(map->materials[map->models[m].material].flag2 == 0)
+        vector<Texture>& tex = texs[model.material];
+        if(bake)
         {
-          stride = 9;
+          glActiveTexture(GL_TEXTURE0);
+          glBindTexture(GL_TEXTURE_2D,
+            images[baked[model.material]].texture.GetTexture());
+        }
+        else if(fourBlend)
+        {
+          // The blend mask goes first.
+          static const int slots[] = {1,0,2,4,6};
+          for(int s=0;s!=5;s++)
+          {
+            glActiveTexture(GL_TEXTURE0 + s);
+            glBindTexture(GL_TEXTURE_2D,tex[slots[s]].GetTexture());
+          }
         } else {
-          stride = 10;
+          glActiveTexture(GL_TEXTURE0);
+          glBindTexture(GL_TEXTURE_2D,tex[0].GetTexture());
         }
+      }
+
+      const LOLMapModelData& data = model.model[0];
+      int s = mat.stride();
 
-        //if(map->materials[map->models[m].material].flag1 ==1  ) continue;
-        //if(map->materials[map->models[m].material].flag2 !=17 ) continue;
+      glBindBuffer(GL_ARRAY_BUFFER,chunks ?
+        chunks->GetVertexBuffer(data.vertex_index) : vbufs[data.vertex_index]);
 
-        //if(map->materials[map->models[m].material].flag1 ==3 ) uvoff = 6;
+      glVertexAttribPointer(
+        Program::POSITION,
+        3,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(GLfloat)*s,
+        (const GLvoid*)(0)
+      );
+      glEnableVertexAttribArray(Program::POSITION);
 
+      if(!positionOnly)
+      {
         glVertexAttribPointer(
-          Program::POSITION,
-          3,
+          Program::UV0,
+          2,
           GL_FLOAT,
           GL_FALSE,
-          sizeof(GLfloat)*stride,
-          (const GLvoid*)(0)
+          sizeof(GLfloat)*s,
+          (const GLvoid*)(sizeof(GLfloat)*(bake ? 8 : 6))
         );
+        glEnableVertexAttribArray(Program::UV0);
+      }
 
+      if(fourBlend)
+      {
         glVertexAttribPointer(
-          Program::UV0,
+          Program::UV1,
           2,
           GL_FLOAT,
           GL_FALSE,
-          sizeof(GLfloat)*stride,
-          (const GLvoid*)(sizeof(GLfloat)*6)
+          sizeof(GLfloat)*s,
+          (const GLvoid*)(sizeof(GLfloat)*8)
         );
+        glEnableVertexAttribArray(Program::UV1);
+      }
 
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,chunks ?
+        chunks->GetIndexBuffer(data.index_index) : ebufs[data.index_index]);
+      glDrawElements(
+        GL_TRIANGLES,
+        data.index_length,
+        GL_UNSIGNED_SHORT,
+        (const GLvoid*)(sizeof(GLushort)*data.index_offset)
+      );
 
-        glEnableVertexAttribArray(Program::POSITION);
-        glEnableVertexAttribArray(Program::UV0);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
-          ebufs[map->models[m].model[0].index_index]);
-        glDrawElements(
-          GL_TRIANGLES,
-          map->models[m].model[0].index_length,
-          GL_UNSIGNED_SHORT,
-          (const GLvoid*)(sizeof(GLushort)*map->models[m].model[0].index_offset)
-        );
-
-        glDisableVertexAttribArray(Program::POSITION);
+      glDisableVertexAttribArray(Program::POSITION);
+      if(!positionOnly)
         glDisableVertexAttribArray(Program::UV0);
-      }
-      /*
+      if(fourBlend)
+        glDisableVertexAttribArray(Program::UV1);
     }
-    for(int m=0;m!=map->num_model;m++)
-    {
-      */
-      if(map->materials[map->models[m].material].flag1 == 2) {
-        //continue;
-        map_default->Use();
-
-        glUniformMatrix4fv(dmvp, 1, GL_TRUE, mvp._m);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D,texs[map->models[m].material][0].GetTexture());
-        glUniform1i(dtex,0);
-
-        glBindBuffer(GL_ARRAY_BUFFER,
-          vbufs[map->models[m].model[0].vertex_index]);
-
-        int stride = 9;
-
-        //(map->materials[map->models[m].material].flag1 ==1  ) continue;
-        //if(map->materials[map->models[m].material].flag2 !=17 ) continue;
+  }
+};
 
-        //if(map->materials[map->models[m].material].flag1 ==3 ) uvoff = 6;
+bool RiotMap::compressTextures = false;
+TextureStreamer* RiotMap::streamer = 0;
+UploadScheduler* RiotMap::uploads = 0;
+float RiotMap::chunkRadius = 0;
+size_t RiotMap::chunkBudget = 128 << 20;
+bool RiotMap::depthPrepass = true;
+float RiotMap::bakeDistance = 2500;
+
+// One viewer slot going through a playlist of maps.  While a map is on
+// screen the next one is read and decoded on the workers and uploaded in
+// the background, and Next switches over once all of it is there.  Maps
+// switched away from are deleted when nothing uploads into them anymore.
+class MapSession
+{
+public:
+  MapSession(const vector<string>& playlist)
+    :playlist_(playlist),index_(0),current_(0),next_(0),read_(0),
+     reading_(false),switch_(true)
+  {
+    if(!playlist_.empty())
+      preload(0);
+  }
 
-        glVertexAttribPointer(
-          Program::POSITION,
-          3,
-          GL_FLOAT,
-          GL_FALSE,
-          sizeof(GLfloat)*stride,
-          (const GLvoid*)(0)
-        );
+  ~MapSession()
+  {
+    JobSystem::Instance().Wait(counter_);
+    reading_ = false;
+    if(read_)
+      retired_.push_back(read_);
+    if(next_)
+      retired_.push_back(next_);
+    if(current_)
+      retired_.push_back(current_);
+    current_ = next_ = read_ = 0;
+    while(!Idle())
+    {
+      JobSystem::Instance().PumpMain();
+      if(RiotMap::uploads)
+        RiotMap::uploads->Update();
+      Update();
+    }
+  }
 
-        glVertexAttribPointer(
-          Program::UV0,
-          2,
-          GL_FLOAT,
-          GL_FALSE,
-          sizeof(GLfloat)*stride,
-          (const GLvoid*)(sizeof(GLfloat)*6)
-        );
+  // The map on screen, 0 until the first one is in.
+  RiotMap* GetMap() const
+  {
+    return current_;
+  }
 
+  // Goes on to the next map of the playlist as soon as it is loaded.
+  void Next()
+  {
+    if(playlist_.size() > 1)
+      switch_ = true;
+  }
 
-        glEnableVertexAttribArray(Program::POSITION);
-        glEnableVertexAttribArray(Program::UV0);
+  // Nothing being read, uploaded or waiting to be deleted.
+  bool Idle() const
+  {
+    return !reading_ && (!next_ || !next_->busy()) && retired_.empty();
+  }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
-          ebufs[map->models[m].model[0].index_index]);
-        glDrawElements(
-          GL_TRIANGLES,
-          map->models[m].model[0].index_length,
-          GL_UNSIGNED_SHORT,
-          (const GLvoid*)(sizeof(GLushort)*map->models[m].model[0].index_offset)
-        );
-        glDisableVertexAttribArray(Program::POSITION);
-        glDisableVertexAttribArray(Program::UV0);
-      }
-      /*
+  // Once per frame on the main thread.
+  void Update()
+  {
+    TRACE_ZONE("MapSession::Update");
+    if(reading_ && counter_.Done())
+    {
+      reading_ = false;
+      next_ = read_;
+      read_ = 0;
+      next_->createObjects();
     }
 
+    if(switch_ && next_ && !next_->busy())
+    {
+      if(current_)
+        retired_.push_back(current_);
+      current_ = next_;
+      index_ = nextIndex_;
+      next_ = 0;
+      switch_ = false;
+      cout << "Showing " << current_->folder << endl;
+      if(playlist_.size() > 1)
+        preload((index_ + 1) % playlist_.size());
+    }
 
-    for(int m=0;m!=map->num_model;m++)
+    for(size_t i=0;i!=retired_.size();)
     {
-      */
-      if(map->materials[map->models[m].material].flag1 > 3)
+      if(retired_[i]->busy())
       {
-        //cout << "fk" << endl;
+        i++;
+        continue;
       }
+      delete retired_[i];
+      retired_.erase(retired_.begin() + i);
     }
   }
+
+private:
+  void preload(size_t index)
+  {
+    string folder = playlist_[index];
+    nextIndex_ = index;
+    reading_ = true;
+    JobSystem::Instance().Run([this,folder]() { read_ = new RiotMap(folder); },
+      &counter_);
+  }
+
+  vector<string> playlist_;
+  size_t index_;
+  size_t nextIndex_;
+  RiotMap* current_;
+  // Read and with its GL objects, maybe still uploading.
+  RiotMap* next_;
+  // Set by the read job, only looked at once counter_ is done.
+  RiotMap* read_;
+  bool reading_;
+  bool switch_;
+  JobCounter counter_;
+  vector<RiotMap*> retired_;
 };
 
+// A color texture and depth buffer to draw a map into, sized by resize.
 class FrameBuffer
 {
 public:
   GLuint textureId;
   GLuint rboId;
   GLuint fboId;
+  int width;
+  int height;
 
   FrameBuffer()
+    :textureId(0),rboId(0),fboId(0),width(0),height(0)
+  {}
+
+  ~FrameBuffer()
   {
+    release();
+  }
+
+  // (Re)allocates the storage, the GL objects stay.
+  void resize(int w, int h)
+  {
+    if(!fboId)
+      create();
+    width = w;
+    height = h;
+
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, rboId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT,
+                          width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
+    // check FBO status
+    glBindFramebuffer(GL_FRAMEBUFFER, fboId);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if(status != GL_FRAMEBUFFER_COMPLETE)
+        cerr << "WTF" << endl;
+
+    // switch back to window-system-provided framebuffer
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
+  void release()
+  {
+    if(!fboId)
+      return;
+    glDeleteFramebuffers(1, &fboId);
+    glDeleteRenderbuffers(1, &rboId);
+    glDeleteTextures(1, &textureId);
+    textureId = rboId = fboId = 0;
+    width = height = 0;
+  }
+
+  void bind()
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, fboId);
+    glViewport(0, 0, width, height);
+  }
+
+  // Draws and clears only the columns from x0 to x1, as fractions of the
+  // width, until unbind.  A pixel more on each side for the filtering.
+  void bind(float x0, float x1)
+  {
+    bind();
+    int left = max((int)floor(x0*width) - 1, 0);
+    int right = min((int)ceil(x1*width) + 1, width);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(left, 0, right - left, height);
+  }
+
+  void unbind()
+  {
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
+private:
+  void create()
+  {
+    // Only ever drawn at about its own size, bilinear without mips.
     glGenTextures(1, &textureId);
     glBindTexture(GL_TEXTURE_2D, textureId);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE); // automatic mipmap
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, WIDTH, HEIGHT, 0,
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0,
                  GL_RGBA, GL_UNSIGNED_BYTE, 0);
     glBindTexture(GL_TEXTURE_2D, 0);
 
-
     glGenRenderbuffers(1, &rboId);
-    glBindRenderbuffer(GL_RENDERBUFFER, rboId);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT,
-                          WIDTH, HEIGHT);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
     glGenFramebuffers(1, &fboId);
     glBindFramebuffer(GL_FRAMEBUFFER, fboId);
@@ -539,44 +997,118 @@ public:
                               GL_RENDERBUFFER,     // 3. rbo target: GL_RENDERBUFFER
                               rboId);              // 4. rbo ID
 
-    // check FBO status
-    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-    if(status != GL_FRAMEBUFFER_COMPLETE)
-        cerr << "WTF" << endl;
-
-    // switch back to window-system-provided framebuffer
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
   }
 
-  void bind()
+  FrameBuffer(const FrameBuffer&);
+  FrameBuffer& operator=(const FrameBuffer&);
+};
+
+// Render targets handed out by size for a frame.  A size asked for again
+// gets the target it had, so a render scale going back and forth between
+// a few sizes doesn't reallocate, and targets not asked for in a while
+// give their memory back.  Fixed slots, acquiring never allocates.
+class FrameBufferPool
+{
+public:
+  static const int MAX_TARGETS = 6;
+  // Drawn frames an unused target keeps its storage.
+  static const uint32_t KEEP_FRAMES = 120;
+
+  FrameBufferPool()
+    :frame_(0)
   {
-    glBindFramebuffer(GL_FRAMEBUFFER, fboId);
+    for(int i=0;i!=MAX_TARGETS;i++)
+    {
+      lastUsed_[i] = 0;
+      taken_[i] = false;
+    }
   }
 
-  void unbind()
+  // A target of that size not taken yet this frame.
+  FrameBuffer* acquire(int width, int height)
   {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    int found = -1;
+    for(int i=0;i!=MAX_TARGETS;i++)
+      if(!taken_[i] && targets_[i].width == width &&
+         targets_[i].height == height)
+        found = i;
+    // Otherwise an empty one, or the free one used longest ago.
+    for(int i=0;i!=MAX_TARGETS && found < 0;i++)
+      if(!taken_[i] && !targets_[i].fboId)
+        found = i;
+    if(found < 0)
+      for(int i=0;i!=MAX_TARGETS;i++)
+        if(!taken_[i] && (found < 0 || lastUsed_[i] < lastUsed_[found]))
+          found = i;
+    assertion(found >= 0,"More than %d render targets in a frame\n",
+      MAX_TARGETS);
+
+    FrameBuffer& target = targets_[found];
+    if(target.width != width || target.height != height)
+      target.resize(width, height);
+    taken_[found] = true;
+    lastUsed_[found] = frame_;
+    return &target;
   }
+
+  // After the last target of a drawn frame is used.
+  void endFrame()
+  {
+    frame_++;
+    for(int i=0;i!=MAX_TARGETS;i++)
+    {
+      taken_[i] = false;
+      if(targets_[i].fboId && frame_ - lastUsed_[i] > KEEP_FRAMES)
+        targets_[i].release();
+    }
+  }
+
+private:
+  FrameBuffer targets_[MAX_TARGETS];
+  uint32_t lastUsed_[MAX_TARGETS];
+  bool taken_[MAX_TARGETS];
+  uint32_t frame_;
 };
+
 static SDL_Color SDL_RED   = {255, 0, 0, 0};
 static SDL_Color SDL_GREEN   = {0, 255, 0, 0};
 static SDL_Color SDL_BLUE  = {0, 0, 255, 0};
 static SDL_Color SDL_WHITE   = {255, 255, 255, 0};
 static SDL_Color SDL_BLACK   = {0,0,0,0};
 
+// Draws strings with SDL_ttf.  Fonts stay open and rendered strings stay
+// on the GPU, so drawing the same text again is just a quad.
 class TextRenderer
 {
 public:
+  // Strings kept rendered, the least recently drawn is replaced first.
+  static const size_t MAX_LABELS = 32;
+
   TextRenderer()
+    :draws_(0),width_(WIDTH),height_(HEIGHT)
   {}
 
-  void Render(string text, SDL_Color color, int x,int y, int size)
+  ~TextRenderer()
   {
+    for(size_t i=0;i!=labels_.size();i++)
+      glDeleteTextures(1, &labels_[i].texture);
+    for(size_t i=0;i!=fonts_.size();i++)
+      if(fonts_[i].font)
+        TTF_CloseFont(fonts_[i].font);
+  }
+
+  void Render(const string& text, SDL_Color color, int x,int y, int size)
+  {
+    const Label* label = GetLabel(text,color,size);
+    if(!label)
+      return;
+
     glMatrixMode(GL_MODELVIEW);
     glPushMatrix();
     glLoadIdentity();
 
-    gluOrtho2D(0, WIDTH, HEIGHT, 0); // m_Width and m_Height is the resolution of window
+    gluOrtho2D(0, width_, height_, 0); // m_Width and m_Height is the resolution of window
     glMatrixMode(GL_PROJECTION);
     glPushMatrix();
     glLoadIdentity();
@@ -586,25 +1118,26 @@ public:
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-
-    TTF_Font * font = TTF_OpenFont("Arial.ttf", size);
-    SDL_Surface * sFont = TTF_RenderText_Blended(font, text.c_str(), color);
+    glBindTexture(GL_TEXTURE_2D, label->texture);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, sFont->w, sFont->h, 0, GL_BGRA, GL_UNSIGNED_BYTE, sFont->pixels);
-
-    glBegin(GL_QUADS);
+    // u, v, x, y per corner, from client memory.
+    float* quad = FrameArena::Instance().Allocate<float>(16);
+    float corners[4][2] = {{0,0},{1,0},{1,1},{0,1}};
+    for(int i=0;i!=4;i++)
     {
-      glTexCoord2f(0,0); glVertex2f(x, y);
-      glTexCoord2f(1,0); glVertex2f(x + sFont->w, y);
-      glTexCoord2f(1,1); glVertex2f(x + sFont->w, y + sFont->h);
-      glTexCoord2f(0,1); glVertex2f(x, y + sFont->h);
+      quad[i*4+0] = corners[i][0];
+      quad[i*4+1] = corners[i][1];
+      quad[i*4+2] = x + corners[i][0]*label->width;
+      quad[i*4+3] = y + corners[i][1]*label->height;
     }
-    glEnd();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(float)*4, quad);
+    glVertexPointer(2, GL_FLOAT, sizeof(float)*4, quad + 2);
+    glDrawArrays(GL_QUADS, 0, 4);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 
     glDisable(GL_BLEND);
     glDisable(GL_TEXTURE_2D);
@@ -612,13 +1145,101 @@ public:
 
     glMatrixMode(GL_PROJECTION);
     glPopMatrix();
-    glMatrixMode(GL_PROJECTION);
+    glMatrixMode(GL_MODELVIEW);
     glPopMatrix();
+  }
+
+  // The window size text is placed in.
+  void Resize(int width, int height)
+  {
+    width_ = width;
+    height_ = height;
+  }
+
+private:
+  struct Label
+  {
+    string text;
+    SDL_Color color;
+    int size;
+    GLuint texture;
+    int width;
+    int height;
+    uint64_t drawn;
+  };
+
+  struct Font
+  {
+    int size;
+    TTF_Font* font;   // 0 if it failed to open, so that is only tried once
+  };
+
+  TTF_Font* GetFont(int size)
+  {
+    for(size_t i=0;i!=fonts_.size();i++)
+      if(fonts_[i].size == size)
+        return fonts_[i].font;
+
+    Font font = {size, TTF_OpenFont("arial.ttf", size)};
+    if(!font.font)
+      cerr << "Can't open arial.ttf: " << TTF_GetError() << endl;
+    fonts_.push_back(font);
+    return font.font;
+  }
+
+  const Label* GetLabel(const string& text, SDL_Color color, int size)
+  {
+    draws_++;
+    Label* oldest = 0;
+    for(size_t i=0;i!=labels_.size();i++)
+    {
+      Label& label = labels_[i];
+      if(label.text == text && label.size == size &&
+        label.color.r == color.r && label.color.g == color.g &&
+        label.color.b == color.b && label.color.a == color.a)
+      {
+        label.drawn = draws_;
+        return &label;
+      }
+      if(!oldest || label.drawn < oldest->drawn)
+        oldest = &label;
+    }
+
+    TTF_Font* font = GetFont(size);
+    if(!font)
+      return 0;
+    SDL_Surface * sFont = TTF_RenderText_Blended(font, text.c_str(), color);
+    if(!sFont)
+      return 0;
+
+    Label* label = oldest;
+    if(labels_.size() < MAX_LABELS)
+    {
+      labels_.push_back(Label());
+      label = &labels_.back();
+      glGenTextures(1, &label->texture);
+    }
+    label->text = text;
+    label->color = color;
+    label->size = size;
+    label->width = sFont->w;
+    label->height = sFont->h;
+    label->drawn = draws_;
+
+    glBindTexture(GL_TEXTURE_2D, label->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, sFont->w, sFont->h, 0, GL_BGRA, GL_UNSIGNED_BYTE, sFont->pixels);
 
-    glDeleteTextures(1, &texture);
-    TTF_CloseFont(font);
     SDL_FreeSurface(sFont);
+    return label;
   }
+
+  vector<Label> labels_;
+  vector<Font> fonts_;
+  uint64_t draws_;
+  int width_;
+  int height_;
 };
 
 #define RENDERMAP 1
@@ -634,6 +1255,35 @@ float quad[] = {
 
 int splitmode = 0;
 
+// Everything the picture depends on besides the maps loading.
+struct ViewState
+{
+  Vector3f position;
+  float horizontalAngle;
+  float verticalAngle;
+  float fov;
+  int splitmode;
+  int width;
+  int height;
+  const RiotMap* maps[2];
+
+  bool Same(const ViewState& other) const
+  {
+    return position.x == other.position.x &&
+      position.y == other.position.y && position.z == other.position.z &&
+      horizontalAngle == other.horizontalAngle &&
+      verticalAngle == other.verticalAngle && fov == other.fov &&
+      splitmode == other.splitmode && width == other.width &&
+      height == other.height && maps[0] == other.maps[0] &&
+      maps[1] == other.maps[1];
+  }
+};
+
+// Frames still drawn once nothing changes anymore.
+const int REDRAW_FRAMES = 3;
+// Longest sleep between idle frames, for what the workers finish.
+const int IDLE_WAIT_MS = 100;
+
 GLuint quadbuf;
 
 const char* cmd = "ffmpeg -r 20 -f rawvideo -pix_fmt rgba -s 1280x720 -i - "
@@ -641,6 +1291,72 @@ const char* cmd = "ffmpeg -r 20 -f rawvideo -pix_fmt rgba -s 1280x720 -i - "
 
 int main (int argc, char* argv[])
 {
+  bool streaming = true;
+  string mipCache = "cache/mips";
+  double uploadMs = 2.0;
+  double uploadMb = 8.0;
+  string traceFile = "trace.json";
+  bool traceAtExit = false;
+  bool memoryReport = false;
+  bool alwaysRedraw = false;
+  double targetMs = 12.0;
+  float minScale = 0.5f;
+  int upscale = UPSCALE_SHARPEN;
+  vector<string> leftMaps;
+  vector<string> rightMaps;
+  for(int i=1;i<argc;i++)
+  {
+    if(!strcmp(argv[i],"--compress-textures"))
+      RiotMap::compressTextures = true;
+    else if(!strcmp(argv[i],"--no-streaming"))
+      streaming = false;
+    else if(!strcmp(argv[i],"--no-mip-cache"))
+      mipCache.clear();
+    else if(!strcmp(argv[i],"--upload-ms") && i+1<argc)
+      uploadMs = atof(argv[++i]);
+    else if(!strcmp(argv[i],"--upload-mb") && i+1<argc)
+      uploadMb = atof(argv[++i]);
+    else if(!strcmp(argv[i],"--chunks") && i+1<argc)
+      RiotMap::chunkRadius = atof(argv[++i]);
+    else if(!strcmp(argv[i],"--no-prepass"))
+      RiotMap::depthPrepass = false;
+    else if(!strcmp(argv[i],"--bake-distance") && i+1<argc)
+      RiotMap::bakeDistance = atof(argv[++i]);
+    else if(!strcmp(argv[i],"--chunk-mb") && i+1<argc)
+      RiotMap::chunkBudget = (size_t)(atof(argv[++i])*(1<<20));
+    else if(!strcmp(argv[i],"--trace") && i+1<argc)
+    {
+      traceFile = argv[++i];
+      traceAtExit = true;
+    }
+    else if(!strcmp(argv[i],"--left") && i+1<argc)
+      leftMaps.push_back(argv[++i]);
+    else if(!strcmp(argv[i],"--right") && i+1<argc)
+      rightMaps.push_back(argv[++i]);
+    else if(!strcmp(argv[i],"--always-redraw"))
+      alwaysRedraw = true;
+    else if(!strcmp(argv[i],"--target-ms") && i+1<argc)
+      targetMs = atof(argv[++i]);
+    else if(!strcmp(argv[i],"--min-scale") && i+1<argc)
+      minScale = (float)atof(argv[++i]);
+    else if(!strcmp(argv[i],"--upscale") && i+1<argc)
+    {
+      i++;
+      upscale = strcmp(argv[i],"bilinear") ? UPSCALE_SHARPEN : UPSCALE_BILINEAR;
+    }
+    else if(!strcmp(argv[i],"--alloc-guard"))
+      MemoryTracker::SetGuardsEnabled(true);
+    else if(!strcmp(argv[i],"--alloc-report"))
+    {
+      MemoryTracker::SetSiteTracking(true);
+      memoryReport = true;
+    }
+  }
+
+  // Start the workers from here, this thread stays the GL thread.
+  TRACE_THREAD("main");
+  JobSystem::Instance();
+
   TTF_Init();
   TextRenderer* textrender = new TextRenderer;
   // open pipe to ffmpeg's stdin in binary write mode
@@ -656,14 +1372,28 @@ int main (int argc, char* argv[])
 
   //glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
 
+  set_mip_cache(mipCache);
+  if(streaming)
+    RiotMap::streamer = new TextureStreamer();
+  // A zero budget uploads everything at load time like before.
+  if(uploadMs > 0 && uploadMb > 0)
+    RiotMap::uploads = new UploadScheduler(uploadMs,(size_t)(uploadMb*(1<<20)));
+
 #if RENDERMAP
-  RiotMap map1("lol/LEVELS/Map1/");
-  RiotMap map11("lol/lolpbe/LEVELS/Map11/");
-  //RiotMap map12("lol/LEVELS/Map12/");
+  if(leftMaps.empty())
+    leftMaps.push_back("lol/LEVELS/Map1/");
+  if(rightMaps.empty())
+    rightMaps.push_back("lol/lolpbe/LEVELS/Map11/");
+  //rightMaps.push_back("lol/LEVELS/Map12/");
+  MapSession leftSession(leftMaps);
+  MapSession rightSession(rightMaps);
 #endif
 
-  FrameBuffer map1frame;
-  FrameBuffer map11frame;
+  // The maps are drawn at a scale of the window size that keeps their
+  // GPU time near the target, a zero target always draws at full size.
+  FrameBufferPool frames;
+  ResolutionController resolution(targetMs, targetMs > 0 ? minScale : 1.0f);
+  GpuTimer gpuTimer;
 
   quadbuf = glbuffer(GL_ARRAY_BUFFER, quad, sizeof(quad));
 
@@ -696,6 +1426,14 @@ int main (int argc, char* argv[])
   dtex = map_default->GetUniformLocation("Z_TEX0");
   dmvp = map_default->GetUniformLocation("Z_MODEL_VIEW_PROJECTION");
 
+  map_position = new Program();
+
+  map_position->AttachShader(Shader::CreateShaderFromFile(GL_VERTEX_SHADER, "Shaders/SIMPLE_POSITION.vert"));
+  map_position->AttachShader(Shader::CreateShaderFromFile(GL_FRAGMENT_SHADER, "Shaders/SIMPLE_POSITION.frag"));
+  map_position->Link();
+
+  pmvp = map_position->GetUniformLocation("Z_MODEL_VIEW_PROJECTION");
+
   map_four_blend = new Program();
 
   map_four_blend->AttachShader(Shader::CreateShaderFromFile(GL_VERTEX_SHADER, "Shaders/MAP_FOUR_BLEND.vert"));
@@ -710,23 +1448,33 @@ int main (int argc, char* argv[])
   ftex4 = map_four_blend->GetUniformLocation("Z_TEX4");
 
 
-  split_1 = new Program();
+  Shader split_vert = Shader::CreateShaderFromFile(GL_VERTEX_SHADER, "Shaders/SPLIT_1.vert");
+  for(int i=0;i!=SPLIT_MODES;i++)
+  for(int j=0;j!=UPSCALE_FILTERS;j++)
+  {
+    char defines[64];
+    snprintf(defines, sizeof(defines), "#define MODE %d\n%s", i,
+      j == UPSCALE_SHARPEN ? "#define SHARPEN\n" : "");
 
-  split_1->AttachShader(Shader::CreateShaderFromFile(GL_VERTEX_SHADER, "Shaders/SPLIT_1.vert"));
-  split_1->AttachShader(Shader::CreateShaderFromFile(GL_FRAGMENT_SHADER, "Shaders/SPLIT_1.frag"));
-  split_1->Link();
+    split_1[i][j] = new Program();
 
-  s1mvp = split_1->GetUniformLocation("Z_MODEL_VIEW_PROJECTION");
-  s1tex0 = split_1->GetUniformLocation("Z_TEX0");
-  s1tex1 = split_1->GetUniformLocation("Z_TEX1");
-  s1mode = split_1->GetUniformLocation("MODE");
+    split_1[i][j]->AttachShader(split_vert);
+    split_1[i][j]->AttachShader(Shader::CreateShaderFromFile(GL_FRAGMENT_SHADER, "Shaders/SPLIT_1.frag", defines));
+    split_1[i][j]->Link();
+
+    s1mvp[i][j] = split_1[i][j]->GetUniformLocation("Z_MODEL_VIEW_PROJECTION");
+    s1tex0[i][j] = split_1[i][j]->GetUniformLocation("Z_TEX0");
+    s1tex1[i][j] = split_1[i][j]->GetUniformLocation("Z_TEX1");
+    s1texel[i][j] = split_1[i][j]->GetUniformLocation("Z_TEXEL");
+    s1sharpness[i][j] = split_1[i][j]->GetUniformLocation("Z_SHARPNESS");
+  }
 
   Matrix4f projection,view,model,mvp;
 
-  projection = Matrix4f::CreatePerspective(45.0f, WIDTH/(float)HEIGHT , 1, 1e6);
+  projection = Matrix4f::CreatePerspective(45.0f, renderer->GetWidth()/(float)renderer->GetHeight(), 1, 1e6);
   model = Matrix4f::IDENTITY;
 
-  Matrix4f mvps = Matrix4f::CreateOrthographic(0,1,0,1,-1,1);
+  static constexpr Matrix4f mvps = Matrix4f::CreateOrthographic(0,1,0,1,-1,1);
 
   window->SetRelativeMouseMode(true);
 
@@ -811,10 +1559,29 @@ int main (int argc, char* argv[])
 
   SDL_Event e;
   bool running = true;
+  uint32_t frame = 0;
+  ViewState lastView = {};
+  lastView.position = Vector3f::ZERO;
+  int redraw = REDRAW_FRAMES;
+  bool idle = false;
   while(running)
   {
+    if(idle)
+    {
+      TRACE_ZONE("idle");
+      window->WaitEvent(IDLE_WAIT_MS);
+      // The camera didn't move while asleep.
+      lastSec = Timer::GetTimeInSeconds();
+    }
+
+    TRACE_ZONE("frame");
+    MemoryTagScope frameTag(MEMORY_FRAME);
+    FrameArena::Instance().BeginFrame();
+
+    bool input = false;
     while(window->PollEvent(e))
     {
+      input = true;
       switch (e.type)
       {
       case SDL_QUIT:
@@ -825,7 +1592,16 @@ int main (int argc, char* argv[])
           running = false;
         else if(e.key.keysym.sym == SDLK_F12)
         {
-          screenshot();
+          screenshot(renderer->GetWidth(),renderer->GetHeight());
+        }
+        else if(e.key.keysym.sym == SDLK_F11)
+        {
+          if(Trace::Dump(traceFile.c_str()))
+            cout << "Wrote " << traceFile << endl;
+        }
+        else if(e.key.keysym.sym == SDLK_F10)
+        {
+          MemoryTracker::Report(cout);
         }
         else if(e.key.keysym.scancode == SDL_SCANCODE_H)
         {
@@ -842,6 +1618,12 @@ int main (int argc, char* argv[])
           qq--;
         else if(e.key.keysym.scancode == SDL_SCANCODE_M)
           splitmode = (splitmode + 1)%5;
+#if RENDERMAP
+        else if(e.key.keysym.scancode == SDL_SCANCODE_N)
+          leftSession.Next();
+        else if(e.key.keysym.scancode == SDL_SCANCODE_B)
+          rightSession.Next();
+#endif
         else if(e.key.keysym.scancode == SDL_SCANCODE_1)
           splitmode = 0;
         else if(e.key.keysym.scancode == SDL_SCANCODE_2)
@@ -865,29 +1647,44 @@ int main (int argc, char* argv[])
         {
         case SDL_WINDOWEVENT_RESIZED:
           renderer->Resize(e.window.data1,e.window.data2);
+          textrender->Resize(e.window.data1,e.window.data2);
+          projection = Matrix4f::CreatePerspective(45.0f,
+            e.window.data1/(float)max(e.window.data2,1), 1, 1e6);
           break;
         }
         break;
       }
     }
 
+    // Nothing is loading or uploading.
+    bool settled = true;
+#if RENDERMAP
+    settled = settled && leftSession.Idle() && rightSession.Idle();
+    settled = settled && leftSession.GetMap() && rightSession.GetMap() &&
+      !leftSession.GetMap()->busy() && !rightSession.GetMap()->busy();
+#endif
+    if(RiotMap::uploads)
+      settled = settled && RiotMap::uploads->Idle();
+    if(RiotMap::streamer)
+      settled = settled && RiotMap::streamer->Idle();
+
+    // Past the input, which may do anything: once everything is loaded and
+    // the first frames have filled the caches, nothing up to SwapBuffers
+    // may allocate.
+    AllocationGuard frameGuard("frame",settled && frame >= 2);
+
     float curSec = Timer::GetTimeInSeconds();
     float deltaTime = curSec - lastSec;
     lastSec = curSec;
 
-    Vector3f direction(
-      cos(verticalAngle) * sin(horizontalAngle),
-      sin(verticalAngle),
-      cos(verticalAngle) * cos(horizontalAngle)
-    );
-
-    Vector3f right(
-      sin(horizontalAngle - 3.14f/2.0f),
-      0,
-      cos(horizontalAngle - 3.14f/2.0f)
-    );
+    // Yaw about world up, then pitch about the camera's own x axis.
+    Quaternionf orientation =
+      Quaternionf(Vector3f::UNIT_Y, horizontalAngle) *
+      Quaternionf(Vector3f::UNIT_X, -verticalAngle);
 
-    Vector3f up = right.Cross(direction);
+    Vector3f direction = orientation * Vector3f::UNIT_Z;
+    Vector3f right = orientation * Vector3f::NEGATIVE_UNIT_X;
+    Vector3f up = orientation * Vector3f::UNIT_Y;
 
     const uint8_t* keyboard = window->GetKeyboardState(0);
 
@@ -940,78 +1737,173 @@ int main (int argc, char* argv[])
 
     //glDepthMask(true);
 
-    float t0 = Timer::GetTimeInSeconds();
+#if RENDERMAP
+    RiotMap* map1 = leftSession.GetMap();
+    RiotMap* map11 = rightSession.GetMap();
+#endif
 
+    // Draw for a few frames after anything that changes the picture, so
+    // the last uploads make it to the screen too.  Otherwise what was
+    // presented last stays up.
+    ViewState viewState = {position, horizontalAngle, verticalAngle, FoV,
+      splitmode, renderer->GetWidth(), renderer->GetHeight(), {0, 0}};
 #if RENDERMAP
-    map1frame.bind();
-    glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
-    map1.render(mvp);
-    map1frame.unbind();
+    viewState.maps[0] = map1;
+    viewState.maps[1] = map11;
 #endif
-    float t1 = Timer::GetTimeInSeconds();
+    if(input || !settled || !viewState.Same(lastView))
+      redraw = REDRAW_FRAMES;
+    bool draw = alwaysRedraw || redraw > 0;
+    if(draw)
+    {
+      redraw = max(redraw - 1, 0);
+      lastView = viewState;
+
+      // The size the maps are drawn at this frame.
+      float scale = resolution.GetScale();
+      int frameWidth = max((int)(renderer->GetWidth()*scale + 0.5f), 1);
+      int frameHeight = max((int)(renderer->GetHeight()*scale + 0.5f), 1);
+      // The mvp above mirrors z, so mirror the eye into map space too.
+      Vector3f eye(position.x,position.y,-position.z);
 #if RENDERMAP
-    map11frame.bind();
-    glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
-    map11.render(mvp);
-    map11frame.unbind();
+      {
+        // Mips are picked for the pixels actually drawn.
+        float pixelScale = projection.m11 * frameHeight * 0.5f;
+        if(map1)
+          map1->stream(eye,pixelScale);
+        if(map11)
+          map11->stream(eye,pixelScale);
+      }
 #endif
-    float t2 = Timer::GetTimeInSeconds();
 
+      double t0 = Timer::GetPreciseTimeInSeconds();
+      if(targetMs > 0)
+        gpuTimer.Begin();
 
-    glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+      // Maps the split mode doesn't show aren't drawn, the others only
+      // where they are shown.
+      const float (*columns)[2] = splitColumns[splitmode];
+      FrameBuffer* map1frame = 0;
+      FrameBuffer* map11frame = 0;
+      if(columns[0][0] < columns[0][1])
+      {
+        map1frame = frames.acquire(frameWidth, frameHeight);
+        map1frame->bind(columns[0][0],columns[0][1]);
+        glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+#if RENDERMAP
+        if(map1)
+          map1->render(mvp,eye,columns[0][0],columns[0][1]);
+#endif
+        map1frame->unbind();
+      }
+      double t1 = Timer::GetPreciseTimeInSeconds();
+      if(columns[1][0] < columns[1][1])
+      {
+        map11frame = frames.acquire(frameWidth, frameHeight);
+        map11frame->bind(columns[1][0],columns[1][1]);
+        glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+#if RENDERMAP
+        if(map11)
+          map11->render(mvp,eye,columns[1][0],columns[1][1]);
+#endif
+        map11frame->unbind();
+      }
+      double t2 = Timer::GetPreciseTimeInSeconds();
 
-    split_1->Use();
+      // What the maps took on the GPU a few frames ago, or without timer
+      // queries what they took to submit now.
+      if(targetMs > 0)
+      {
+        gpuTimer.End();
+        double milliseconds = (t2 - t0) * 1000;
+        if(!gpuTimer.IsSupported() || gpuTimer.GetResult(milliseconds))
+          resolution.Update(milliseconds);
+      }
 
-    glUniformMatrix4fv(s1mvp, 1, GL_TRUE, mvps._m);
+      glViewport(0, 0, renderer->GetWidth(), renderer->GetHeight());
+      glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 
-    glUniform1i(s1mode,splitmode);
+      // Drawn at full size there is nothing to sharpen.
+      int filter = scale < 1 ? upscale : UPSCALE_BILINEAR;
+      split_1[splitmode][filter]->Use();
 
-    glUniform1i(s1tex0,0);
-    glUniform1i(s1tex1,1);
+      glUniformMatrix4fv(s1mvp[splitmode][filter], 1, GL_TRUE, mvps._m);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D,map1frame.textureId);
+      glUniform1i(s1tex0[splitmode][filter],0);
+      glUniform1i(s1tex1[splitmode][filter],1);
+      if(filter == UPSCALE_SHARPEN)
+      {
+        glUniform2f(s1texel[splitmode][filter], 1.0f/frameWidth, 1.0f/frameHeight);
+        // More the further the frames are stretched, 0.2 at half size.
+        glUniform1f(s1sharpness[splitmode][filter], 0.4f*(1 - scale));
+      }
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D,map11frame.textureId);
+      glActiveTexture(GL_TEXTURE0);
+      glBindTexture(GL_TEXTURE_2D,map1frame ? map1frame->textureId : 0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, quadbuf);
+      glActiveTexture(GL_TEXTURE1);
+      glBindTexture(GL_TEXTURE_2D,map11frame ? map11frame->textureId : 0);
 
-    glVertexAttribPointer(
-      Program::POSITION,
-      2,
-      GL_FLOAT,
-      GL_FALSE,
-      0,
-      (const GLvoid*)(0)
-    );
+      glBindBuffer(GL_ARRAY_BUFFER, quadbuf);
 
-    glVertexAttribPointer(
-      Program::UV0,
-      2,
-      GL_FLOAT,
-      GL_FALSE,
-      0,
-      (const GLvoid*)(0)
-    );
+      glVertexAttribPointer(
+        Program::POSITION,
+        2,
+        GL_FLOAT,
+        GL_FALSE,
+        0,
+        (const GLvoid*)(0)
+      );
+
+      glVertexAttribPointer(
+        Program::UV0,
+        2,
+        GL_FLOAT,
+        GL_FALSE,
+        0,
+        (const GLvoid*)(0)
+      );
 
-    glEnableVertexAttribArray(Program::POSITION);
-    glEnableVertexAttribArray(Program::UV0);
+      glEnableVertexAttribArray(Program::POSITION);
+      glEnableVertexAttribArray(Program::UV0);
 
-    glDrawArrays(GL_TRIANGLES,0,6);
+      glDrawArrays(GL_TRIANGLES,0,6);
 
-    glDisableVertexAttribArray(Program::POSITION);
-    glDisableVertexAttribArray(Program::UV0);
+      glDisableVertexAttribArray(Program::POSITION);
+      glDisableVertexAttribArray(Program::UV0);
 
-    glUseProgram(0);
+      glUseProgram(0);
 
-    textrender->Render("CATT",SDL_BLUE,100,100,50);
+      textrender->Render("CATT",SDL_BLUE,100,100,50);
 
-    window->SwapBuffers();
+      {
+        TRACE_ZONE("SwapBuffers");
+        window->SwapBuffers();
+      }
+      frames.endFrame();
+    }
+    // Sleep through the next frame unless something comes up.
+    idle = !draw && settled;
+    frameGuard.End();
+    frame++;
+
+    JobSystem::Instance().PumpMain();
+    if(RiotMap::uploads)
+      RiotMap::uploads->Update();
+    if(RiotMap::streamer)
+      RiotMap::streamer->Update();
+#if RENDERMAP
+    leftSession.Update();
+    rightSession.Update();
+#endif
 
     //glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
     //fwrite(buffer, sizeof(int)*WIDTH*HEIGHT, 1, ffmpeg);
   }
   // _pclose(ffmpeg);
+  if(traceAtExit)
+    Trace::Dump(traceFile.c_str());
+  if(memoryReport)
+    MemoryTracker::Report(cout);
   return 0;
 }
@@ -0,0 +1,690 @@
+#include "Core.h"
+#include "LOLMap.h"
+#include "TextureCompressor.h"
+#include "JobSystem.h"
+#include "Math/Vector3.h"
+#include <sys/stat.h>
+using namespace std;
+
+//	Synthetic map generator
+//	Writes a room.nvr laid out the way read_map reads it, and the textures
+//	it names, so the loader and the renderer can be measured without the
+//	original map files and at sizes well past any real map.
+//
+//	The map is a square grid of terrain cells.  Each cell is one model with
+//	a _chunk_ material of its own, four blend (flag1 3) and plain (flag1 0)
+//	terrain alternating, and props, decals (flag1 1) and flag1 2 models are
+//	scattered over the cells.  Every vertex layout shows up: 9 floats for
+//	flag1 0 without flag2 and for flag1 1 and 2, 10 for flag1 0 with flag2
+//	set, 11 for four blend.  Like in the real maps the second mesh of every
+//	model is a position only copy kept in vertex lists of its own after the
+//	others.  The records after the models are a quadtree over the cells,
+//	breadth first: a box, then first model, model count, first child and
+//	child count.  Models of a cell are stored together and cells in tree
+//	order, so every node covers one run of models.
+//
+//	Scale 1 is about the size of Summoner's Rift: 128 materials, 2048
+//	models and 128 vertex lists over 15000 units square.  The scale
+//	multiplies the counts and the area.  The same arguments give the same
+//	map.
+//
+//	usage: mapgen [-s scale] [-m materials] [-n models] [-l vertex lists]
+//		[-t textures] [-p texture pixels] [-r seed] <map folder>
+
+static const float RIFT_SIZE = 15000;
+static const uint32_t MAX_LIST_VERTICES = 65536;
+static const int TERRAIN_QUADS = 32;
+static const uint32_t NVR_VERSION = 65545;
+static const uint32_t D3DFMT_INDEX16 = 101;
+
+enum PieceKind
+{
+	PIECE_TERRAIN,
+	PIECE_PROP,
+	PIECE_DECAL
+};
+
+// One model before its geometry is built.
+struct Piece
+{
+	int material;
+	int kind;
+	int quads;		// per side
+	float x, z;		// corner
+	float size;
+	float height;
+	Vector3f min;
+	Vector3f max;
+};
+
+struct VertexList
+{
+	int stride;
+	vector<float> vertices;
+	vector<uint16_t> indices;
+};
+
+struct TreeNode
+{
+	int cell;		// leaves only, -1 otherwise
+	vector<int> children;
+	uint32_t first;
+	uint32_t count;
+	Vector3f min;
+	Vector3f max;
+};
+
+// splitmix64, so a seed gives the same map everywhere.
+static uint64_t random_state;
+
+static uint32_t random_u32()
+{
+	uint64_t z = (random_state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+static float random_float(float lo, float hi)
+{
+	return lo + (hi - lo) * (random_u32() >> 8) * (1.0f / 16777216);
+}
+
+static int random_int(int lo, int hi)
+{
+	return lo + (int)(random_u32() % (uint32_t)(hi - lo + 1));
+}
+
+static float ground(float x, float z)
+{
+	return -100 + 60 * sinf(x / 900) * cosf(z / 700) + 15 * sinf((x + z) / 230);
+}
+
+static float height(const Piece& piece, float x, float z)
+{
+	switch(piece.kind)
+	{
+	case PIECE_PROP:
+	{
+		float u = 2 * (x - piece.x) / piece.size - 1;
+		float v = 2 * (z - piece.z) / piece.size - 1;
+		return ground(x,z) + piece.height * max(0.0f,1 - u*u - v*v);
+	}
+	case PIECE_DECAL:
+		return ground(x,z) + 2;
+	default:
+		return ground(x,z);
+	}
+}
+
+//	Textures
+//	Only depend on their index and size.  Tiles repeat seamlessly, masks
+//	are smooth RGB waves, decals a soft disc with alpha so they come out
+//	as BC3.
+
+static uint32_t hash_u32(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352d;
+	x ^= x >> 15;
+	x *= 0x846ca68b;
+	x ^= x >> 16;
+	return x;
+}
+
+static uint8_t to_byte(float x)
+{
+	return (uint8_t)min(255.0f,max(0.0f,x * 255 + 0.5f));
+}
+
+static void tile_texture(uint32_t index, uint32_t size, vector<uint8_t>& rgba)
+{
+	uint32_t h = hash_u32(index);
+	float base[3] = {
+		0.3f + 0.5f * (h & 255) / 255,
+		0.3f + 0.5f * ((h >> 8) & 255) / 255,
+		0.3f + 0.5f * ((h >> 16) & 255) / 255
+	};
+	uint32_t period = max(1u,size >> (2 + (h >> 24) % 4));
+
+	for(uint32_t y=0;y!=size;y++)
+	{
+		for(uint32_t x=0;x!=size;x++)
+		{
+			float checker = ((x / period + y / period) & 1) ? 1.0f : 0.75f;
+			float noise = 0.85f + 0.15f * (hash_u32(index ^ (y * size + x)) & 255) / 255;
+			uint8_t* p = &rgba[(y * size + x) * 4];
+			for(int c=0;c!=3;c++)
+				p[c] = to_byte(base[c] * checker * noise);
+			p[3] = 255;
+		}
+	}
+}
+
+static void mask_texture(uint32_t index, uint32_t size, vector<uint8_t>& rgba)
+{
+	uint32_t h = hash_u32(index + 0x10000);
+	for(uint32_t y=0;y!=size;y++)
+	{
+		for(uint32_t x=0;x!=size;x++)
+		{
+			uint8_t* p = &rgba[(y * size + x) * 4];
+			for(int c=0;c!=3;c++)
+			{
+				int kx = 1 + ((h >> (c * 8)) & 3);
+				int ky = 1 + ((h >> (c * 8 + 2)) & 3);
+				float phase = 2 * Math<float>::PI * (kx * x + ky * y) / (float)size;
+				p[c] = to_byte(0.5f + 0.5f * sinf(phase + c));
+			}
+			p[3] = 255;
+		}
+	}
+}
+
+static void decal_texture(uint32_t index, uint32_t size, vector<uint8_t>& rgba)
+{
+	tile_texture(index + 0x20000,size,rgba);
+	for(uint32_t y=0;y!=size;y++)
+	{
+		for(uint32_t x=0;x!=size;x++)
+		{
+			float u = 2 * (x + 0.5f) / size - 1;
+			float v = 2 * (y + 0.5f) / size - 1;
+			rgba[(y * size + x) * 4 + 3] = to_byte(1 - sqrtf(u*u + v*v));
+		}
+	}
+}
+
+static string texture_name(const char* kind, uint32_t index)
+{
+	char name[64];
+	snprintf(name,sizeof(name),"synth_%s_%04u.dds",kind,index);
+	return name;
+}
+
+static bool write_texture(const string& filename, uint32_t size,
+	void (*generate)(uint32_t,uint32_t,vector<uint8_t>&), uint32_t index,
+	uint64_t& bytes)
+{
+	vector<uint8_t> rgba((size_t)size * size * 4);
+	generate(index,size,rgba);
+	DDSImage image;
+	compress_image(rgba.data(),size,size,image);
+	bytes += image.data.size();
+	return write_dds(filename.c_str(),image);
+}
+
+static void set_texture(LOLMapMaterial& mat, int slot, const string& name)
+{
+	snprintf(mat.textures[slot].filename,sizeof(mat.textures[slot].filename),
+		"%s",name.c_str());
+	// Looks like a transform, identity is the safe guess.
+	float* m = (float*)mat.textures[slot].unknown2;
+	for(int i=0;i!=4;i++)
+		m[i*4+i] = 1;
+}
+
+//	Geometry
+
+// The list of this stride that takes count more vertices, a new one once
+// the current one has limit.
+static int place(vector<VertexList>& lists, map<int,int>& current,
+	int stride, uint32_t count, uint32_t limit)
+{
+	map<int,int>::iterator it = current.find(stride);
+	if(it == current.end() ||
+		lists[it->second].vertices.size() / stride + count > limit)
+	{
+		lists.push_back(VertexList());
+		lists.back().stride = stride;
+		current[stride] = lists.size() - 1;
+		return lists.size() - 1;
+	}
+	return it->second;
+}
+
+// Grid of quads x quads over the piece, triangles facing up.
+static void build_piece(Piece& piece, int s, VertexList& list,
+	LOLMapModelData& data, VertexList& simple, LOLMapModelData& simpleData,
+	uint32_t listIndex, uint32_t simpleIndex)
+{
+	int q = piece.quads;
+	uint32_t base = list.vertices.size() / s;
+	uint32_t simpleBase = simple.vertices.size() / 3;
+	float step = piece.size / q;
+	piece.min = Vector3f(FLT_MAX,FLT_MAX,FLT_MAX);
+	piece.max = -piece.min;
+
+	for(int i=0;i<=q;i++)
+	{
+		for(int j=0;j<=q;j++)
+		{
+			float u = (float)i / q, v = (float)j / q;
+			float x = piece.x + i * step, z = piece.z + j * step;
+			float y = height(piece,x,z);
+			float e = step * 0.5f;
+			Vector3f normal(height(piece,x - e,z) - height(piece,x + e,z),2 * e,
+				height(piece,x,z - e) - height(piece,x,z + e));
+			normal.Normalize();
+
+			float vertex[11] = {x,y,z,normal.x,normal.y,normal.z};
+			switch(piece.kind)
+			{
+			case PIECE_TERRAIN:
+				vertex[6] = x / 512;
+				vertex[7] = z / 512;
+				break;
+			case PIECE_PROP:
+				vertex[6] = u * piece.size / 256;
+				vertex[7] = v * piece.size / 256;
+				break;
+			default:
+				vertex[6] = u;
+				vertex[7] = v;
+				break;
+			}
+			if(s == 11)
+			{
+				vertex[8] = u;
+				vertex[9] = v;
+			}
+			list.vertices.insert(list.vertices.end(),vertex,vertex + s);
+			simple.vertices.insert(simple.vertices.end(),vertex,vertex + 3);
+
+			Vector3f p(x,y,z);
+			for(int k=0;k!=3;k++)
+			{
+				piece.min[k] = min(piece.min[k],p[k]);
+				piece.max[k] = max(piece.max[k],p[k]);
+			}
+		}
+	}
+
+	uint32_t indexOffset = list.indices.size();
+	uint32_t simpleOffset = simple.indices.size();
+	for(int i=0;i!=q;i++)
+	{
+		for(int j=0;j!=q;j++)
+		{
+			uint32_t a = i * (q + 1) + j;
+			uint32_t quad[6] = {a,a + 1,a + q + 1,a + q + 1,a + 1,a + q + 2};
+			for(int k=0;k!=6;k++)
+			{
+				list.indices.push_back(base + quad[k]);
+				simple.indices.push_back(simpleBase + quad[k]);
+			}
+		}
+	}
+
+	uint32_t vertices = (q + 1) * (q + 1);
+	LOLMapModelData d = {listIndex,base,vertices,listIndex,indexOffset,
+		(uint32_t)q * q * 6};
+	data = d;
+	LOLMapModelData sd = {simpleIndex,simpleBase,vertices,simpleIndex,
+		simpleOffset,(uint32_t)q * q * 6};
+	simpleData = sd;
+}
+
+//	Tree
+
+static int build_tree(vector<TreeNode>& nodes, vector<int>& cells, int grid,
+	int x0, int z0, int x1, int z1)
+{
+	int index = nodes.size();
+	TreeNode node = {-1,vector<int>(),0,0,Vector3f::ZERO,Vector3f::ZERO};
+	nodes.push_back(node);
+	if(x1 - x0 == 1 && z1 - z0 == 1)
+	{
+		nodes[index].cell = cells.size();
+		cells.push_back(z0 * grid + x0);
+		return index;
+	}
+
+	int mx = x1 - x0 > 1 ? (x0 + x1) / 2 : x1;
+	int mz = z1 - z0 > 1 ? (z0 + z1) / 2 : z1;
+	int xs[3] = {x0,mx,x1}, zs[3] = {z0,mz,z1};
+	for(int a=0;a!=2;a++)
+	{
+		for(int b=0;b!=2;b++)
+		{
+			if(xs[a] == xs[a+1] || zs[b] == zs[b+1])
+				continue;
+			int child = build_tree(nodes,cells,grid,xs[a],zs[b],xs[a+1],zs[b+1]);
+			nodes[index].children.push_back(child);
+		}
+	}
+	return index;
+}
+
+static void fill_tree(vector<TreeNode>& nodes, int index,
+	const vector<uint32_t>& cellFirst, const vector<Piece>& pieces)
+{
+	TreeNode& node = nodes[index];
+	node.min = Vector3f(FLT_MAX,FLT_MAX,FLT_MAX);
+	node.max = -node.min;
+	if(node.cell >= 0)
+	{
+		node.first = cellFirst[node.cell];
+		node.count = cellFirst[node.cell + 1] - node.first;
+		for(uint32_t m=node.first;m!=node.first + node.count;m++)
+		{
+			for(int k=0;k!=3;k++)
+			{
+				node.min[k] = min(node.min[k],pieces[m].min[k]);
+				node.max[k] = max(node.max[k],pieces[m].max[k]);
+			}
+		}
+		return;
+	}
+
+	node.first = UINT32_MAX;
+	node.count = 0;
+	for(size_t i=0;i!=node.children.size();i++)
+	{
+		fill_tree(nodes,node.children[i],cellFirst,pieces);
+		const TreeNode& child = nodes[node.children[i]];
+		node.first = min(node.first,child.first);
+		node.count += child.count;
+		for(int k=0;k!=3;k++)
+		{
+			node.min[k] = min(node.min[k],child.min[k]);
+			node.max[k] = max(node.max[k],child.max[k]);
+		}
+	}
+}
+
+static void flatten_tree(const vector<TreeNode>& nodes,
+	vector<LOLMapUnknown>& records)
+{
+	vector<int> order(1,0);
+	records.resize(nodes.size());
+	for(size_t i=0;i!=order.size();i++)
+	{
+		const TreeNode& node = nodes[order[i]];
+		LOLMapUnknown& r = records[i];
+		for(int k=0;k!=3;k++)
+		{
+			r.unknown_1[k] = node.min[k];
+			r.unknown_1[k + 3] = node.max[k];
+		}
+		r.unknown_2[0] = node.first;
+		r.unknown_2[1] = node.count;
+		r.unknown_2[2] = node.children.empty() ? -1 : (int)order.size();
+		r.unknown_2[3] = node.children.size();
+		order.insert(order.end(),node.children.begin(),node.children.end());
+	}
+}
+
+template<typename T>
+static void write(const T& data, ostream& out)
+{
+	out.write((const char*)&data,sizeof(T));
+}
+
+// Creates every missing directory along path, which ends in a '/'.
+static void make_directories(const string& path)
+{
+	for(size_t i=1;i!=path.size();i++)
+	{
+		if(path[i] != '/')
+			continue;
+#if defined(_WIN32) || defined(_WIN64)
+		mkdir(path.substr(0,i).c_str());
+#else
+		mkdir(path.substr(0,i).c_str(),0755);
+#endif
+	}
+}
+
+static void usage()
+{
+	cerr << "usage: mapgen [-s scale] [-m materials] [-n models] "
+		"[-l vertex lists] [-t textures] [-p texture pixels] [-r seed] "
+		"<map folder>" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+	JobSystem::Instance();
+
+	double scale = 1;
+	int materials = 0, models = 0, lists = 0, textures = 0;
+	uint32_t pixels = 256;
+	uint64_t seed = 1;
+	string folder;
+	for(int i=1;i<argc;i++)
+	{
+		string arg = argv[i];
+		if(arg.size() == 2 && arg[0] == '-' && i+1 < argc)
+		{
+			const char* value = argv[++i];
+			switch(arg[1])
+			{
+			case 's': scale = atof(value); break;
+			case 'm': materials = atoi(value); break;
+			case 'n': models = atoi(value); break;
+			case 'l': lists = atoi(value); break;
+			case 't': textures = atoi(value); break;
+			case 'p': pixels = atoi(value); break;
+			case 'r': seed = strtoull(value,0,10); break;
+			default: usage(); return 1;
+			}
+		} else if(folder.empty() && arg[0] != '-') {
+			folder = arg;
+		} else {
+			usage();
+			return 1;
+		}
+	}
+	if(folder.empty() || scale <= 0 || !pixels)
+	{
+		usage();
+		return 1;
+	}
+	if(folder[folder.size()-1] != '/')
+		folder += '/';
+
+	// Enough of everything for every material type to show up.
+	materials = max(8,materials ? materials : (int)(128 * scale));
+	models = max(8,models ? models : (int)(2048 * scale));
+	lists = max(1,lists ? lists : (int)(128 * scale));
+	textures = max(1,textures ? textures : (int)(128 * scale));
+	int masks = max(1,textures / 8), decals = max(1,textures / 8);
+	random_state = seed;
+
+	int grid = max(1,(int)sqrt(min(materials,models) / 2));
+	int cellCount = grid * grid;
+	float size = RIFT_SIZE * sqrt(scale);
+	float cell = size / grid;
+
+	// Terrain materials first, one per cell, then the props cycling through
+	// flag1 0 without and with flag2, decals and flag1 2.
+	vector<LOLMapMaterial> mats(materials);
+	memset(mats.data(),0,mats.size() * sizeof(LOLMapMaterial));
+	for(int i=0;i!=materials;i++)
+	{
+		LOLMapMaterial& mat = mats[i];
+		if(i < cellCount)
+		{
+			int cx = i % grid, cz = i / grid;
+			snprintf(mat.name,sizeof(mat.name),"_chunk_synth_%03d_%03d",cx,cz);
+			if((cx + cz) % 2 == 0)
+			{
+				mat.flag1 = 3;
+				set_texture(mat,1,texture_name("mask",random_u32() % masks));
+				for(int slot=0;slot<8;slot+=2)
+					set_texture(mat,slot,texture_name("tile",random_u32() % textures));
+			} else {
+				mat.flag2 = 20;
+				set_texture(mat,0,texture_name("tile",random_u32() % textures));
+			}
+			continue;
+		}
+
+		int type = (i - cellCount) % 4;
+		if(type == 2)
+		{
+			snprintf(mat.name,sizeof(mat.name),"synth_decal_%04d",i);
+			mat.flag1 = 1;
+			mat.flag2 = 16;
+			set_texture(mat,0,texture_name("decal",random_u32() % decals));
+			continue;
+		}
+		snprintf(mat.name,sizeof(mat.name),"synth_prop_%04d",i);
+		mat.flag1 = type == 3 ? 2 : 0;
+		mat.flag2 = type == 1 ? 20 : 0;
+		set_texture(mat,0,texture_name("tile",random_u32() % textures));
+	}
+
+	// Cells in tree order, each its terrain and then its share of props.
+	vector<TreeNode> nodes;
+	vector<int> cells;
+	build_tree(nodes,cells,grid,0,0,grid,grid);
+
+	vector<Piece> pieces;
+	vector<uint32_t> cellFirst;
+	int props = models - cellCount;
+	for(int c=0;c!=cellCount;c++)
+	{
+		cellFirst.push_back(pieces.size());
+		int cx = cells[c] % grid, cz = cells[c] / grid;
+		Piece terrain = {cells[c],PIECE_TERRAIN,TERRAIN_QUADS,cx * cell,cz * cell,
+			cell,0,Vector3f::ZERO,Vector3f::ZERO};
+		pieces.push_back(terrain);
+
+		int count = (int)((int64_t)props * (c + 1) / cellCount -
+			(int64_t)props * c / cellCount);
+		for(int k=0;k!=count;k++)
+		{
+			Piece piece = {0,0,0,0,0,0,0,Vector3f::ZERO,Vector3f::ZERO};
+			piece.material = random_int(cellCount,materials - 1);
+			piece.kind = mats[piece.material].flag1 == 1 ? PIECE_DECAL : PIECE_PROP;
+			bool decal = piece.kind == PIECE_DECAL;
+			piece.quads = decal ? random_int(2,4) : random_int(4,10);
+			piece.size = min(cell,decal ? random_float(100,400) :
+				random_float(100,600));
+			piece.x = cx * cell + random_float(0,cell - piece.size);
+			piece.z = cz * cell + random_float(0,cell - piece.size);
+			piece.height = random_float(50,300);
+			pieces.push_back(piece);
+		}
+	}
+	cellFirst.push_back(pieces.size());
+
+	// Vertex lists hold one layout each, filled in model order until they
+	// reach their share of the vertices.
+	uint64_t total = 0;
+	for(size_t m=0;m!=pieces.size();m++)
+		total += (pieces[m].quads + 1) * (pieces[m].quads + 1);
+	uint32_t limit = (uint32_t)min<uint64_t>(MAX_LIST_VERTICES,
+		max<uint64_t>((TERRAIN_QUADS + 1) * (TERRAIN_QUADS + 1),total / lists));
+
+	vector<VertexList> vertexLists, simpleLists;
+	map<int,int> current, currentSimple;
+	vector<LOLMapModel> out(pieces.size());
+	memset(out.data(),0,out.size() * sizeof(LOLMapModel));
+	for(size_t m=0;m!=pieces.size();m++)
+	{
+		Piece& piece = pieces[m];
+		int s = mats[piece.material].stride();
+		uint32_t count = (piece.quads + 1) * (piece.quads + 1);
+		int l = place(vertexLists,current,s,count,limit);
+		int sl = place(simpleLists,currentSimple,3,count,MAX_LIST_VERTICES);
+		LOLMapModel& model = out[m];
+		build_piece(piece,s,vertexLists[l],model.model[0],simpleLists[sl],model.model[1],
+			l,sl);
+
+		// Quality and flags as seen in Summoner's Rift, then the bounding
+		// sphere and box as floats.
+		model.flag_1 = 0xffffffff;
+		model.material = piece.material;
+		Vector3f center = (piece.min + piece.max) * 0.5f;
+		float bounds[10] = {center.x,center.y,center.z,
+			(piece.max - piece.min).Length() * 0.5f,
+			piece.min.x,piece.min.y,piece.min.z,piece.max.x,piece.max.y,
+			piece.max.z};
+		memcpy(model.b,bounds,sizeof(bounds));
+	}
+	for(size_t m=0;m!=out.size();m++)
+	{
+		out[m].model[1].vertex_index += vertexLists.size();
+		out[m].model[1].index_index += vertexLists.size();
+	}
+	vertexLists.insert(vertexLists.end(),simpleLists.begin(),
+		simpleLists.end());
+
+	fill_tree(nodes,0,cellFirst,pieces);
+	vector<LOLMapUnknown> records;
+	flatten_tree(nodes,records);
+
+	make_directories(folder + "Scene/Textures/");
+	string filename = folder + "Scene/room.nvr";
+	ofstream nvr(filename.c_str(),ios::binary);
+	if(!nvr)
+	{
+		cerr << "Can't write " << filename << endl;
+		return 1;
+	}
+
+	write("NVR",nvr);
+	write(NVR_VERSION,nvr);
+	write((uint32_t)mats.size(),nvr);
+	write((uint32_t)vertexLists.size(),nvr);
+	write((uint32_t)vertexLists.size(),nvr);
+	write((uint32_t)out.size(),nvr);
+	write((uint32_t)records.size(),nvr);
+	nvr.write((const char*)mats.data(),mats.size() * sizeof(LOLMapMaterial));
+	for(size_t i=0;i!=vertexLists.size();i++)
+	{
+		write((uint32_t)(vertexLists[i].vertices.size() * sizeof(float)),nvr);
+		nvr.write((const char*)vertexLists[i].vertices.data(),
+			vertexLists[i].vertices.size() * sizeof(float));
+	}
+	for(size_t i=0;i!=vertexLists.size();i++)
+	{
+		write((uint32_t)(vertexLists[i].indices.size() * sizeof(uint16_t)),nvr);
+		write(D3DFMT_INDEX16,nvr);
+		nvr.write((const char*)vertexLists[i].indices.data(),
+			vertexLists[i].indices.size() * sizeof(uint16_t));
+	}
+	nvr.write((const char*)out.data(),out.size() * sizeof(LOLMapModel));
+	nvr.write((const char*)records.data(),
+		records.size() * sizeof(LOLMapUnknown));
+	uint64_t nvrBytes = nvr.tellp();
+	nvr.close();
+	if(!nvr)
+	{
+		cerr << "Failed writing " << filename << endl;
+		return 1;
+	}
+
+	string dir = folder + "Scene/Textures/";
+	uint64_t textureBytes = 0;
+	bool ok = true;
+	for(int i=0;i!=textures;i++)
+		ok &= write_texture(dir + texture_name("tile",i),pixels,tile_texture,i,
+			textureBytes);
+	for(int i=0;i!=masks;i++)
+		ok &= write_texture(dir + texture_name("mask",i),pixels,mask_texture,i,
+			textureBytes);
+	for(int i=0;i!=decals;i++)
+		ok &= write_texture(dir + texture_name("decal",i),pixels,decal_texture,i,
+			textureBytes);
+	if(!ok)
+	{
+		cerr << "Failed writing textures to " << dir << endl;
+		return 1;
+	}
+
+	cout << filename << endl;
+	cout << "materials " << mats.size() << " (" << cellCount << " chunks)" << endl;
+	cout << "models " << out.size() << endl;
+	cout << "vertex lists " << vertexLists.size() << " (" << simpleLists.size() <<
+		" position only)" << endl;
+	cout << "vertices " << total << endl;
+	cout << "tree nodes " << records.size() << endl;
+	cout << "nvr " << nvrBytes / (1024*1024.0) << "MB, textures " <<
+		textures + masks + decals << " " << textureBytes / (1024*1024.0) <<
+		"MB" << endl;
+	return 0;
+}
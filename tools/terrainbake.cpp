@@ -0,0 +1,453 @@
+#include "Core.h"
+#include "LOLMap.h"
+#include "TextureCompressor.h"
+#include "JobSystem.h"
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_image.h"
+#include <sys/stat.h>
+using namespace std;
+
+//	Offline terrain blend baker
+//	Renders every four blend (flag1 3) material the way MAP_FOUR_BLEND.frag
+//	does, the tile in slot 0 with the ones in slots 2, 4 and 6 mixed over
+//	it by the red, green and blue of the mask in slot 1, into one texture
+//	over the material's UV1 space, and writes it compressed with its mips
+//	to Scene/Baked/<material>.dds.  RiotMap draws far terrain with those
+//	instead of sampling five textures per pixel.
+//
+//	UV1 is the space of the blend mask and has to cover each chunk once,
+//	materials with UV1 outside [0,1] are left out.
+//	The size of a bake follows the ground extent of the chunk times the
+//	texel density, in texels per map unit, rounded up to a power of two.
+//
+//	usage: terrainbake [-f] [-d texels per unit] <map folder>
+
+static const uint32_t MIN_SIZE = 16;
+static const uint32_t MAX_SIZE = 2048;
+// Texels the bake is grown by past the edges of its triangles, so the
+// filtering and the coarser mips don't pull in the unused background.
+static const int DILATE_TEXELS = 8;
+
+static bool force = false;
+
+// An input texture with every level decoded to RGBA8.
+struct Source
+{
+	DDSImage image;
+	vector<vector<uint8_t> > levels;
+};
+
+// How far UV1 may stray past [0,1] before a material isn't baked.
+static const float UV1_SLACK = 1e-3f;
+
+static bool exists(const string& path)
+{
+	ifstream fi(path.c_str());
+	return (bool)fi;
+}
+
+static void load_source(const string& name, Source& source)
+{
+	source.levels.clear();
+	if(!load_image(name.c_str(),source.image))
+	{
+		string png = name.substr(0,name.size()-3) + "png";
+		if(!load_image(png.c_str(),source.image))
+			return;
+	}
+	source.levels.resize(source.image.levels.size());
+	for(size_t i=0;i!=source.levels.size();i++)
+	{
+		const DDSLevel& l = source.image.levels[i];
+		source.levels[i].resize(l.width*l.height*4);
+		decode_dds_level(source.image,i,source.levels[i].data());
+	}
+	source.image.data.clear();
+}
+
+// Bilinear at (u,v) of one level, repeating or clamped at the edges.
+static void sample(const Source& source, float footprint, float u, float v,
+	bool wrap, float out[4])
+{
+	// The level whose texels are about one texel of the bake.
+	size_t level = 0;
+	while(footprint >= 2 && level + 1 < source.levels.size())
+	{
+		footprint *= 0.5f;
+		level++;
+	}
+	const DDSLevel& l = source.image.levels[level];
+	const uint8_t* rgba = source.levels[level].data();
+	int w = l.width, h = l.height;
+
+	float x = u*w - 0.5f, y = v*h - 0.5f;
+	int x0 = (int)floor(x), y0 = (int)floor(y);
+	float fx = x - x0, fy = y - y0;
+	for(int k=0;k!=4;k++)
+		out[k] = 0;
+	for(int dy=0;dy!=2;dy++)
+	{
+		for(int dx=0;dx!=2;dx++)
+		{
+			int xi = x0 + dx, yi = y0 + dy;
+			if(wrap)
+			{
+				xi = (xi % w + w) % w;
+				yi = (yi % h + h) % h;
+			} else {
+				xi = min(max(xi,0),w - 1);
+				yi = min(max(yi,0),h - 1);
+			}
+			float weight = (dx ? fx : 1 - fx) * (dy ? fy : 1 - fy);
+			const uint8_t* texel = rgba + (yi*w + xi)*4;
+			for(int k=0;k!=4;k++)
+				out[k] += weight * texel[k];
+		}
+	}
+}
+
+// Texture texels per bake texel over a triangle, from the areas it covers
+// in both.
+static float footprint(const Source& source, float uvArea, float bakeArea)
+{
+	if(source.levels.empty() || bakeArea <= 0)
+		return 1;
+	const DDSLevel& l = source.image.levels[0];
+	return sqrt(fabs(uvArea) * l.width * l.height / bakeArea);
+}
+
+// Fills the texels around what the triangles covered with the average of
+// their covered neighbours, and whatever is still empty after that with
+// the average of the whole bake.
+static void dilate(vector<uint8_t>& rgba, vector<uint8_t>& covered,
+	uint32_t size)
+{
+	vector<uint8_t> next;
+	for(int pass=0;pass!=DILATE_TEXELS;pass++)
+	{
+		next = covered;
+		for(uint32_t y=0;y!=size;y++)
+		{
+			for(uint32_t x=0;x!=size;x++)
+			{
+				if(covered[y*size + x])
+					continue;
+				static const int offsets[4][2] = {{-1,0},{1,0},{0,-1},{0,1}};
+				int sum[4] = {0,0,0,0}, count = 0;
+				for(int n=0;n!=4;n++)
+				{
+					int nx = x + offsets[n][0], ny = y + offsets[n][1];
+					if(nx < 0 || ny < 0 || nx >= (int)size || ny >= (int)size ||
+						!covered[ny*size + nx])
+						continue;
+					for(int k=0;k!=4;k++)
+						sum[k] += rgba[(ny*size + nx)*4 + k];
+					count++;
+				}
+				if(!count)
+					continue;
+				for(int k=0;k!=4;k++)
+					rgba[(y*size + x)*4 + k] = (uint8_t)(sum[k] / count);
+				next[y*size + x] = 1;
+			}
+		}
+		covered.swap(next);
+	}
+
+	uint64_t sum[4] = {0,0,0,0}, count = 0;
+	for(uint32_t i=0;i!=size*size;i++)
+	{
+		if(!covered[i])
+			continue;
+		for(int k=0;k!=4;k++)
+			sum[k] += rgba[i*4 + k];
+		count++;
+	}
+	for(uint32_t i=0;i!=size*size && count;i++)
+		if(!covered[i])
+			for(int k=0;k!=4;k++)
+				rgba[i*4 + k] = (uint8_t)(sum[k] / count);
+}
+
+// Rasterizes every model of material into its UV1 space.  sources are the
+// mask and the four tiles in the order the shader samples them.
+static void bake(const LOLMap* map, uint32_t material, const Source* sources[5],
+	uint32_t size, vector<uint8_t>& rgba)
+{
+	rgba.assign(size*size*4,0);
+	vector<uint8_t> covered(size*size,0);
+	int stride = map->materials[material].stride();
+
+	for(uint32_t m=0;m!=map->num_model;m++)
+	{
+		if(map->models[m].material != material)
+			continue;
+		const LOLMapModelData& data = map->models[m].model[0];
+		const float* vertices = map->vertex_lists[data.vertex_index].vertices;
+		const uint16_t* indices =
+			map->index_lists[data.index_index].indices + data.index_offset;
+
+		for(uint32_t t=0;t+2<data.index_length;t+=3)
+		{
+			const float* v[3];
+			float px[3], py[3];
+			for(int k=0;k!=3;k++)
+			{
+				v[k] = vertices + indices[t + k]*stride;
+				px[k] = v[k][8]*size;
+				py[k] = v[k][9]*size;
+			}
+			float area = (px[1] - px[0])*(py[2] - py[0]) -
+				(px[2] - px[0])*(py[1] - py[0]);
+			if(fabs(area) < 1e-6f)
+				continue;
+			float uvArea = 0.5f*((v[1][6] - v[0][6])*(v[2][7] - v[0][7]) -
+				(v[2][6] - v[0][6])*(v[1][7] - v[0][7]));
+			float footprints[5];
+			footprints[0] = footprint(*sources[0],1.0f/(size*size),1);
+			for(int s=1;s!=5;s++)
+				footprints[s] = footprint(*sources[s],uvArea,fabs(area)*0.5f);
+
+			int x0 = max((int)floor(min(min(px[0],px[1]),px[2])),0);
+			int x1 = min((int)ceil(max(max(px[0],px[1]),px[2])),(int)size - 1);
+			int y0 = max((int)floor(min(min(py[0],py[1]),py[2])),0);
+			int y1 = min((int)ceil(max(max(py[0],py[1]),py[2])),(int)size - 1);
+			for(int y=y0;y<=y1;y++)
+			{
+				for(int x=x0;x<=x1;x++)
+				{
+					// Barycentrics of the texel center.
+					float cx = x + 0.5f, cy = y + 0.5f;
+					float b1 = ((cx - px[0])*(py[2] - py[0]) -
+						(px[2] - px[0])*(cy - py[0])) / area;
+					float b2 = ((px[1] - px[0])*(cy - py[0]) -
+						(cx - px[0])*(py[1] - py[0])) / area;
+					float b0 = 1 - b1 - b2;
+					const float epsilon = -1e-4f;
+					if(b0 < epsilon || b1 < epsilon || b2 < epsilon)
+						continue;
+
+					float u0 = b0*v[0][6] + b1*v[1][6] + b2*v[2][6];
+					float v0 = b0*v[0][7] + b1*v[1][7] + b2*v[2][7];
+
+					float mask[4] = {0,0,0,0}, color[4] = {0,0,0,0};
+					if(!sources[0]->levels.empty())
+						sample(*sources[0],footprints[0],cx/size,cy/size,false,mask);
+					if(!sources[1]->levels.empty())
+						sample(*sources[1],footprints[1],u0,v0,true,color);
+					for(int s=2;s!=5;s++)
+					{
+						if(sources[s]->levels.empty())
+							continue;
+						float tile[4], weight = mask[s - 2] / 255;
+						sample(*sources[s],footprints[s],u0,v0,true,tile);
+						for(int k=0;k!=3;k++)
+							color[k] = weight*tile[k] + (1 - weight)*color[k];
+					}
+
+					uint8_t* out = rgba.data() + (y*size + x)*4;
+					for(int k=0;k!=3;k++)
+						out[k] = (uint8_t)min(max(color[k] + 0.5f,0.0f),255.0f);
+					out[3] = 255;
+					covered[y*size + x] = 1;
+				}
+			}
+		}
+	}
+
+	dilate(rgba,covered,size);
+}
+
+// Power of two edge of the bake of material at density texels per unit.
+static uint32_t bake_size(const LOLMap* map, uint32_t material, float density)
+{
+	int stride = map->materials[material].stride();
+	float lo[2] = {FLT_MAX,FLT_MAX}, hi[2] = {-FLT_MAX,-FLT_MAX};
+	for(uint32_t m=0;m!=map->num_model;m++)
+	{
+		if(map->models[m].material != material)
+			continue;
+		const LOLMapModelData& data = map->models[m].model[0];
+		const float* vertices = map->vertex_lists[data.vertex_index].vertices;
+		const uint16_t* indices =
+			map->index_lists[data.index_index].indices + data.index_offset;
+		for(uint32_t i=0;i!=data.index_length;i++)
+		{
+			const float* v = vertices + indices[i]*stride;
+			lo[0] = min(lo[0],v[0]);
+			hi[0] = max(hi[0],v[0]);
+			lo[1] = min(lo[1],v[2]);
+			hi[1] = max(hi[1],v[2]);
+		}
+	}
+	if(lo[0] > hi[0])
+		return 0;
+
+	float texels = max(hi[0] - lo[0],hi[1] - lo[1]) * density;
+	uint32_t size = MIN_SIZE;
+	while(size < texels && size < MAX_SIZE)
+		size *= 2;
+	return size;
+}
+
+// Whether every UV1 of material lies in [0,1], the one tile the bake
+// covers.  Anything that repeats the mask would fold onto itself.
+static bool uv1_in_unit(const LOLMap* map, uint32_t material)
+{
+	int stride = map->materials[material].stride();
+	for(uint32_t m=0;m!=map->num_model;m++)
+	{
+		if(map->models[m].material != material)
+			continue;
+		const LOLMapModelData& data = map->models[m].model[0];
+		const float* vertices = map->vertex_lists[data.vertex_index].vertices;
+		const uint16_t* indices =
+			map->index_lists[data.index_index].indices + data.index_offset;
+		for(uint32_t i=0;i!=data.index_length;i++)
+		{
+			const float* v = vertices + indices[i]*stride;
+			for(int k=8;k!=10;k++)
+				if(v[k] < -UV1_SLACK || v[k] > 1 + UV1_SLACK)
+					return false;
+		}
+	}
+	return true;
+}
+
+static void usage()
+{
+	cerr << "usage: terrainbake [-f] [-d texels per unit] <map folder>" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+	JobSystem::Instance();
+	IMG_Init(IMG_INIT_PNG);
+
+	float density = 0.5f;
+	string folder;
+	for(int i=1;i<argc;i++)
+	{
+		string arg = argv[i];
+		if(arg == "-f")
+			force = true;
+		else if(arg == "-d" && i+1 < argc)
+			density = (float)atof(argv[++i]);
+		else if(folder.empty() && arg[0] != '-')
+			folder = arg;
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+	if(folder.empty() || density <= 0)
+	{
+		usage();
+		return 1;
+	}
+	if(folder[folder.size()-1] != '/')
+		folder += '/';
+
+	string nvr = folder + "Scene/room.nvr";
+	if(!exists(nvr))
+	{
+		cerr << "No map in " << folder << endl;
+		return 1;
+	}
+	LOLMap* map = read_map(nvr.c_str());
+
+	string baked = folder + "Scene/Baked/";
+#if defined(_WIN32) || defined(_WIN64)
+	mkdir(baked.c_str());
+#else
+	mkdir(baked.c_str(),0755);
+#endif
+
+	// The materials to bake and every texture they sample, decoded once.
+	static const int slots[5] = {1,0,2,4,6};
+	vector<uint32_t> materials;
+	std::map<string,size_t> names;
+	for(uint32_t i=0;i!=map->num_material;i++)
+	{
+		const LOLMapMaterial& mat = map->materials[i];
+		if(mat.flag1 != 3)
+			continue;
+		if(!force && exists(baked + mat.name + ".dds"))
+			continue;
+		if(!uv1_in_unit(map,i))
+		{
+			cerr << "Skipped " << mat.name << ", UV1 outside [0,1]" << endl;
+			continue;
+		}
+		materials.push_back(i);
+		for(int s=0;s!=5;s++)
+		{
+			string name = mat.textures[slots[s]].filename;
+			if(!names.count(name))
+			{
+				size_t index = names.size();
+				names[name] = index;
+			}
+		}
+	}
+
+	uint32_t start = SDL_GetTicks();
+	vector<Source> sources(names.size());
+	vector<string> files(names.size());
+	for(std::map<string,size_t>::iterator i=names.begin();i!=names.end();i++)
+		files[i->second] = i->first;
+	JobSystem::Instance().ParallelFor(files.size(),1,
+		[&](size_t begin, size_t end)
+	{
+		for(size_t i=begin;i!=end;i++)
+			if(!files[i].empty())
+				load_source(folder + "Scene/Textures/" + files[i],sources[i]);
+	});
+	cout << "Decoded " << files.size() << " textures " <<
+		SDL_GetTicks() - start << "ms" << endl;
+
+	// What each bake wrote, printed in order once they are all done.
+	vector<string> written(materials.size());
+	vector<uint8_t> failed(materials.size(),0);
+	JobSystem::Instance().ParallelFor(materials.size(),1,
+		[&](size_t begin, size_t end)
+	{
+		vector<uint8_t> rgba;
+		for(size_t i=begin;i!=end;i++)
+		{
+			const LOLMapMaterial& mat = map->materials[materials[i]];
+			uint32_t size = bake_size(map,materials[i],density);
+			if(!size)
+				continue;
+
+			const Source* used[5];
+			for(int s=0;s!=5;s++)
+				used[s] = &sources[names.find(mat.textures[slots[s]].filename)->second];
+			bake(map,materials[i],used,size,rgba);
+
+			DDSImage image;
+			compress_image(rgba.data(),size,size,image);
+			string name = baked + mat.name + ".dds";
+			failed[i] = !write_dds(name.c_str(),image);
+			ostringstream line;
+			if(failed[i])
+				line << "Failed " << name;
+			else
+				line << name << " " << size << "x" << size;
+			written[i] = line.str();
+		}
+	});
+	for(size_t i=0;i!=written.size();i++)
+	{
+		if(written[i].empty())
+			continue;
+		(failed[i] ? cerr : cout) << written[i] << endl;
+	}
+	cout << "Baked " << materials.size() << " materials " <<
+		SDL_GetTicks() - start << "ms" << endl;
+
+	free_map(map);
+	IMG_Quit();
+	return 0;
+}
@@ -0,0 +1,67 @@
+#include "Core.h"
+#include "TextureCompressor.h"
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_image.h"
+#include <dirent.h>
+using namespace std;
+
+//	Offline texture compressor
+//	Writes name.dds next to every name.png so RiotMap picks up the
+//	compressed copy instead of decoding the png at load time.
+//
+//	usage: texcompress [-f] <Textures folder | file.png>...
+
+static bool force = false;
+
+static bool exists(const string& path)
+{
+	ifstream fi(path.c_str());
+	return (bool)fi;
+}
+
+static void compress(const string& png)
+{
+	string dds = png.substr(0,png.size()-3) + "dds";
+	if(!force && exists(dds))
+		return;
+
+	uint32_t start = SDL_GetTicks();
+	if(compress_file(png.c_str(),dds.c_str()))
+		cout << dds << " " << SDL_GetTicks() - start << "ms" << endl;
+	else
+		cerr << "Failed " << png << endl;
+}
+
+int main(int argc, char* argv[])
+{
+	IMG_Init(IMG_INIT_PNG);
+
+	for(int i=1;i<argc;i++)
+	{
+		string arg = argv[i];
+		if(arg == "-f")
+		{
+			force = true;
+			continue;
+		}
+
+		DIR* dir = opendir(arg.c_str());
+		if(!dir)
+		{
+			compress(arg);
+			continue;
+		}
+
+		dirent* entry;
+		while((entry = readdir(dir)))
+		{
+			string name = entry->d_name;
+			if(name.size() > 4 && name.substr(name.size()-4) == ".png")
+				compress(arg + "/" + name);
+		}
+		closedir(dir);
+	}
+
+	IMG_Quit();
+	return 0;
+}